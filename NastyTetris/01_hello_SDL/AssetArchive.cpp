@@ -0,0 +1,412 @@
+/* Headers */
+#include "AssetArchive.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+
+//Archive the game loads from when present
+LAssetArchive gAssets;
+
+//A file waiting to be written into the archive
+struct LPackedAsset
+{
+	LAssetEntry entry;
+	std::vector<Uint8> data;
+};
+
+//Archive index is kept sorted so lookups can bisect
+static bool compareAssetNames(const LPackedAsset& a, const LPackedAsset& b)
+{
+	return strcmp(a.entry.name, b.entry.name) < 0;
+}
+
+//FNV-1a, only run at pack time
+static Uint64 hashAssetData(const std::vector<Uint8>& data)
+{
+	Uint64 hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		hash = (hash ^ data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+LAssetArchive::LAssetArchive()
+{
+	//Initialize
+	mData = NULL;
+	mSize = 0;
+	mFile = NULL;
+	mMapping = NULL;
+	mEntries = NULL;
+	mEntryCount = 0;
+}
+
+LAssetArchive::~LAssetArchive()
+{
+	//Deallocate
+	close();
+}
+
+bool LAssetArchive::open(const std::string& path)
+{
+	//Get rid of preexisting mapping
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	mData = (const Uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (mData == NULL)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	mFile = file;
+	mMapping = mapping;
+	mSize = (size_t)fileSize.QuadPart;
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size <= 0)
+	{
+		::close(file);
+		return false;
+	}
+	void* mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (mapped == MAP_FAILED)
+	{
+		return false;
+	}
+	mData = (const Uint8*)mapped;
+	mSize = (size_t)info.st_size;
+#endif
+
+	//Validate header and index
+	const LAssetHeader* header = (const LAssetHeader*)mData;
+	if (mSize < sizeof(LAssetHeader) || header->magic != ASSET_ARCHIVE_MAGIC || header->version != ASSET_ARCHIVE_VERSION
+		|| sizeof(LAssetHeader) + (Uint64)header->entryCount * sizeof(LAssetEntry) > mSize)
+	{
+		printf("Asset archive %s is invalid!\n", path.c_str());
+		close();
+		return false;
+	}
+	mEntries = (const LAssetEntry*)(mData + sizeof(LAssetHeader));
+	mEntryCount = (int)header->entryCount;
+	for (int i = 0; i < mEntryCount; ++i)
+	{
+		//Written so a corrupt offset or size can't overflow past the check
+		const LAssetEntry& entry = mEntries[i];
+		if (entry.offset > mSize || entry.size > mSize - entry.offset)
+		{
+			printf("Asset archive %s is truncated!\n", path.c_str());
+			close();
+			return false;
+		}
+
+		//Names are used as C strings and images as pixel rows, the mapping is read only so bad ones can't be patched up
+		bool badName = memchr(entry.name, '\0', ASSET_NAME_LENGTH) == NULL;
+		bool badImage = entry.type == ASSET_IMAGE && (entry.width <= 0 || entry.height <= 0 || entry.pitch < (Sint64)entry.width * 4
+			|| (Uint64)entry.pitch * (Uint64)entry.height > entry.size);
+		if (badName || badImage)
+		{
+			printf("Asset archive %s has a corrupt entry!\n", path.c_str());
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void LAssetArchive::close()
+{
+	if (mData != NULL)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(mData);
+		CloseHandle((HANDLE)mMapping);
+		CloseHandle((HANDLE)mFile);
+#else
+		munmap((void*)mData, mSize);
+#endif
+	}
+	mData = NULL;
+	mSize = 0;
+	mFile = NULL;
+	mMapping = NULL;
+	mEntries = NULL;
+	mEntryCount = 0;
+}
+
+bool LAssetArchive::isOpen() const
+{
+	return mData != NULL;
+}
+
+const LAssetEntry* LAssetArchive::find(const std::string& name) const
+{
+	//Bisect the sorted index
+	int low = 0;
+	int high = mEntryCount - 1;
+	while (low <= high)
+	{
+		int middle = (low + high) / 2;
+		int order = strcmp(mEntries[middle].name, name.c_str());
+		if (order == 0)
+		{
+			return &mEntries[middle];
+		}
+		if (order < 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+	return NULL;
+}
+
+int LAssetArchive::getEntryCount() const
+{
+	return mEntryCount;
+}
+
+const LAssetEntry* LAssetArchive::getEntry(int index) const
+{
+	return &mEntries[index];
+}
+
+const void* LAssetArchive::getData(const LAssetEntry* entry) const
+{
+	return mData + entry->offset;
+}
+
+SDL_Surface* LAssetArchive::createSurface(const std::string& name) const
+{
+	const LAssetEntry* entry = find(name);
+	if (entry == NULL || entry->type != ASSET_IMAGE)
+	{
+		return NULL;
+	}
+
+	//Surface borrows the mapped pixels, freeing it leaves them alone
+	return SDL_CreateRGBSurfaceWithFormatFrom((void*)getData(entry), entry->width, entry->height, 32, entry->pitch, entry->format);
+}
+
+SDL_Texture* LAssetArchive::createTexture(SDL_Renderer* renderer, const std::string& name, int* width, int* height) const
+{
+	const LAssetEntry* entry = find(name);
+	if (entry == NULL || entry->type != ASSET_IMAGE)
+	{
+		return NULL;
+	}
+
+	//Upload the mapped rows directly, no decode and no intermediate surface
+	SDL_Texture* texture = SDL_CreateTexture(renderer, entry->format, SDL_TEXTUREACCESS_STATIC, entry->width, entry->height);
+	if (texture == NULL)
+	{
+		printf("Unable to create texture from %s! SDL Error: %s\n", name.c_str(), SDL_GetError());
+		return NULL;
+	}
+	SDL_UpdateTexture(texture, NULL, getData(entry), entry->pitch);
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+	if (width != NULL)
+	{
+		*width = entry->width;
+	}
+	if (height != NULL)
+	{
+		*height = entry->height;
+	}
+	return texture;
+}
+
+TTF_Font* LAssetArchive::openFont(const std::string& name, int size) const
+{
+	const LAssetEntry* entry = find(name);
+	if (entry == NULL || entry->type != ASSET_FONT)
+	{
+		return NULL;
+	}
+
+	//SDL_ttf reads the font straight out of the mapping
+	SDL_RWops* rw = SDL_RWFromConstMem(getData(entry), (int)entry->size);
+	if (rw == NULL)
+	{
+		return NULL;
+	}
+	return TTF_OpenFontRW(rw, 1, size);
+}
+
+bool LAssetArchive::pack(const std::string& directory, const std::string& output)
+{
+	std::vector<LPackedAsset> assets;
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+	{
+		if (!it->is_regular_file())
+		{
+			continue;
+		}
+
+		//Names use the same relative paths the game loads with
+		std::string name = directory + "/" + std::filesystem::relative(it->path(), directory).generic_string();
+		if (name.size() >= (size_t)ASSET_NAME_LENGTH)
+		{
+			printf("Asset name %s is too long, skipping!\n", name.c_str());
+			continue;
+		}
+		std::string extension = it->path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+		LPackedAsset asset;
+		memset(&asset.entry, 0, sizeof(asset.entry));
+		SDL_strlcpy(asset.entry.name, name.c_str(), ASSET_NAME_LENGTH);
+
+		if (extension == ".png" || extension == ".bmp")
+		{
+			//Decode now and apply the cyan color key, the game never decodes again
+			SDL_Surface* loadedSurface = IMG_Load(name.c_str());
+			if (loadedSurface == NULL)
+			{
+				printf("Unable to load image %s! SDL_image Error: %s\n", name.c_str(), IMG_GetError());
+				continue;
+			}
+			SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, 0, 0xFF, 0xFF));
+			SDL_Surface* converted = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA32, 0);
+			SDL_FreeSurface(loadedSurface);
+			if (converted == NULL)
+			{
+				printf("Unable to convert image %s! SDL Error: %s\n", name.c_str(), SDL_GetError());
+				continue;
+			}
+
+			asset.entry.type = ASSET_IMAGE;
+			asset.entry.format = SDL_PIXELFORMAT_RGBA32;
+			asset.entry.width = converted->w;
+			asset.entry.height = converted->h;
+			asset.entry.pitch = converted->w * 4;
+			asset.data.resize((size_t)asset.entry.pitch * converted->h);
+			SDL_LockSurface(converted);
+			for (int y = 0; y < converted->h; ++y)
+			{
+				memcpy(&asset.data[(size_t)y * asset.entry.pitch], (const Uint8*)converted->pixels + (size_t)y * converted->pitch, asset.entry.pitch);
+			}
+			SDL_UnlockSurface(converted);
+			SDL_FreeSurface(converted);
+		}
+		else
+		{
+			//Everything else is copied verbatim
+			SDL_RWops* file = SDL_RWFromFile(name.c_str(), "rb");
+			if (file == NULL)
+			{
+				printf("Unable to read %s! SDL Error: %s\n", name.c_str(), SDL_GetError());
+				continue;
+			}
+			Sint64 size = SDL_RWsize(file);
+			asset.data.resize(size > 0 ? (size_t)size : 0);
+			if (size > 0)
+			{
+				SDL_RWread(file, &asset.data[0], 1, (size_t)size);
+			}
+			SDL_RWclose(file);
+			asset.entry.type = extension == ".ttf" ? ASSET_FONT : ASSET_RAW;
+		}
+
+		asset.entry.size = asset.data.size();
+		asset.entry.hash = hashAssetData(asset.data);
+		assets.push_back(asset);
+	}
+	if (error)
+	{
+		printf("Unable to read directory %s! %s\n", directory.c_str(), error.message().c_str());
+		return false;
+	}
+
+	//Lay out payloads after the index
+	std::sort(assets.begin(), assets.end(), compareAssetNames);
+	Uint64 offset = sizeof(LAssetHeader) + assets.size() * sizeof(LAssetEntry);
+	for (size_t i = 0; i < assets.size(); ++i)
+	{
+		offset = (offset + ASSET_ALIGNMENT - 1) & ~(Uint64)(ASSET_ALIGNMENT - 1);
+		assets[i].entry.offset = offset;
+		offset += assets[i].entry.size;
+	}
+
+	//Write header, index and payloads
+	SDL_RWops* file = SDL_RWFromFile(output.c_str(), "wb");
+	if (file == NULL)
+	{
+		printf("Unable to create %s! SDL Error: %s\n", output.c_str(), SDL_GetError());
+		return false;
+	}
+	LAssetHeader header = { ASSET_ARCHIVE_MAGIC, ASSET_ARCHIVE_VERSION, (Uint32)assets.size(), 0 };
+	bool complete = SDL_RWwrite(file, &header, sizeof(header), 1) == 1;
+	for (size_t i = 0; i < assets.size() && complete; ++i)
+	{
+		complete = SDL_RWwrite(file, &assets[i].entry, sizeof(LAssetEntry), 1) == 1;
+	}
+	Uint64 written = sizeof(LAssetHeader) + assets.size() * sizeof(LAssetEntry);
+	const Uint8 padding[ASSET_ALIGNMENT] = { 0 };
+	for (size_t i = 0; i < assets.size() && complete; ++i)
+	{
+		size_t paddingSize = (size_t)(assets[i].entry.offset - written);
+		complete = SDL_RWwrite(file, padding, 1, paddingSize) == paddingSize;
+		if (complete && !assets[i].data.empty())
+		{
+			complete = SDL_RWwrite(file, &assets[i].data[0], 1, assets[i].data.size()) == assets[i].data.size();
+		}
+		written = assets[i].entry.offset + assets[i].entry.size;
+	}
+	complete = SDL_RWclose(file) == 0 && complete;
+
+	//A short archive would be rejected at startup anyway, don't leave one behind for the build to ship
+	if (!complete)
+	{
+		printf("Unable to write %s! SDL Error: %s\n", output.c_str(), SDL_GetError());
+		std::error_code removeError;
+		std::filesystem::remove(output, removeError);
+		return false;
+	}
+
+	printf("Packed %d assets into %s (%llu bytes)\n", (int)assets.size(), output.c_str(), (unsigned long long)written);
+	return true;
+}
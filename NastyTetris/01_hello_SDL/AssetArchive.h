@@ -0,0 +1,116 @@
+#pragma once
+
+/* Headers */
+//Using SDL, SDL_ttf and STL string
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <string>
+
+
+
+/* Constants */
+
+//Archive identification
+const Uint32 ASSET_ARCHIVE_MAGIC = 0x4B50544E;
+const Uint32 ASSET_ARCHIVE_VERSION = 2;
+
+//Longest asset name, including the terminator
+const int ASSET_NAME_LENGTH = 96;
+
+//Payload alignment inside the archive
+const int ASSET_ALIGNMENT = 64;
+
+//Default archive location, next to the assets directory
+const char* const ASSET_ARCHIVE_PATH = "assets.pak";
+
+//What an entry holds
+enum AssetType
+{
+	ASSET_RAW,
+	ASSET_IMAGE,
+	ASSET_FONT
+};
+
+//Archive header, followed by the entries sorted by name
+struct LAssetHeader
+{
+	Uint32 magic;
+	Uint32 version;
+	Uint32 entryCount;
+	Uint32 reserved;
+};
+
+//Index entry, images are stored decoded and color keyed as RGBA32 rows
+struct LAssetEntry
+{
+	char name[ASSET_NAME_LENGTH];
+	Uint32 type;
+	Uint32 format;
+	Sint32 width;
+	Sint32 height;
+	Sint32 pitch;
+	Uint32 reserved;
+	Uint64 offset;
+	Uint64 size;
+
+	//FNV-1a of the payload, computed when packing so loaders can tell edited assets apart without reading them
+	Uint64 hash;
+};
+
+//Read only, memory mapped archive of everything under assets/
+class LAssetArchive
+{
+public:
+	//Initializes variables
+	LAssetArchive();
+
+	//Unmaps the archive
+	~LAssetArchive();
+
+	//Maps an archive into memory and validates its index
+	bool open(const std::string& path);
+
+	//Unmaps the archive
+	void close();
+
+	//Checks whether an archive is mapped
+	bool isOpen() const;
+
+	//Finds an entry by its path, such as "assets/images/button.png"
+	const LAssetEntry* find(const std::string& name) const;
+
+	//Gets entries in name order
+	int getEntryCount() const;
+	const LAssetEntry* getEntry(int index) const;
+
+	//Gets the mapped payload of an entry
+	const void* getData(const LAssetEntry* entry) const;
+
+	//Wraps an image's mapped pixels in a surface without copying, NULL if absent
+	SDL_Surface* createSurface(const std::string& name) const;
+
+	//Uploads an image straight from the mapped pixels, NULL if absent
+	SDL_Texture* createTexture(SDL_Renderer* renderer, const std::string& name, int* width, int* height) const;
+
+	//Opens a packed font from the mapped bytes, NULL if absent
+	TTF_Font* openFont(const std::string& name, int size) const;
+
+	//Packs a directory tree into an archive, run at build time
+	static bool pack(const std::string& directory, const std::string& output);
+
+private:
+	//Mapped file
+	const Uint8* mData;
+	size_t mSize;
+
+	//Platform handles of the mapping
+	void* mFile;
+	void* mMapping;
+
+	//Index inside the mapping
+	const LAssetEntry* mEntries;
+	int mEntryCount;
+};
+
+//Archive the game loads from when present
+extern LAssetArchive gAssets;
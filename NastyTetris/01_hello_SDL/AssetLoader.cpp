@@ -0,0 +1,265 @@
+/* Headers */
+#include "AssetLoader.h"
+#include "Profiler.h"
+#include <stdio.h>
+
+
+
+//Loads everything the game shows
+LAssetLoader gAssetLoader;
+
+LAssetLoader::LAssetLoader()
+{
+	//Initialize
+	mNextDecode = 0;
+	mNextUpload = 0;
+	mFailed = 0;
+	mMutex = NULL;
+	mCondition = NULL;
+	mQuit = false;
+}
+
+LAssetLoader::~LAssetLoader()
+{
+	//Deallocate
+	stop();
+}
+
+bool LAssetLoader::start()
+{
+	//Get rid of preexisting workers
+	stop();
+
+	mMutex = SDL_CreateMutex();
+	mCondition = SDL_CreateCond();
+	if (mMutex == NULL || mCondition == NULL)
+	{
+		printf("Unable to create loader lock! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	//Leave a core for the main thread
+	int threads = SDL_GetCPUCount() - 1;
+	if (threads < 1)
+	{
+		threads = 1;
+	}
+	if (threads > ASSET_LOADER_MAX_THREADS)
+	{
+		threads = ASSET_LOADER_MAX_THREADS;
+	}
+
+	mQuit = false;
+	for (int i = 0; i < threads; ++i)
+	{
+		SDL_Thread* thread = SDL_CreateThread(workerThread, "AssetLoader", this);
+		if (thread == NULL)
+		{
+			//Whatever could not be decoded on a worker gets decoded in update()
+			printf("Unable to create loader thread! SDL Error: %s\n", SDL_GetError());
+			break;
+		}
+		mThreads.push_back(thread);
+	}
+
+	return true;
+}
+
+void LAssetLoader::stop()
+{
+	//Wake the workers up and wait for them to finish their current job
+	if (mMutex != NULL)
+	{
+		SDL_LockMutex(mMutex);
+		mQuit = true;
+		SDL_CondBroadcast(mCondition);
+		SDL_UnlockMutex(mMutex);
+	}
+	for (size_t i = 0; i < mThreads.size(); ++i)
+	{
+		SDL_WaitThread(mThreads[i], NULL);
+	}
+	mThreads.clear();
+
+	//Free surfaces that never got uploaded
+	for (size_t i = mNextUpload; i < mJobs.size(); ++i)
+	{
+		SDL_FreeSurface(mJobs[i].surface);
+	}
+	mJobs.clear();
+	mNextDecode = 0;
+	mNextUpload = 0;
+	mFailed = 0;
+
+	if (mCondition != NULL)
+	{
+		SDL_DestroyCond(mCondition);
+		mCondition = NULL;
+	}
+	if (mMutex != NULL)
+	{
+		SDL_DestroyMutex(mMutex);
+		mMutex = NULL;
+	}
+}
+
+void LAssetLoader::queue(const std::string& name, LDecodeFunction decode, LUploadFunction upload)
+{
+	LLoadJob job;
+	job.name = name;
+	job.decode = decode;
+	job.upload = upload;
+	job.surface = NULL;
+
+	//Main thread only jobs are ready as soon as everything before them is uploaded
+	job.decoded = !decode;
+
+	if (mMutex != NULL)
+	{
+		SDL_LockMutex(mMutex);
+	}
+	mJobs.push_back(job);
+	if (mMutex != NULL)
+	{
+		SDL_CondSignal(mCondition);
+		SDL_UnlockMutex(mMutex);
+	}
+}
+
+int LAssetLoader::workerThread(void* data)
+{
+	((LAssetLoader*)data)->work();
+	return 0;
+}
+
+void LAssetLoader::work()
+{
+	SDL_LockMutex(mMutex);
+	while (!mQuit)
+	{
+		//Skip jobs that need no decoding
+		while (mNextDecode < mJobs.size() && mJobs[mNextDecode].decoded)
+		{
+			++mNextDecode;
+		}
+		if (mNextDecode == mJobs.size())
+		{
+			SDL_CondWait(mCondition, mMutex);
+			continue;
+		}
+
+		//Decode without holding the lock, the job list may grow meanwhile
+		size_t index = mNextDecode++;
+		LDecodeFunction decode = mJobs[index].decode;
+		SDL_UnlockMutex(mMutex);
+		LProfileZone zone("Decode");
+		SDL_Surface* surface = decode();
+		zone.end();
+		SDL_LockMutex(mMutex);
+
+		mJobs[index].surface = surface;
+		mJobs[index].decoded = true;
+	}
+	SDL_UnlockMutex(mMutex);
+}
+
+void LAssetLoader::update(Uint32 budgetMs)
+{
+	LProfileZone zone("Upload");
+	Uint64 start = SDL_GetPerformanceCounter();
+	Uint64 budget = SDL_GetPerformanceFrequency() * budgetMs / 1000;
+
+	while (mNextUpload < mJobs.size())
+	{
+		size_t index = mNextUpload;
+
+		//Take the decoded surface
+		bool ready = true;
+		SDL_Surface* surface = NULL;
+		LDecodeFunction decode;
+		if (mMutex != NULL)
+		{
+			SDL_LockMutex(mMutex);
+		}
+		if (mJobs[index].decoded)
+		{
+			surface = mJobs[index].surface;
+			mJobs[index].surface = NULL;
+		}
+		else if (mThreads.empty())
+		{
+			//No workers, decode it here and make sure none picks it up later
+			decode = mJobs[index].decode;
+			mJobs[index].decoded = true;
+		}
+		else
+		{
+			ready = false;
+		}
+		if (mMutex != NULL)
+		{
+			SDL_UnlockMutex(mMutex);
+		}
+		if (!ready)
+		{
+			break;
+		}
+		if (decode)
+		{
+			surface = decode();
+		}
+
+		//Upload may queue more jobs, so it can't run from inside the list
+		LUploadFunction upload = mJobs[index].upload;
+		++mNextUpload;
+		if (upload)
+		{
+			if (!upload(surface))
+			{
+				printf("Failed to load %s!\n", mJobs[index].name.c_str());
+				++mFailed;
+			}
+		}
+		else
+		{
+			SDL_FreeSurface(surface);
+		}
+
+		//Let go of whatever the job captured
+		mJobs[index].decode = nullptr;
+		mJobs[index].upload = nullptr;
+
+		if (SDL_GetPerformanceCounter() - start >= budget)
+		{
+			break;
+		}
+	}
+}
+
+bool LAssetLoader::isDone() const
+{
+	return mNextUpload == mJobs.size();
+}
+
+float LAssetLoader::getProgress() const
+{
+	if (mJobs.empty())
+	{
+		return 1.f;
+	}
+	return (float)mNextUpload / (float)mJobs.size();
+}
+
+int LAssetLoader::getFailedCount() const
+{
+	return mFailed;
+}
+
+const char* LAssetLoader::getCurrentName() const
+{
+	if (mNextUpload >= mJobs.size())
+	{
+		return "";
+	}
+	return mJobs[mNextUpload].name.c_str();
+}
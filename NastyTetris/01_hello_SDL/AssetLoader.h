@@ -0,0 +1,94 @@
+#pragma once
+
+/* Headers */
+//Using SDL threads, STL function, string and vector
+#include <SDL.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+
+/* Constants */
+
+//Most decoding threads the loader starts, one core is left for the main thread
+const int ASSET_LOADER_MAX_THREADS = 4;
+
+//Milliseconds of texture uploads allowed per frame
+const int ASSET_UPLOAD_BUDGET_MS = 4;
+
+//Runs on a worker thread, gives back the surface to upload or NULL when there is nothing to upload
+typedef std::function<SDL_Surface*()> LDecodeFunction;
+
+//Runs on the main thread with the decoded surface and takes ownership of it
+typedef std::function<bool(SDL_Surface*)> LUploadFunction;
+
+//Decodes assets on a pool of worker threads and uploads them on the main thread a few at a time
+class LAssetLoader
+{
+public:
+	//Initializes variables
+	LAssetLoader();
+
+	//Stops the workers
+	~LAssetLoader();
+
+	//Starts the worker threads
+	bool start();
+
+	//Waits for the workers and drops anything not uploaded yet
+	void stop();
+
+	//Adds a job, uploads run in the order jobs were queued
+	//decode may be empty for jobs that only need the main thread
+	void queue(const std::string& name, LDecodeFunction decode, LUploadFunction upload);
+
+	//Uploads decoded jobs until the time budget runs out, at least one per call
+	void update(Uint32 budgetMs = ASSET_UPLOAD_BUDGET_MS);
+
+	//Gets loading state
+	bool isDone() const;
+	float getProgress() const;
+	int getFailedCount() const;
+
+	//Name of the job waiting to be uploaded next
+	const char* getCurrentName() const;
+
+private:
+	//One asset moving through the pipeline
+	struct LLoadJob
+	{
+		std::string name;
+		LDecodeFunction decode;
+		LUploadFunction upload;
+		SDL_Surface* surface;
+		bool decoded;
+	};
+
+	//Worker entry point
+	static int workerThread(void* data);
+
+	//Takes jobs until stopped
+	void work();
+
+	//Every job queued, finished ones are kept so indices stay valid
+	std::vector<LLoadJob> mJobs;
+
+	//Next job to decode and next job to upload
+	size_t mNextDecode;
+	size_t mNextUpload;
+
+	//Uploads that returned false
+	int mFailed;
+
+	//Guards the job list, signalled when jobs are queued
+	SDL_mutex* mMutex;
+	SDL_cond* mCondition;
+
+	//Decoding threads
+	std::vector<SDL_Thread*> mThreads;
+	bool mQuit;
+};
+
+//Loads everything the game shows
+extern LAssetLoader gAssetLoader;
@@ -0,0 +1,256 @@
+/* Headers */
+#include "Atlas.h"
+#include "LTexture.h"
+#include "AssetArchive.h"
+#include "TextureImport.h"
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+
+
+
+//Atlas of everything under assets/images
+LAtlas gAtlas;
+
+//Tallest images first keeps shelves tight
+bool LAtlas::compareImageHeight(const LAtlasImage& a, const LAtlasImage& b)
+{
+	return a.surface->h > b.surface->h;
+}
+
+LAtlas::LAtlas()
+{
+}
+
+LAtlas::~LAtlas()
+{
+	//Deallocate
+	free();
+}
+
+void LAtlas::free()
+{
+	for (size_t i = 0; i < mPages.size(); ++i)
+	{
+		SDL_DestroyTexture(mPages[i]);
+	}
+	mPages.clear();
+	mEntries.clear();
+
+	//Drop images that were never packed
+	for (size_t i = 0; i < mImages.size(); ++i)
+	{
+		SDL_FreeSurface(mImages[i].surface);
+	}
+	mImages.clear();
+}
+
+bool LAtlas::loadDirectory(const std::string& directory)
+{
+	//Get rid of preexisting pages
+	free();
+
+	std::vector<std::string> paths = listImages(directory);
+	for (size_t i = 0; i < paths.size(); ++i)
+	{
+		addImage(paths[i], decodeImage(paths[i]));
+	}
+	return build();
+}
+
+std::vector<std::string> LAtlas::listImages(const std::string& directory)
+{
+	//Gather image paths, from the mapped archive when there is one
+	std::vector<std::string> paths;
+	std::string prefix = directory + "/";
+	if (gAssets.isOpen())
+	{
+		for (int i = 0; i < gAssets.getEntryCount(); ++i)
+		{
+			const LAssetEntry* entry = gAssets.getEntry(i);
+			std::string name = entry->name;
+			if (entry->type == ASSET_IMAGE && name.compare(0, prefix.size(), prefix) == 0 && name.find('/', prefix.size()) == std::string::npos)
+			{
+				paths.push_back(name);
+			}
+		}
+	}
+	else
+	{
+		std::error_code error;
+		for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+		{
+			std::string extension = it->path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+			if (extension == ".png" || extension == ".bmp")
+			{
+				paths.push_back(prefix + it->path().filename().string());
+			}
+		}
+		if (error)
+		{
+			printf("Unable to read directory %s! %s\n", directory.c_str(), error.message().c_str());
+		}
+	}
+	return paths;
+}
+
+SDL_Surface* LAtlas::decodeImage(const std::string& path)
+{
+	//Already keyed, premultiplied and in the page format, so packing only copies
+	return gTextureImporter.importTexture(path);
+}
+
+void LAtlas::addImage(const std::string& name, SDL_Surface* surface)
+{
+	//Images that failed to decode are left out
+	if (surface == NULL)
+	{
+		return;
+	}
+
+	LAtlasImage image = { name, surface, 0, { 0, 0, surface->w, surface->h } };
+	mImages.push_back(image);
+}
+
+bool LAtlas::build()
+{
+	//Take the added images, the atlas owns their surfaces until they are packed
+	std::vector<LAtlasImage> images;
+	images.swap(mImages);
+	if (images.empty())
+	{
+		return false;
+	}
+
+	//Get rid of preexisting pages
+	free();
+
+	//Pages can't exceed the renderer's texture limit
+	int pageSize = ATLAS_PAGE_SIZE;
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(gRenderer, &info) == 0 && info.max_texture_width > 0)
+	{
+		pageSize = std::min(pageSize, std::min(info.max_texture_width, info.max_texture_height));
+	}
+
+	//Shelf pack, remembering how much of each page got used
+	std::sort(images.begin(), images.end(), compareImageHeight);
+	std::vector<SDL_Point> pageSizes;
+	int page = -1;
+	int penX = 0;
+	int penY = 0;
+	int shelfHeight = 0;
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		int w = images[i].rect.w + ATLAS_PADDING * 2;
+		int h = images[i].rect.h + ATLAS_PADDING * 2;
+
+		//Oversized images get a page of their own
+		if (w > pageSize || h > pageSize)
+		{
+			images[i].page = (int)pageSizes.size();
+			SDL_Point size = { images[i].rect.w, images[i].rect.h };
+			pageSizes.push_back(size);
+			continue;
+		}
+
+		//Start a new shelf, or a new page when the shelf doesn't fit
+		if (penX + w > pageSize)
+		{
+			penX = 0;
+			penY += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (page < 0 || penY + h > pageSize)
+		{
+			SDL_Point size = { 0, 0 };
+			page = (int)pageSizes.size();
+			pageSizes.push_back(size);
+			penX = 0;
+			penY = 0;
+			shelfHeight = 0;
+		}
+
+		images[i].page = page;
+		images[i].rect.x = penX + ATLAS_PADDING;
+		images[i].rect.y = penY + ATLAS_PADDING;
+		penX += w;
+		shelfHeight = std::max(shelfHeight, h);
+		pageSizes[page].x = std::max(pageSizes[page].x, penX);
+		pageSizes[page].y = std::max(pageSizes[page].y, penY + h);
+	}
+
+	//Copy images onto their pages and upload each page once
+	bool success = true;
+	for (page = 0; page < (int)pageSizes.size(); ++page)
+	{
+		SDL_Surface* pageSurface = SDL_CreateRGBSurfaceWithFormat(0, pageSizes[page].x, pageSizes[page].y, 32, gTextureImporter.getFormat());
+		if (pageSurface == NULL)
+		{
+			printf("Unable to create atlas page! SDL Error: %s\n", SDL_GetError());
+			success = false;
+			break;
+		}
+		SDL_FillRect(pageSurface, NULL, 0);
+
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			if (images[i].page == page)
+			{
+				SDL_Rect destination = images[i].rect;
+				SDL_SetSurfaceBlendMode(images[i].surface, SDL_BLENDMODE_NONE);
+				SDL_BlitSurface(images[i].surface, NULL, pageSurface, &destination);
+
+				LAtlasEntry entry = { page, images[i].rect };
+				mEntries[images[i].name] = entry;
+			}
+		}
+
+		//Same format as the texture, the upload is a plain copy
+		SDL_Texture* pageTexture = SDL_CreateTexture(gRenderer, gTextureImporter.getFormat(), SDL_TEXTUREACCESS_STATIC, pageSurface->w, pageSurface->h);
+		if (pageTexture == NULL)
+		{
+			printf("Unable to create atlas texture! SDL Error: %s\n", SDL_GetError());
+			SDL_FreeSurface(pageSurface);
+			success = false;
+			break;
+		}
+		SDL_UpdateTexture(pageTexture, NULL, pageSurface->pixels, pageSurface->pitch);
+		SDL_FreeSurface(pageSurface);
+		SDL_SetTextureBlendMode(pageTexture, gTextureImporter.getBlendMode());
+		mPages.push_back(pageTexture);
+	}
+
+	//Get rid of decoded images
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		SDL_FreeSurface(images[i].surface);
+	}
+
+	if (!success)
+	{
+		free();
+		return false;
+	}
+
+	return true;
+}
+
+bool LAtlas::getRegion(const std::string& name, SDL_Texture** texture, SDL_Rect* region) const
+{
+	std::map<std::string, LAtlasEntry>::const_iterator it = mEntries.find(name);
+	if (it == mEntries.end())
+	{
+		return false;
+	}
+
+	*texture = mPages[it->second.page];
+	*region = it->second.rect;
+	return true;
+}
+
+int LAtlas::getPageCount() const
+{
+	return (int)mPages.size();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+/* Headers */
+//Using SDL, STL string, map and vector
+#include <SDL.h>
+#include <map>
+#include <string>
+#include <vector>
+
+
+
+/* Constants */
+
+//Largest atlas page, clamped to what the renderer supports
+const int ATLAS_PAGE_SIZE = 2048;
+
+//Transparent border around each packed image so filtering never bleeds
+const int ATLAS_PADDING = 1;
+
+//Packs many images into a few large textures
+class LAtlas
+{
+public:
+	//Initializes variables
+	LAtlas();
+
+	//Deallocates memory
+	~LAtlas();
+
+	//Packs every PNG and BMP in the directory, images are named "directory/file"
+	bool loadDirectory(const std::string& directory);
+
+	//Lists the images loadDirectory() would pack, from the archive when it is open
+	static std::vector<std::string> listImages(const std::string& directory);
+
+	//Decodes an image through the texture importer, safe to call from any thread
+	static SDL_Surface* decodeImage(const std::string& path);
+
+	//Hands a decoded image over to be packed by the next build()
+	void addImage(const std::string& name, SDL_Surface* surface);
+
+	//Packs the added images and uploads one texture per page
+	bool build();
+
+	//Deallocates pages
+	void free();
+
+	//Finds a packed image, gives back its page texture and the rect inside it
+	bool getRegion(const std::string& name, SDL_Texture** texture, SDL_Rect* region) const;
+
+	//Gets number of page textures
+	int getPageCount() const;
+
+private:
+	//An image waiting to be packed
+	struct LAtlasImage
+	{
+		std::string name;
+		SDL_Surface* surface;
+		int page;
+		SDL_Rect rect;
+	};
+
+	//Tallest images first keeps shelves tight
+	static bool compareImageHeight(const LAtlasImage& a, const LAtlasImage& b);
+
+	//Where a packed image ended up
+	struct LAtlasEntry
+	{
+		int page;
+		SDL_Rect rect;
+	};
+
+	//Packed images by name
+	std::map<std::string, LAtlasEntry> mEntries;
+
+	//Page textures
+	std::vector<SDL_Texture*> mPages;
+
+	//Decoded images added since the last build
+	std::vector<LAtlasImage> mImages;
+};
+
+//Atlas of everything under assets/images
+extern LAtlas gAtlas;
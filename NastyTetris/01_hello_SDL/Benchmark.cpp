@@ -0,0 +1,210 @@
+/* Headers */
+#include "Benchmark.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+
+
+void LBenchmark::run(const char* name, LBenchmarkFunction function, void* data)
+{
+	const double frequency = (double)SDL_GetPerformanceFrequency();
+	const double minimumTicks = frequency * BENCHMARK_MIN_REPETITION_MS / 1000.0;
+
+	//Warm up caches and lazily created state, and find how many calls make a long enough repetition
+	int calls = 1;
+	for (;;)
+	{
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int i = 0; i < calls; ++i)
+		{
+			function(data);
+		}
+		double ticks = (double)(SDL_GetPerformanceCounter() - start);
+		if (ticks >= minimumTicks || calls >= (1 << 24))
+		{
+			break;
+		}
+		calls = ticks > 0.0 ? (int)std::min(calls * minimumTicks * 1.2 / ticks + 1.0, (double)(1 << 24)) : calls * 16;
+	}
+
+	//Nanoseconds per operation of each repetition
+	double samples[BENCHMARK_REPETITIONS];
+	int operations = 0;
+	for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; ++repetition)
+	{
+		operations = 0;
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int i = 0; i < calls; ++i)
+		{
+			operations += function(data);
+		}
+		Uint64 end = SDL_GetPerformanceCounter();
+		samples[repetition] = (double)(end - start) * 1e9 / frequency / (operations > 0 ? operations : 1);
+	}
+
+	LResult result;
+	result.name = name;
+	result.repetitions = BENCHMARK_REPETITIONS;
+	result.operations = operations;
+	std::sort(samples, samples + BENCHMARK_REPETITIONS);
+	result.minNs = samples[0];
+	result.medianNs = BENCHMARK_REPETITIONS % 2 != 0 ? samples[BENCHMARK_REPETITIONS / 2] : (samples[BENCHMARK_REPETITIONS / 2 - 1] + samples[BENCHMARK_REPETITIONS / 2]) / 2.0;
+	double sum = 0.0;
+	for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+	{
+		sum += samples[i];
+	}
+	result.meanNs = sum / BENCHMARK_REPETITIONS;
+	double squares = 0.0;
+	for (int i = 0; i < BENCHMARK_REPETITIONS; ++i)
+	{
+		squares += (samples[i] - result.meanNs) * (samples[i] - result.meanNs);
+	}
+	result.stddevNs = BENCHMARK_REPETITIONS > 1 ? sqrt(squares / (BENCHMARK_REPETITIONS - 1)) : 0.0;
+	mResults.push_back(result);
+
+	printf("%-32s %12.1f ns/op %12.1f op/s  +-%.1f%%\n", name, result.medianNs, 1e9 / result.medianNs, result.medianNs > 0.0 ? result.stddevNs * 100.0 / result.medianNs : 0.0);
+}
+
+void LBenchmark::printResults() const
+{
+	printf("%-32s %12s %12s %12s %12s %12s\n", "case", "median ns", "mean ns", "stddev ns", "min ns", "op/s");
+	for (size_t i = 0; i < mResults.size(); ++i)
+	{
+		const LResult& result = mResults[i];
+		printf("%-32s %12.1f %12.1f %12.1f %12.1f %12.1f\n", result.name.c_str(), result.medianNs, result.meanNs, result.stddevNs, result.minNs, 1e9 / result.medianNs);
+	}
+}
+
+bool LBenchmark::save(const char* path) const
+{
+	SDL_RWops* file = SDL_RWFromFile(path, "wb");
+	if (file == NULL)
+	{
+		printf("Unable to write benchmark results %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+
+	//One case per line so baselines diff cleanly
+	char line[512];
+	const char* header = "{\"results\":[\n";
+	SDL_RWwrite(file, header, 1, strlen(header));
+	for (size_t i = 0; i < mResults.size(); ++i)
+	{
+		const LResult& result = mResults[i];
+		int length = SDL_snprintf(line, sizeof(line),
+			"{\"name\":\"%s\",\"median_ns\":%.3f,\"mean_ns\":%.3f,\"stddev_ns\":%.3f,\"min_ns\":%.3f,\"repetitions\":%d,\"operations\":%d}%s\n",
+			result.name.c_str(), result.medianNs, result.meanNs, result.stddevNs, result.minNs, result.repetitions, result.operations,
+			i + 1 < mResults.size() ? "," : "");
+		SDL_RWwrite(file, line, 1, length < (int)sizeof(line) ? length : sizeof(line) - 1);
+	}
+	const char* footer = "]}\n";
+	SDL_RWwrite(file, footer, 1, strlen(footer));
+	SDL_RWclose(file);
+
+	printf("Wrote %d benchmark results to %s\n", (int)mResults.size(), path);
+	return true;
+}
+
+bool LBenchmark::compare(const char* path, double tolerance) const
+{
+	//Nothing to compare with yet is not a failure, the first run has to save one
+	SDL_RWops* file = SDL_RWFromFile(path, "rb");
+	if (file == NULL)
+	{
+		printf("No benchmark baseline at %s, save one with --save-baseline\n", path);
+		return true;
+	}
+	SDL_RWclose(file);
+
+	std::vector<LResult> baseline;
+	if (!loadBaseline(path, &baseline))
+	{
+		return false;
+	}
+
+	printf("Against %s, more than %.0f%% slower is a regression\n", path, tolerance * 100.0);
+	printf("%-32s %12s %12s %8s\n", "case", "baseline ns", "now ns", "change");
+	bool success = true;
+	for (size_t i = 0; i < mResults.size(); ++i)
+	{
+		const LResult& result = mResults[i];
+		const LResult* before = NULL;
+		for (size_t j = 0; j < baseline.size(); ++j)
+		{
+			if (baseline[j].name == result.name)
+			{
+				before = &baseline[j];
+				break;
+			}
+		}
+		if (before == NULL || before->medianNs <= 0.0)
+		{
+			printf("%-32s %12s %12.1f %8s\n", result.name.c_str(), "-", result.medianNs, "new");
+			continue;
+		}
+
+		double change = result.medianNs / before->medianNs - 1.0;
+		bool regressed = change > tolerance;
+		success = success && !regressed;
+		printf("%-32s %12.1f %12.1f %+7.1f%% %s\n", result.name.c_str(), before->medianNs, result.medianNs, change * 100.0,
+			regressed ? "REGRESSED" : change < -tolerance ? "faster" : "");
+	}
+	return success;
+}
+
+const std::vector<LBenchmark::LResult>& LBenchmark::getResults() const
+{
+	return mResults;
+}
+
+bool LBenchmark::loadBaseline(const char* path, std::vector<LResult>* baseline)
+{
+	SDL_RWops* file = SDL_RWFromFile(path, "rb");
+	if (file == NULL)
+	{
+		printf("Unable to open benchmark baseline %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+	Sint64 size = SDL_RWsize(file);
+	std::string text(size > 0 ? (size_t)size : 0, '\0');
+	if (size > 0)
+	{
+		SDL_RWread(file, &text[0], 1, (size_t)size);
+	}
+	SDL_RWclose(file);
+
+	//Only the layout save() writes is understood, a name followed by its median
+	const std::string nameKey = "\"name\":\"";
+	const std::string medianKey = "\"median_ns\":";
+	size_t position = text.find(nameKey);
+	while (position != std::string::npos)
+	{
+		size_t nameStart = position + nameKey.size();
+		size_t nameEnd = text.find('"', nameStart);
+		size_t median = text.find(medianKey, nameStart);
+		if (nameEnd == std::string::npos || median == std::string::npos)
+		{
+			break;
+		}
+
+		LResult result;
+		result.name = text.substr(nameStart, nameEnd - nameStart);
+		result.medianNs = result.meanNs = result.stddevNs = result.minNs = 0.0;
+		result.repetitions = result.operations = 0;
+		if (SDL_sscanf(text.c_str() + median + medianKey.size(), "%lf", &result.medianNs) == 1)
+		{
+			baseline->push_back(result);
+		}
+		position = text.find(nameKey, nameEnd);
+	}
+
+	if (baseline->empty())
+	{
+		printf("%s holds no benchmark results!\n", path);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+/* Headers */
+//Using SDL timers and STL string and vector
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+
+
+/* Constants */
+
+//Timed repetitions per case, after one untimed warm up
+const int BENCHMARK_REPETITIONS = 15;
+
+//Shortest repetition, calls are batched until one takes at least this long
+const int BENCHMARK_MIN_REPETITION_MS = 20;
+
+//Median slowdown against the baseline that counts as a regression
+const double BENCHMARK_DEFAULT_TOLERANCE = 0.10;
+
+//Runs one batch of a case, returns how many operations it did
+typedef int (*LBenchmarkFunction)(void* data);
+
+//Times named cases over repeated runs and compares them with a baseline saved by an earlier run
+class LBenchmark
+{
+public:
+	//Statistics of one case, in nanoseconds per operation
+	struct LResult
+	{
+		std::string name;
+		double medianNs;
+		double meanNs;
+		double stddevNs;
+		double minNs;
+		int repetitions;
+		int operations;
+	};
+
+	//Times a case, function is called until a repetition is long enough and repeated BENCHMARK_REPETITIONS times
+	void run(const char* name, LBenchmarkFunction function, void* data);
+
+	//Prints every case with ns/op and op/s
+	void printResults() const;
+
+	//Writes the results as JSON
+	bool save(const char* path) const;
+
+	//Reads a file written by save(), prints the change of every case and returns false if one got slower than tolerance allows
+	//A missing file only prints a note
+	bool compare(const char* path, double tolerance) const;
+
+	//Gets the results so far
+	const std::vector<LResult>& getResults() const;
+
+private:
+	//Reads the name and median of every case out of a saved file
+	static bool loadBaseline(const char* path, std::vector<LResult>* baseline);
+
+	std::vector<LResult> mResults;
+};
@@ -0,0 +1,263 @@
+/* Headers */
+#include "Board.h"
+
+
+
+/* Constants */
+
+//Rotation masks, rows listed top to bottom with bit c being box column c
+const uint64_t gPieceMasks[PIECE_TOTAL][ROTATION_TOTAL] =
+{
+	//I
+	{ pieceRows(0x0, 0xF, 0x0, 0x0), pieceRows(0x4, 0x4, 0x4, 0x4), pieceRows(0x0, 0x0, 0xF, 0x0), pieceRows(0x2, 0x2, 0x2, 0x2) },
+	//O
+	{ pieceRows(0x6, 0x6, 0x0, 0x0), pieceRows(0x6, 0x6, 0x0, 0x0), pieceRows(0x6, 0x6, 0x0, 0x0), pieceRows(0x6, 0x6, 0x0, 0x0) },
+	//T
+	{ pieceRows(0x2, 0x7, 0x0, 0x0), pieceRows(0x2, 0x6, 0x2, 0x0), pieceRows(0x0, 0x7, 0x2, 0x0), pieceRows(0x2, 0x3, 0x2, 0x0) },
+	//S
+	{ pieceRows(0x6, 0x3, 0x0, 0x0), pieceRows(0x2, 0x6, 0x4, 0x0), pieceRows(0x0, 0x6, 0x3, 0x0), pieceRows(0x1, 0x3, 0x2, 0x0) },
+	//Z
+	{ pieceRows(0x3, 0x6, 0x0, 0x0), pieceRows(0x4, 0x6, 0x2, 0x0), pieceRows(0x0, 0x3, 0x6, 0x0), pieceRows(0x2, 0x3, 0x1, 0x0) },
+	//J
+	{ pieceRows(0x1, 0x7, 0x0, 0x0), pieceRows(0x6, 0x2, 0x2, 0x0), pieceRows(0x0, 0x7, 0x4, 0x0), pieceRows(0x2, 0x2, 0x3, 0x0) },
+	//L
+	{ pieceRows(0x4, 0x7, 0x0, 0x0), pieceRows(0x2, 0x2, 0x6, 0x0), pieceRows(0x0, 0x7, 0x1, 0x0), pieceRows(0x3, 0x2, 0x2, 0x0) }
+};
+
+//Number of SRS kick tests per rotation
+const int KICK_TESTS = 5;
+
+//SRS wall kicks as (x, y) with y pointing up, indexed by [I piece][from state][clockwise, counter clockwise]
+const int gKicks[2][ROTATION_TOTAL][2][KICK_TESTS][2] =
+{
+	//J, L, S, T, Z
+	{
+		{ { { 0, 0 }, { -1, 0 }, { -1, 1 }, { 0, -2 }, { -1, -2 } }, { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, -2 }, { 1, -2 } } },
+		{ { { 0, 0 }, { 1, 0 }, { 1, -1 }, { 0, 2 }, { 1, 2 } }, { { 0, 0 }, { 1, 0 }, { 1, -1 }, { 0, 2 }, { 1, 2 } } },
+		{ { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, -2 }, { 1, -2 } }, { { 0, 0 }, { -1, 0 }, { -1, 1 }, { 0, -2 }, { -1, -2 } } },
+		{ { { 0, 0 }, { -1, 0 }, { -1, -1 }, { 0, 2 }, { -1, 2 } }, { { 0, 0 }, { -1, 0 }, { -1, -1 }, { 0, 2 }, { -1, 2 } } }
+	},
+	//I
+	{
+		{ { { 0, 0 }, { -2, 0 }, { 1, 0 }, { -2, -1 }, { 1, 2 } }, { { 0, 0 }, { -1, 0 }, { 2, 0 }, { -1, 2 }, { 2, -1 } } },
+		{ { { 0, 0 }, { -1, 0 }, { 2, 0 }, { -1, 2 }, { 2, -1 } }, { { 0, 0 }, { 2, 0 }, { -1, 0 }, { 2, 1 }, { -1, -2 } } },
+		{ { { 0, 0 }, { 2, 0 }, { -1, 0 }, { 2, 1 }, { -1, -2 } }, { { 0, 0 }, { 1, 0 }, { -2, 0 }, { 1, -2 }, { -2, 1 } } },
+		{ { { 0, 0 }, { 1, 0 }, { -2, 0 }, { 1, -2 }, { -2, 1 } }, { { 0, 0 }, { -2, 0 }, { 1, 0 }, { -2, -1 }, { 1, 2 } } }
+	}
+};
+
+LBoard::LBoard()
+{
+	//Initialize
+	clear();
+}
+
+void LBoard::clear()
+{
+	//Empty playfield
+	for (int y = 0; y < BOARD_HEIGHT; ++y)
+	{
+		mRows[y] = BOARD_EMPTY_ROW;
+	}
+
+	//Solid floor below it
+	for (int y = BOARD_HEIGHT; y < BOARD_HEIGHT + 4; ++y)
+	{
+		mRows[y] = BOARD_FULL_ROW;
+	}
+
+	mStackTop = BOARD_HEIGHT;
+}
+
+bool LBoard::tryMove(LPiece& piece, int dx, int dy) const
+{
+	if (collides(piece.type, piece.rotation, piece.x + dx, piece.y + dy))
+	{
+		return false;
+	}
+
+	piece.x += dx;
+	piece.y += dy;
+	return true;
+}
+
+bool LBoard::tryRotate(LPiece& piece, int dir, int* kickIndex) const
+{
+	int target = (piece.rotation + (dir > 0 ? 1 : 3)) & 3;
+	const int (*kicks)[2] = gKicks[piece.type == PIECE_I ? 1 : 0][piece.rotation][dir > 0 ? 0 : 1];
+
+	//O piece never needs kicks
+	int tests = piece.type == PIECE_O ? 1 : KICK_TESTS;
+
+	for (int i = 0; i < tests; ++i)
+	{
+		//Kick tables have y pointing up, rows grow downwards
+		int x = piece.x + kicks[i][0];
+		int y = piece.y - kicks[i][1];
+		if (!collides(piece.type, target, x, y))
+		{
+			piece.rotation = target;
+			piece.x = x;
+			piece.y = y;
+			if (kickIndex != NULL)
+			{
+				*kickIndex = i;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+TSpinType LBoard::checkTSpin(const LPiece& piece, int kickIndex) const
+{
+	if (piece.type != PIECE_T)
+	{
+		return TSPIN_NONE;
+	}
+
+	//Corners of the 3x3 area around the T center, walls and floor count as filled
+	int shift = piece.x + BOARD_WALL_BITS;
+	uint16_t top = mRows[piece.y];
+	uint16_t bottom = mRows[piece.y + 2];
+	bool corners[4] =
+	{
+		((top >> shift) & 1) != 0,
+		((top >> (shift + 2)) & 1) != 0,
+		((bottom >> (shift + 2)) & 1) != 0,
+		((bottom >> shift) & 1) != 0
+	};
+
+	int filled = corners[0] + corners[1] + corners[2] + corners[3];
+	if (filled < 3)
+	{
+		return TSPIN_NONE;
+	}
+
+	//Both corners the T points at must be filled for a full T-spin,
+	//unless the last kick was the long one
+	int front = piece.rotation;
+	int frontFilled = corners[front] + corners[(front + 1) & 3];
+	if (frontFilled == 2 || kickIndex == KICK_TESTS - 1)
+	{
+		return TSPIN_FULL;
+	}
+	return TSPIN_MINI;
+}
+
+int LBoard::lock(const LPiece& piece, uint32_t* clearedRows)
+{
+	//Merge piece rows into the board
+	uint64_t mask = gPieceMasks[piece.type][piece.rotation] << (piece.x + BOARD_WALL_BITS);
+	int y = piece.y;
+	mRows[y] |= (uint16_t)mask;
+	mRows[y + 1] |= (uint16_t)(mask >> 16);
+	mRows[y + 2] |= (uint16_t)(mask >> 32);
+	mRows[y + 3] |= (uint16_t)(mask >> 48);
+	if (y < mStackTop)
+	{
+		mStackTop = y;
+	}
+
+	//Only the rows the piece touched can have become full
+	int bottom = y + 3 < BOARD_HEIGHT - 1 ? y + 3 : BOARD_HEIGHT - 1;
+	uint32_t full = 0;
+	for (int row = y; row <= bottom; ++row)
+	{
+		full |= (uint32_t)(mRows[row] == BOARD_FULL_ROW) << row;
+	}
+
+	if (clearedRows != NULL)
+	{
+		*clearedRows = full;
+	}
+	if (full == 0)
+	{
+		return 0;
+	}
+
+	//Compact rows downwards in a single pass
+	int write = bottom;
+	for (int read = bottom; read >= 0; --read)
+	{
+		mRows[write] = mRows[read];
+		write -= (full >> read) & 1 ? 0 : 1;
+	}
+	while (write >= 0)
+	{
+		mRows[write--] = BOARD_EMPTY_ROW;
+	}
+
+	int lines = 0;
+	for (uint32_t bits = full; bits != 0; bits &= bits - 1)
+	{
+		++lines;
+	}
+
+	//Everything above the cleared rows moved down
+	mStackTop += lines;
+	if (mStackTop > BOARD_HEIGHT)
+	{
+		mStackTop = BOARD_HEIGHT;
+	}
+	return lines;
+}
+
+bool LBoard::canSpawn(PieceType type) const
+{
+	return !collides(type, ROTATION_SPAWN, PIECE_SPAWN_X, PIECE_SPAWN_Y);
+}
+
+bool LBoard::isToppedOut() const
+{
+	for (int y = 0; y < BOARD_HIDDEN_HEIGHT; ++y)
+	{
+		if (mRows[y] != BOARD_EMPTY_ROW)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool LBoard::addGarbage(int lines, int holeColumn)
+{
+	if (lines <= 0)
+	{
+		return true;
+	}
+	if (lines > BOARD_HEIGHT)
+	{
+		lines = BOARD_HEIGHT;
+	}
+
+	//Anything pushed past the top means the stack overflowed
+	bool fits = true;
+	for (int y = 0; y < lines; ++y)
+	{
+		if (mRows[y] != BOARD_EMPTY_ROW)
+		{
+			fits = false;
+		}
+	}
+
+	//Shift the stack up and fill the bottom with garbage
+	for (int y = 0; y < BOARD_HEIGHT - lines; ++y)
+	{
+		mRows[y] = mRows[y + lines];
+	}
+	uint16_t garbage = (uint16_t)(BOARD_FULL_ROW & ~(1 << (holeColumn + BOARD_WALL_BITS)));
+	for (int y = BOARD_HEIGHT - lines; y < BOARD_HEIGHT; ++y)
+	{
+		mRows[y] = garbage;
+	}
+
+	mStackTop -= lines;
+	if (mStackTop < 0)
+	{
+		mStackTop = 0;
+	}
+
+	return fits;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+/* Headers */
+//Using fixed width integers for row masks
+#include <stdint.h>
+#include <stddef.h>
+
+
+
+/* Constants */
+
+//Playfield dimension constants
+const int BOARD_WIDTH = 10;
+const int BOARD_VISIBLE_HEIGHT = 20;
+const int BOARD_HIDDEN_HEIGHT = 4;
+const int BOARD_HEIGHT = BOARD_VISIBLE_HEIGHT + BOARD_HIDDEN_HEIGHT;
+
+//Row mask layout: playfield column c lives at bit (c + BOARD_WALL_BITS),
+//the remaining bits on both sides are permanently set and act as walls
+const int BOARD_WALL_BITS = 3;
+const uint16_t BOARD_EMPTY_ROW = 0xE007;
+const uint16_t BOARD_FULL_ROW = 0xFFFF;
+
+//Highest shift a piece box can take without spilling out of its 16 bit row
+const int BOARD_MAX_SHIFT = 16 - 4;
+
+//Box position new pieces appear at
+const int PIECE_SPAWN_X = 3;
+const int PIECE_SPAWN_Y = BOARD_HIDDEN_HEIGHT - 2;
+
+//The seven tetrominoes
+enum PieceType
+{
+	PIECE_I,
+	PIECE_O,
+	PIECE_T,
+	PIECE_S,
+	PIECE_Z,
+	PIECE_J,
+	PIECE_L,
+	PIECE_TOTAL,
+	PIECE_NONE = PIECE_TOTAL
+};
+
+//SRS rotation states, clockwise order
+enum PieceRotation
+{
+	ROTATION_SPAWN,
+	ROTATION_RIGHT,
+	ROTATION_REVERSE,
+	ROTATION_LEFT,
+	ROTATION_TOTAL
+};
+
+//Results of the three corner T-spin check
+enum TSpinType
+{
+	TSPIN_NONE,
+	TSPIN_MINI,
+	TSPIN_FULL
+};
+
+//Packs four 4 bit box rows into one word, 16 bits per row
+constexpr uint64_t pieceRows(uint64_t r0, uint64_t r1, uint64_t r2, uint64_t r3)
+{
+	return r0 | (r1 << 16) | (r2 << 32) | (r3 << 48);
+}
+
+//Precomputed rotation masks, bit c of each row is box column c
+extern const uint64_t gPieceMasks[PIECE_TOTAL][ROTATION_TOTAL];
+
+//A piece placed somewhere on the board, x and y are the top left of its 4x4 box
+struct LPiece
+{
+	PieceType type;
+	int rotation;
+	int x;
+	int y;
+};
+
+//Bitboard playfield, one row mask per row
+class LBoard
+{
+public:
+	//Initializes an empty board
+	LBoard();
+
+	//Empties every row
+	void clear();
+
+	//Checks piece against walls, floor and locked cells
+	bool collides(PieceType type, int rotation, int x, int y) const;
+	bool collides(const LPiece& piece) const;
+
+	//Moves piece by the given offset if it fits
+	bool tryMove(LPiece& piece, int dx, int dy) const;
+
+	//Rotates piece clockwise (dir 1) or counter clockwise (dir -1) using SRS kicks
+	//kickIndex receives the kick test that succeeded
+	bool tryRotate(LPiece& piece, int dir, int* kickIndex = NULL) const;
+
+	//Rows the piece can fall before landing
+	int dropDistance(const LPiece& piece) const;
+
+	//Row the piece would land on, used for hard drop and the ghost piece
+	int ghostY(const LPiece& piece) const;
+
+	//Three corner T-spin check for a piece that just rotated
+	TSpinType checkTSpin(const LPiece& piece, int kickIndex) const;
+
+	//Merges piece into the board and clears full rows
+	//clearedRows receives a bitmask of the rows that were removed
+	int lock(const LPiece& piece, uint32_t* clearedRows = NULL);
+
+	//Checks whether the piece can be spawned
+	bool canSpawn(PieceType type) const;
+
+	//Gets cell occupancy for rendering
+	bool isFilled(int x, int y) const;
+
+	//Gets raw row mask
+	uint16_t getRow(int y) const;
+
+	//Gets playfield bits of a row, column c at bit c
+	uint16_t getCells(int y) const;
+
+	//Checks whether any cell is locked in the hidden rows
+	bool isToppedOut() const;
+
+	//Pushes garbage rows from the bottom with a hole in the given column
+	bool addGarbage(int lines, int holeColumn);
+
+private:
+	//Reads the four rows starting at y as one word
+	uint64_t rowWord(int y) const;
+
+	//Row masks, the trailing rows are a solid floor
+	uint16_t mRows[BOARD_HEIGHT + 4];
+
+	//No cell is locked above this row, lets drops skip the empty part of the well
+	int mStackTop;
+};
+
+inline uint64_t LBoard::rowWord(int y) const
+{
+	return (uint64_t)mRows[y] | ((uint64_t)mRows[y + 1] << 16) | ((uint64_t)mRows[y + 2] << 32) | ((uint64_t)mRows[y + 3] << 48);
+}
+
+inline bool LBoard::collides(PieceType type, int rotation, int x, int y) const
+{
+	//Box outside of the row masks always collides
+	unsigned shift = (unsigned)(x + BOARD_WALL_BITS);
+	if (shift > (unsigned)BOARD_MAX_SHIFT || (unsigned)y > (unsigned)BOARD_HEIGHT)
+	{
+		return true;
+	}
+
+	//One AND over all four rows
+	return (rowWord(y) & (gPieceMasks[type][rotation] << shift)) != 0;
+}
+
+inline bool LBoard::collides(const LPiece& piece) const
+{
+	return collides(piece.type, piece.rotation, piece.x, piece.y);
+}
+
+inline int LBoard::dropDistance(const LPiece& piece) const
+{
+	//Rows above the stack are empty, the box can fall straight onto it
+	int distance = mStackTop - 4 - piece.y;
+	if (distance < 0)
+	{
+		distance = 0;
+	}
+	while (!collides(piece.type, piece.rotation, piece.x, piece.y + distance + 1))
+	{
+		++distance;
+	}
+	return distance;
+}
+
+inline int LBoard::ghostY(const LPiece& piece) const
+{
+	return piece.y + dropDistance(piece);
+}
+
+inline uint16_t LBoard::getRow(int y) const
+{
+	return mRows[y];
+}
+
+inline uint16_t LBoard::getCells(int y) const
+{
+	return (uint16_t)((mRows[y] >> BOARD_WALL_BITS) & ((1 << BOARD_WIDTH) - 1));
+}
+
+inline bool LBoard::isFilled(int x, int y) const
+{
+	return (mRows[y] >> (x + BOARD_WALL_BITS)) & 1;
+}
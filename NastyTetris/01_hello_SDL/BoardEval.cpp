@@ -0,0 +1,361 @@
+/* Headers */
+#include "BoardEval.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+//x86 builds carry the vector kernels, everything else only the scalar one
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define EVAL_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+//GCC and Clang only emit instructions a function is marked for, MSVC takes intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define EVAL_SSE2_FUNCTION __attribute__((target("sse2")))
+#define EVAL_AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define EVAL_SSE2_FUNCTION
+#define EVAL_AVX2_FUNCTION
+#endif
+
+
+
+/* Constants */
+
+//Playfield bits of a row
+const Uint32 EVAL_ROW_MASK = (1u << BOARD_WIDTH) - 1;
+
+//Neighboring column pairs, bit c for columns c and c + 1
+const Uint32 EVAL_PAIR_MASK = (1u << (BOARD_WIDTH - 1)) - 1;
+
+//A row shifted up one bit with both walls set, and the cell pairs along it
+const Uint32 EVAL_WALLS = 1u | (1u << (BOARD_WIDTH + 1));
+const Uint32 EVAL_TRANSITION_MASK = (1u << (BOARD_WIDTH + 1)) - 1;
+
+static int countBits(Uint32 bits)
+{
+	int count = 0;
+	while (bits != 0)
+	{
+		bits &= bits - 1;
+		++count;
+	}
+	return count;
+}
+
+//Every feature is a sum over rows of bits counted in masks built from the row and the cells covered so far
+//Column heights never get computed: a column adds one to the aggregate for every row at or below its top,
+//and neighbors differ in exactly the rows where only one of them is covered
+static void evaluateScalar(const LBoardBatch& batch, LFeatureBatch* features)
+{
+	for (int lane = 0; lane < EVAL_BATCH_SIZE; ++lane)
+	{
+		Uint32 covered = 0;
+		int aggregateHeight = 0;
+		int maxHeight = 0;
+		int holes = 0;
+		int bumpiness = 0;
+		int rowTransitions = 0;
+		int wells = 0;
+		for (int y = 0; y < BOARD_HEIGHT; ++y)
+		{
+			Uint32 cells = batch.rows[y][lane];
+			covered |= cells;
+			Uint32 walled = (cells << 1) | EVAL_WALLS;
+
+			aggregateHeight += countBits(covered);
+			holes += countBits(covered & ~cells);
+			bumpiness += countBits((covered ^ (covered >> 1)) & EVAL_PAIR_MASK);
+			wells += countBits(walled & (walled >> 2) & ~covered & EVAL_ROW_MASK);
+			if (covered != 0)
+			{
+				++maxHeight;
+				rowTransitions += countBits((walled ^ (walled >> 1)) & EVAL_TRANSITION_MASK);
+			}
+		}
+
+		features->aggregateHeight[lane] = (Uint16)aggregateHeight;
+		features->maxHeight[lane] = (Uint16)maxHeight;
+		features->holes[lane] = (Uint16)holes;
+		features->bumpiness[lane] = (Uint16)bumpiness;
+		features->rowTransitions[lane] = (Uint16)rowTransitions;
+		features->wells[lane] = (Uint16)wells;
+	}
+}
+
+#ifdef EVAL_X86
+//Bits set in each 16 bit lane
+EVAL_SSE2_FUNCTION static inline __m128i countBitsSSE2(__m128i v)
+{
+	v = _mm_sub_epi16(v, _mm_and_si128(_mm_srli_epi16(v, 1), _mm_set1_epi16(0x5555)));
+	v = _mm_add_epi16(_mm_and_si128(v, _mm_set1_epi16(0x3333)), _mm_and_si128(_mm_srli_epi16(v, 2), _mm_set1_epi16(0x3333)));
+	v = _mm_and_si128(_mm_add_epi16(v, _mm_srli_epi16(v, 4)), _mm_set1_epi16(0x0F0F));
+	return _mm_and_si128(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), _mm_set1_epi16(0x001F));
+}
+
+//Same sums as the scalar kernel, eight boards per register
+EVAL_SSE2_FUNCTION static void evaluateSSE2(const LBoardBatch& batch, LFeatureBatch* features)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i rowMask = _mm_set1_epi16((short)EVAL_ROW_MASK);
+	const __m128i pairMask = _mm_set1_epi16((short)EVAL_PAIR_MASK);
+	const __m128i walls = _mm_set1_epi16((short)EVAL_WALLS);
+	const __m128i transitionMask = _mm_set1_epi16((short)EVAL_TRANSITION_MASK);
+
+	for (int lane = 0; lane < EVAL_BATCH_SIZE; lane += 8)
+	{
+		__m128i covered = zero;
+		__m128i aggregateHeight = zero;
+		__m128i maxHeight = zero;
+		__m128i holes = zero;
+		__m128i bumpiness = zero;
+		__m128i rowTransitions = zero;
+		__m128i wells = zero;
+		for (int y = 0; y < BOARD_HEIGHT; ++y)
+		{
+			__m128i cells = _mm_load_si128((const __m128i*)&batch.rows[y][lane]);
+			covered = _mm_or_si128(covered, cells);
+			__m128i walled = _mm_or_si128(_mm_slli_epi16(cells, 1), walls);
+			__m128i empty = _mm_cmpeq_epi16(covered, zero);
+
+			aggregateHeight = _mm_add_epi16(aggregateHeight, countBitsSSE2(covered));
+			holes = _mm_add_epi16(holes, countBitsSSE2(_mm_andnot_si128(cells, covered)));
+			bumpiness = _mm_add_epi16(bumpiness, countBitsSSE2(_mm_and_si128(_mm_xor_si128(covered, _mm_srli_epi16(covered, 1)), pairMask)));
+			wells = _mm_add_epi16(wells, countBitsSSE2(_mm_and_si128(_mm_andnot_si128(covered, _mm_and_si128(walled, _mm_srli_epi16(walled, 2))), rowMask)));
+			maxHeight = _mm_add_epi16(maxHeight, _mm_andnot_si128(empty, one));
+			__m128i transitions = countBitsSSE2(_mm_and_si128(_mm_xor_si128(walled, _mm_srli_epi16(walled, 1)), transitionMask));
+			rowTransitions = _mm_add_epi16(rowTransitions, _mm_andnot_si128(empty, transitions));
+		}
+
+		_mm_store_si128((__m128i*)&features->aggregateHeight[lane], aggregateHeight);
+		_mm_store_si128((__m128i*)&features->maxHeight[lane], maxHeight);
+		_mm_store_si128((__m128i*)&features->holes[lane], holes);
+		_mm_store_si128((__m128i*)&features->bumpiness[lane], bumpiness);
+		_mm_store_si128((__m128i*)&features->rowTransitions[lane], rowTransitions);
+		_mm_store_si128((__m128i*)&features->wells[lane], wells);
+	}
+}
+
+EVAL_AVX2_FUNCTION static inline __m256i countBitsAVX2(__m256i v)
+{
+	v = _mm256_sub_epi16(v, _mm256_and_si256(_mm256_srli_epi16(v, 1), _mm256_set1_epi16(0x5555)));
+	v = _mm256_add_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x3333)), _mm256_and_si256(_mm256_srli_epi16(v, 2), _mm256_set1_epi16(0x3333)));
+	v = _mm256_and_si256(_mm256_add_epi16(v, _mm256_srli_epi16(v, 4)), _mm256_set1_epi16(0x0F0F));
+	return _mm256_and_si256(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), _mm256_set1_epi16(0x001F));
+}
+
+//Same sums again, the whole batch in one register
+EVAL_AVX2_FUNCTION static void evaluateAVX2(const LBoardBatch& batch, LFeatureBatch* features)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi16(1);
+	const __m256i rowMask = _mm256_set1_epi16((short)EVAL_ROW_MASK);
+	const __m256i pairMask = _mm256_set1_epi16((short)EVAL_PAIR_MASK);
+	const __m256i walls = _mm256_set1_epi16((short)EVAL_WALLS);
+	const __m256i transitionMask = _mm256_set1_epi16((short)EVAL_TRANSITION_MASK);
+
+	__m256i covered = zero;
+	__m256i aggregateHeight = zero;
+	__m256i maxHeight = zero;
+	__m256i holes = zero;
+	__m256i bumpiness = zero;
+	__m256i rowTransitions = zero;
+	__m256i wells = zero;
+	for (int y = 0; y < BOARD_HEIGHT; ++y)
+	{
+		__m256i cells = _mm256_load_si256((const __m256i*)batch.rows[y]);
+		covered = _mm256_or_si256(covered, cells);
+		__m256i walled = _mm256_or_si256(_mm256_slli_epi16(cells, 1), walls);
+		__m256i empty = _mm256_cmpeq_epi16(covered, zero);
+
+		aggregateHeight = _mm256_add_epi16(aggregateHeight, countBitsAVX2(covered));
+		holes = _mm256_add_epi16(holes, countBitsAVX2(_mm256_andnot_si256(cells, covered)));
+		bumpiness = _mm256_add_epi16(bumpiness, countBitsAVX2(_mm256_and_si256(_mm256_xor_si256(covered, _mm256_srli_epi16(covered, 1)), pairMask)));
+		wells = _mm256_add_epi16(wells, countBitsAVX2(_mm256_and_si256(_mm256_andnot_si256(covered, _mm256_and_si256(walled, _mm256_srli_epi16(walled, 2))), rowMask)));
+		maxHeight = _mm256_add_epi16(maxHeight, _mm256_andnot_si256(empty, one));
+		__m256i transitions = countBitsAVX2(_mm256_and_si256(_mm256_xor_si256(walled, _mm256_srli_epi16(walled, 1)), transitionMask));
+		rowTransitions = _mm256_add_epi16(rowTransitions, _mm256_andnot_si256(empty, transitions));
+	}
+
+	_mm256_store_si256((__m256i*)features->aggregateHeight, aggregateHeight);
+	_mm256_store_si256((__m256i*)features->maxHeight, maxHeight);
+	_mm256_store_si256((__m256i*)features->holes, holes);
+	_mm256_store_si256((__m256i*)features->bumpiness, bumpiness);
+	_mm256_store_si256((__m256i*)features->rowTransitions, rowTransitions);
+	_mm256_store_si256((__m256i*)features->wells, wells);
+}
+#endif
+
+void clearBoardBatch(LBoardBatch* batch)
+{
+	memset(batch->rows, 0, sizeof(batch->rows));
+}
+
+void packBoard(LBoardBatch* batch, int lane, const LBoard& board)
+{
+	for (int y = 0; y < BOARD_HEIGHT; ++y)
+	{
+		batch->rows[y][lane] = board.getCells(y);
+	}
+}
+
+bool isEvalKernelSupported(EvalKernel kernel)
+{
+	switch (kernel)
+	{
+	case EVAL_KERNEL_SCALAR:
+		return true;
+
+#ifdef EVAL_X86
+	case EVAL_KERNEL_SSE2:
+		return SDL_HasSSE2() == SDL_TRUE;
+
+	case EVAL_KERNEL_AVX2:
+		return SDL_HasAVX2() == SDL_TRUE;
+#endif
+
+	default:
+		return false;
+	}
+}
+
+EvalKernel getBestEvalKernel()
+{
+	//CPU features don't change while running, ask once
+	static const EvalKernel best = isEvalKernelSupported(EVAL_KERNEL_AVX2) ? EVAL_KERNEL_AVX2 :
+		isEvalKernelSupported(EVAL_KERNEL_SSE2) ? EVAL_KERNEL_SSE2 : EVAL_KERNEL_SCALAR;
+	return best;
+}
+
+const char* getEvalKernelName(EvalKernel kernel)
+{
+	static const char* const names[EVAL_KERNEL_TOTAL] = { "scalar", "SSE2", "AVX2" };
+	return kernel >= 0 && kernel < EVAL_KERNEL_TOTAL ? names[kernel] : "unknown";
+}
+
+void evaluateBatch(const LBoardBatch& batch, LFeatureBatch* features, EvalKernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef EVAL_X86
+	case EVAL_KERNEL_SSE2:
+		evaluateSSE2(batch, features);
+		break;
+
+	case EVAL_KERNEL_AVX2:
+		evaluateAVX2(batch, features);
+		break;
+#endif
+
+	default:
+		evaluateScalar(batch, features);
+		break;
+	}
+}
+
+void evaluateBatch(const LBoardBatch& batch, LFeatureBatch* features)
+{
+	evaluateBatch(batch, features, getBestEvalKernel());
+}
+
+void getBoardFeatures(const LBoard& board, LBoardFeatures* features)
+{
+	//Lane 0 of the scalar kernel without going through a whole batch
+	Uint32 covered = 0;
+	memset(features, 0, sizeof(*features));
+	for (int y = 0; y < BOARD_HEIGHT; ++y)
+	{
+		Uint32 cells = board.getCells(y);
+		covered |= cells;
+		Uint32 walled = (cells << 1) | EVAL_WALLS;
+
+		features->aggregateHeight += countBits(covered);
+		features->holes += countBits(covered & ~cells);
+		features->bumpiness += countBits((covered ^ (covered >> 1)) & EVAL_PAIR_MASK);
+		features->wells += countBits(walled & (walled >> 2) & ~covered & EVAL_ROW_MASK);
+		if (covered != 0)
+		{
+			++features->maxHeight;
+			features->rowTransitions += countBits((walled ^ (walled >> 1)) & EVAL_TRANSITION_MASK);
+		}
+	}
+}
+
+bool runEvalBenchmark(int boards, int iterations)
+{
+	//Ragged stacks with a hole now and then, like the ones a search looks at
+	int batches = (boards + EVAL_BATCH_SIZE - 1) / EVAL_BATCH_SIZE;
+	std::vector<LBoardBatch> input(batches);
+	Uint32 random = 0x2545F491;
+	for (int b = 0; b < batches; ++b)
+	{
+		clearBoardBatch(&input[b]);
+		for (int lane = 0; lane < EVAL_BATCH_SIZE; ++lane)
+		{
+			for (int x = 0; x < BOARD_WIDTH; ++x)
+			{
+				random ^= random << 13;
+				random ^= random >> 17;
+				random ^= random << 5;
+				int height = (int)(random % 16);
+				for (int y = BOARD_HEIGHT - height; y < BOARD_HEIGHT; ++y)
+				{
+					random ^= random << 13;
+					random ^= random >> 17;
+					random ^= random << 5;
+					if (random % 8 != 0)
+					{
+						input[b].rows[y][lane] |= (Uint16)(1u << x);
+					}
+				}
+			}
+		}
+	}
+
+	//Reference results
+	std::vector<LFeatureBatch> expected(batches);
+	for (int b = 0; b < batches; ++b)
+	{
+		evaluateBatch(input[b], &expected[b], EVAL_KERNEL_SCALAR);
+	}
+
+	printf("Evaluating %d boards %d times\n", batches * EVAL_BATCH_SIZE, iterations);
+	bool success = true;
+	double scalarNs = 0.0;
+	std::vector<LFeatureBatch> output(batches);
+	for (int kernel = 0; kernel < EVAL_KERNEL_TOTAL; ++kernel)
+	{
+		if (!isEvalKernelSupported((EvalKernel)kernel))
+		{
+			printf("%-8s not supported\n", getEvalKernelName((EvalKernel)kernel));
+			continue;
+		}
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		for (int i = 0; i < iterations; ++i)
+		{
+			for (int b = 0; b < batches; ++b)
+			{
+				evaluateBatch(input[b], &output[b], (EvalKernel)kernel);
+			}
+		}
+		Uint64 end = SDL_GetPerformanceCounter();
+
+		//Every kernel has to agree with the scalar one bit for bit
+		bool match = memcmp(&output[0], &expected[0], sizeof(LFeatureBatch) * batches) == 0;
+		success = success && match;
+
+		double ns = (double)(end - start) * 1e9 / (double)SDL_GetPerformanceFrequency() / ((double)iterations * batches * EVAL_BATCH_SIZE);
+		if (kernel == EVAL_KERNEL_SCALAR)
+		{
+			scalarNs = ns;
+		}
+		printf("%-8s %7.2f ns/board %6.1fx %s\n", getEvalKernelName((EvalKernel)kernel), ns, ns > 0.0 ? scalarNs / ns : 0.0, match ? "matches" : "MISMATCH");
+	}
+	printf("Search uses %s\n", getEvalKernelName(getBestEvalKernel()));
+
+	return success;
+}
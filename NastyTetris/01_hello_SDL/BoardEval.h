@@ -0,0 +1,86 @@
+#pragma once
+
+/* Headers */
+//Using SDL CPU detection and the bitboard playfield
+#include <SDL.h>
+#include "Board.h"
+
+
+
+/* Constants */
+
+//Boards evaluated by one kernel call, one 16 bit lane each
+const int EVAL_BATCH_SIZE = 16;
+
+//Kernels, every one gives exactly the same numbers
+enum EvalKernel
+{
+	EVAL_KERNEL_SCALAR,
+	EVAL_KERNEL_SSE2,
+	EVAL_KERNEL_AVX2,
+	EVAL_KERNEL_TOTAL
+};
+
+//Shape features of one board
+struct LBoardFeatures
+{
+	//Sum and maximum of the column heights
+	int aggregateHeight;
+	int maxHeight;
+
+	//Empty cells with a filled cell somewhere above
+	int holes;
+
+	//Sum of height differences between neighboring columns
+	int bumpiness;
+
+	//Filled to empty changes along the rows of the stack, walls count as filled
+	int rowTransitions;
+
+	//Open cells with filled cells or walls on both sides
+	int wells;
+};
+
+//Boards packed for the kernels, row y of every board side by side so one vector load reads a row of many boards
+struct LBoardBatch
+{
+	alignas(32) Uint16 rows[BOARD_HEIGHT][EVAL_BATCH_SIZE];
+};
+
+//Features of a batch, one array per feature in lane order
+struct LFeatureBatch
+{
+	alignas(32) Uint16 aggregateHeight[EVAL_BATCH_SIZE];
+	alignas(32) Uint16 maxHeight[EVAL_BATCH_SIZE];
+	alignas(32) Uint16 holes[EVAL_BATCH_SIZE];
+	alignas(32) Uint16 bumpiness[EVAL_BATCH_SIZE];
+	alignas(32) Uint16 rowTransitions[EVAL_BATCH_SIZE];
+	alignas(32) Uint16 wells[EVAL_BATCH_SIZE];
+};
+
+//Empties every lane, empty lanes evaluate to zero features
+void clearBoardBatch(LBoardBatch* batch);
+
+//Copies the playfield of a board into a lane
+void packBoard(LBoardBatch* batch, int lane, const LBoard& board);
+
+//Computes the features of every lane with the given kernel, which must be supported
+void evaluateBatch(const LBoardBatch& batch, LFeatureBatch* features, EvalKernel kernel);
+
+//Computes the features of every lane with the fastest kernel the CPU runs
+void evaluateBatch(const LBoardBatch& batch, LFeatureBatch* features);
+
+//Computes the features of a single board
+void getBoardFeatures(const LBoard& board, LBoardFeatures* features);
+
+//Checks whether this build and CPU can run a kernel
+bool isEvalKernelSupported(EvalKernel kernel);
+
+//Gets the kernel evaluateBatch() picks
+EvalKernel getBestEvalKernel();
+
+//Gets a kernel's name for logs
+const char* getEvalKernelName(EvalKernel kernel);
+
+//Times every supported kernel on the same boards and checks they agree, returns false on a mismatch
+bool runEvalBenchmark(int boards, int iterations);
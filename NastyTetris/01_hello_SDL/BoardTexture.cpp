@@ -0,0 +1,153 @@
+/* Headers */
+#include "BoardTexture.h"
+#include "LTexture.h"
+#include "SpriteBatch.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+LBoardTexture::LBoardTexture()
+{
+	//Initialize
+	mTexture = NULL;
+	mCellSize = 0;
+	mWidth = 0;
+	mHeight = 0;
+	memset(mCells, BOARD_TEXTURE_STALE, sizeof(mCells));
+	mUploadedRows = 0;
+}
+
+LBoardTexture::~LBoardTexture()
+{
+	//Deallocate
+	free();
+}
+
+bool LBoardTexture::create(int cellSize)
+{
+	//Get rid of preexisting texture
+	free();
+
+	mTexture = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, BOARD_WIDTH * cellSize, BOARD_VISIBLE_HEIGHT * cellSize);
+	if (mTexture == NULL)
+	{
+		printf("Unable to create board texture! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	//Cells are opaque, copying them needs no blending
+	SDL_SetTextureBlendMode(mTexture, SDL_BLENDMODE_NONE);
+	mCellSize = cellSize;
+	mWidth = BOARD_WIDTH * cellSize;
+	mHeight = BOARD_VISIBLE_HEIGHT * cellSize;
+	mPixels.resize((size_t)mWidth * mHeight);
+	invalidate();
+	return true;
+}
+
+void LBoardTexture::free()
+{
+	if (mTexture != NULL)
+	{
+		SDL_DestroyTexture(mTexture);
+		mTexture = NULL;
+		mCellSize = 0;
+		mWidth = 0;
+		mHeight = 0;
+	}
+	invalidate();
+}
+
+void LBoardTexture::invalidate()
+{
+	memset(mCells, BOARD_TEXTURE_STALE, sizeof(mCells));
+}
+
+bool LBoardTexture::update(const LGame& game, const SDL_Color* palette, SDL_Color wellColor)
+{
+	mUploadedRows = 0;
+	if (mTexture == NULL)
+	{
+		return false;
+	}
+
+	//ARGB8888 is a packed format, the same shifts work on any byte order
+	Uint32 well = ((Uint32)wellColor.a << 24) | ((Uint32)wellColor.r << 16) | ((Uint32)wellColor.g << 8) | wellColor.b;
+
+	int row = 0;
+	while (row < BOARD_VISIBLE_HEIGHT)
+	{
+		//Neighboring changed rows, like the ones a line clear shifts down, go up in one call
+		int first = row;
+		while (row < BOARD_VISIBLE_HEIGHT)
+		{
+			Uint8 cells[BOARD_WIDTH];
+			for (int x = 0; x < BOARD_WIDTH; ++x)
+			{
+				cells[x] = (Uint8)game.getCell(x, row + BOARD_HIDDEN_HEIGHT);
+			}
+			if (memcmp(cells, mCells[row], sizeof(cells)) == 0)
+			{
+				break;
+			}
+			memcpy(mCells[row], cells, sizeof(cells));
+
+			//Cell colors with the grid line along the right and bottom edge of each cell
+			Uint32* pixels = &mPixels[(size_t)(row - first) * mCellSize * mWidth];
+			for (int x = 0; x < BOARD_WIDTH; ++x)
+			{
+				Uint32 color = well;
+				if (cells[x] != PIECE_NONE)
+				{
+					SDL_Color cellColor = palette[cells[x]];
+					color = ((Uint32)cellColor.a << 24) | ((Uint32)cellColor.r << 16) | ((Uint32)cellColor.g << 8) | cellColor.b;
+				}
+				for (int px = 0; px < mCellSize; ++px)
+				{
+					pixels[x * mCellSize + px] = px < mCellSize - 1 ? color : well;
+				}
+			}
+			for (int py = 1; py < mCellSize; ++py)
+			{
+				Uint32* line = pixels + (size_t)py * mWidth;
+				if (py < mCellSize - 1)
+				{
+					memcpy(line, pixels, sizeof(Uint32) * mWidth);
+				}
+				else
+				{
+					for (int px = 0; px < mWidth; ++px)
+					{
+						line[px] = well;
+					}
+				}
+			}
+			++row;
+		}
+
+		if (row > first)
+		{
+			SDL_Rect rect = { 0, first * mCellSize, mWidth, (row - first) * mCellSize };
+			SDL_UpdateTexture(mTexture, &rect, &mPixels[0], mWidth * (int)sizeof(Uint32));
+			mUploadedRows += row - first;
+		}
+		else
+		{
+			++row;
+		}
+	}
+	return true;
+}
+
+void LBoardTexture::render(int x, int y) const
+{
+	SDL_FRect destination = { (float)x, (float)y, (float)mWidth, (float)mHeight };
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	gSpriteBatch.draw(mTexture, NULL, destination, white, SDL_BLENDMODE_NONE);
+}
+
+int LBoardTexture::getUploadedRows() const
+{
+	return mUploadedRows;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+/* Headers */
+//Using SDL, the game's cells and STL vector
+#include <SDL.h>
+#include <vector>
+#include "Game.h"
+
+
+
+/* Constants */
+
+//Cell value no game ever has, marks texture rows whose content is unknown
+const Uint8 BOARD_TEXTURE_STALE = 0xFF;
+
+//Keeps the locked cells of the visible well in one streaming texture
+//Rows are compared with what the texture holds and only the ones that changed are uploaded, so the well draws as a single quad
+class LBoardTexture
+{
+public:
+	//Initializes variables
+	LBoardTexture();
+
+	//Deallocates memory
+	~LBoardTexture();
+
+	//Creates the texture, cellSize pixels per cell with the last pixel row and column left as grid
+	bool create(int cellSize);
+
+	//Deallocates texture
+	void free();
+
+	//Forces every row to be uploaded again, needed when the renderer lost its textures
+	void invalidate();
+
+	//Uploads the rows whose cells changed, palette holds a color per piece type and empty cells and grid get the well color
+	//False when there is no texture to update
+	bool update(const LGame& game, const SDL_Color* palette, SDL_Color wellColor);
+
+	//Queues the well at the given point into the frame batch
+	void render(int x, int y) const;
+
+	//Gets how many rows the last update() uploaded
+	int getUploadedRows() const;
+
+private:
+	//Streaming texture and its size
+	SDL_Texture* mTexture;
+	int mCellSize;
+	int mWidth;
+	int mHeight;
+
+	//Cells the texture holds, BOARD_TEXTURE_STALE where it has to be uploaded whatever the game holds
+	Uint8 mCells[BOARD_VISIBLE_HEIGHT][BOARD_WIDTH];
+
+	//Pixels of the rows being uploaded, kept between updates
+	std::vector<Uint32> mPixels;
+
+	//Rows uploaded by the last update
+	int mUploadedRows;
+};
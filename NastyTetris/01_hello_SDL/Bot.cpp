@@ -0,0 +1,929 @@
+/* Headers */
+#include "Bot.h"
+#include "TaskPool.h"
+#include "BoardEval.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+
+/* Constants */
+
+//Search grid over every rotation, box column and box row a piece can take
+const int BOT_COLUMNS = 16;
+const int BOT_ROWS = BOARD_HEIGHT + 1;
+const int BOT_STATES = ROTATION_TOTAL * BOT_COLUMNS * BOT_ROWS;
+
+//Moves the search tries from every state, in the order shortest paths prefer them
+const int BOT_MOVES = 5;
+const Uint32 gBotMoveActions[BOT_MOVES] = { ACTION_LEFT, ACTION_RIGHT, ACTION_ROTATE_CW, ACTION_ROTATE_CCW, ACTION_SOFT_DROP };
+
+//Evaluation weights the bot plays with unless told otherwise
+const LBotWeights gBotDefaultWeights = { 50, 350, 18, 10, 12, 200 };
+
+//Rewards for 0 to 4 cleared lines, without and with a T-spin
+const int gBotLineRewards[5] = { 0, 40, 150, 300, 1200 };
+const int gBotTSpinRewards[4] = { 50, 700, 1600, 2400 };
+
+//Value of a line that ends the game
+const int BOT_LOST_VALUE = -1000000000;
+
+//Index of a piece state in the search grid
+static int stateIndex(const LPiece& piece)
+{
+	return (piece.rotation * BOT_COLUMNS + piece.x + BOARD_WALL_BITS) * BOT_ROWS + piece.y;
+}
+
+static LPiece stateFromIndex(PieceType type, int index)
+{
+	LPiece piece;
+	piece.type = type;
+	piece.y = index % BOT_ROWS;
+	piece.x = (index / BOT_ROWS) % BOT_COLUMNS - BOARD_WALL_BITS;
+	piece.rotation = index / (BOT_ROWS * BOT_COLUMNS);
+	return piece;
+}
+
+//Applies one move, false if it is blocked
+static bool applyMove(const LBoard& board, LPiece& piece, Uint32 action, int* kick)
+{
+	switch (action)
+	{
+	case ACTION_LEFT:
+		return board.tryMove(piece, -1, 0);
+
+	case ACTION_RIGHT:
+		return board.tryMove(piece, 1, 0);
+
+	case ACTION_SOFT_DROP:
+	{
+		//Soft drop always runs to the floor, rows in between are never worth stopping at
+		int distance = board.dropDistance(piece);
+		piece.y += distance;
+		return distance > 0;
+	}
+
+	case ACTION_ROTATE_CW:
+		return board.tryRotate(piece, 1, kick);
+
+	default:
+		return board.tryRotate(piece, -1, kick);
+	}
+}
+
+//Rotation and box offset covering the same cells as another rotation, for pieces with symmetric rotations
+struct LRotationAlias
+{
+	int rotation[PIECE_TOTAL][ROTATION_TOTAL];
+	int dx[PIECE_TOTAL][ROTATION_TOTAL];
+	int dy[PIECE_TOTAL][ROTATION_TOTAL];
+};
+
+static LRotationAlias buildRotationAliases()
+{
+	LRotationAlias alias;
+	for (int type = 0; type < PIECE_TOTAL; ++type)
+	{
+		for (int rotation = 0; rotation < ROTATION_TOTAL; ++rotation)
+		{
+			alias.rotation[type][rotation] = rotation;
+			alias.dx[type][rotation] = 0;
+			alias.dy[type][rotation] = 0;
+
+			//Earliest rotation whose mask moved inside the box matches this one
+			uint64_t mask = gPieceMasks[type][rotation];
+			bool found = false;
+			for (int other = 0; other < rotation && !found; ++other)
+			{
+				for (int dy = -3; dy <= 3 && !found; ++dy)
+				{
+					for (int dx = -3; dx <= 3 && !found; ++dx)
+					{
+						uint64_t moved = gPieceMasks[type][other];
+						moved = dy >= 0 ? moved << (16 * dy) : moved >> (16 * -dy);
+						moved = dx >= 0 ? moved << dx : moved >> -dx;
+						if (moved == mask)
+						{
+							alias.rotation[type][rotation] = other;
+							alias.dx[type][rotation] = dx;
+							alias.dy[type][rotation] = dy;
+							found = true;
+						}
+					}
+				}
+			}
+		}
+	}
+	return alias;
+}
+
+//State covering the same cells with the lowest rotation
+static int canonicalIndex(const LPiece& piece)
+{
+	static const LRotationAlias alias = buildRotationAliases();
+	LPiece canonical = piece;
+	canonical.rotation = alias.rotation[piece.type][piece.rotation];
+	canonical.x = piece.x + alias.dx[piece.type][piece.rotation];
+	canonical.y = piece.y + alias.dy[piece.type][piece.rotation];
+	return stateIndex(canonical);
+}
+
+//Same rule the game uses to end a game on lock
+static bool isLockOut(const LPiece& piece)
+{
+	int hiddenRows = BOARD_HIDDEN_HEIGHT - piece.y;
+	return hiddenRows >= 4 || (hiddenRows > 0 && (gPieceMasks[piece.type][piece.rotation] >> (16 * hiddenRows)) == 0);
+}
+
+void captureBotState(const LGame& game, LBotState* state)
+{
+	state->board = game.getBoard();
+	state->piece = game.getPiece();
+	state->hold = game.getHold();
+	state->holdUsed = game.isHoldUsed();
+	for (int i = 0; i < NEXT_QUEUE_SIZE; ++i)
+	{
+		state->next[i] = game.getNext(i);
+	}
+}
+
+int generatePlacements(const LBoard& board, const LPiece& start, LPlacement* placements, int maxPlacements)
+{
+	if (board.collides(start))
+	{
+		return 0;
+	}
+	if (maxPlacements > BOT_MAX_PLACEMENTS)
+	{
+		maxPlacements = BOT_MAX_PLACEMENTS;
+	}
+
+	//Landing spot of each canonical state, -1 while unknown
+	Sint16 placementOf[BOT_STATES];
+	memset(placementOf, 0xFF, sizeof(placementOf));
+	int count = 0;
+
+	//Breadth first over every state reachable from the start, grounded states are landing spots
+	Uint8 visited[BOT_STATES];
+	memset(visited, 0, sizeof(visited));
+	Uint16 queue[BOT_STATES];
+	int head = 0;
+	int tail = 0;
+	int kick = 0;
+	for (int move = -1; head < tail || move < 0; move = 0)
+	{
+		//The first pass only adds the start
+		LPiece piece = start;
+		int moves = 1;
+		if (move == 0)
+		{
+			piece = stateFromIndex(start.type, queue[head++]);
+			moves = BOT_MOVES;
+		}
+
+		for (int i = 0; i < moves; ++i)
+		{
+			LPiece next = piece;
+			bool rotated = false;
+			if (move == 0)
+			{
+				if (!applyMove(board, next, gBotMoveActions[i], &kick))
+				{
+					continue;
+				}
+				rotated = (gBotMoveActions[i] & (ACTION_ROTATE_CW | ACTION_ROTATE_CCW)) != 0;
+			}
+
+			int index = stateIndex(next);
+			if (visited[index] == 0)
+			{
+				visited[index] = board.collides(next.type, next.rotation, next.x, next.y + 1) ? 2 : 1;
+				queue[tail++] = (Uint16)index;
+			}
+			else if (!rotated || next.type != PIECE_T)
+			{
+				continue;
+			}
+			if (visited[index] != 2)
+			{
+				continue;
+			}
+
+			//Rotations covering the same cells lock the same way
+			int canonical = canonicalIndex(next);
+			int placement = placementOf[canonical];
+			if (placement < 0)
+			{
+				if (count == maxPlacements)
+				{
+					continue;
+				}
+				placement = count++;
+				placements[placement].piece = next;
+				placements[placement].tSpin = TSPIN_NONE;
+				placementOf[canonical] = (Sint16)placement;
+			}
+
+			//Rotating into a T spot may make it a T-spin
+			if (rotated && next.type == PIECE_T)
+			{
+				TSpinType tSpin = board.checkTSpin(next, kick);
+				if (tSpin > placements[placement].tSpin)
+				{
+					placements[placement].tSpin = tSpin;
+				}
+			}
+		}
+	}
+
+	return count;
+}
+
+int findPath(const LBoard& board, const LPiece& start, const LPiece& target, TSpinType tSpin, Uint32* actions, LPiece* states, int maxLength)
+{
+	if (board.collides(start) || start.type != target.type)
+	{
+		return -1;
+	}
+
+	//Breadth first, remembering how every state was first reached
+	Sint16 parent[BOT_STATES];
+	Uint8 parentMove[BOT_STATES];
+	memset(parent, 0xFF, sizeof(parent));
+	Uint16 queue[BOT_STATES];
+	int head = 0;
+	int tail = 0;
+	int startIndex = stateIndex(start);
+	int targetIndex = stateIndex(target);
+	parent[startIndex] = (Sint16)startIndex;
+	queue[tail++] = (Uint16)startIndex;
+
+	//A T-spin only counts if the last move into the target was the right rotation
+	int last = -1;
+	int lastMove = 0;
+	if (startIndex == targetIndex && tSpin == TSPIN_NONE)
+	{
+		last = startIndex;
+		lastMove = -1;
+	}
+	while (head < tail && last < 0)
+	{
+		int index = queue[head++];
+		LPiece piece = stateFromIndex(start.type, index);
+		for (int move = 0; move < BOT_MOVES && last < 0; ++move)
+		{
+			LPiece next = piece;
+			int kick = 0;
+			if (!applyMove(board, next, gBotMoveActions[move], &kick))
+			{
+				continue;
+			}
+			int nextIndex = stateIndex(next);
+			if (nextIndex == targetIndex && (tSpin == TSPIN_NONE || ((gBotMoveActions[move] & (ACTION_ROTATE_CW | ACTION_ROTATE_CCW)) && board.checkTSpin(next, kick) >= tSpin)))
+			{
+				last = index;
+				lastMove = move;
+			}
+			else if (parent[nextIndex] < 0)
+			{
+				parent[nextIndex] = (Sint16)index;
+				parentMove[nextIndex] = (Uint8)move;
+				queue[tail++] = (Uint16)nextIndex;
+			}
+		}
+	}
+	if (last < 0)
+	{
+		return -1;
+	}
+
+	//Count the steps, then write them front to back
+	int length = lastMove >= 0 ? 1 : 0;
+	for (int index = last; index != startIndex; index = parent[index])
+	{
+		++length;
+	}
+	if (length > maxLength)
+	{
+		return -1;
+	}
+	states[length] = target;
+	int step = length;
+	if (lastMove >= 0)
+	{
+		--step;
+		actions[step] = gBotMoveActions[lastMove];
+		states[step] = stateFromIndex(start.type, last);
+	}
+	for (int index = last; index != startIndex; index = parent[index])
+	{
+		--step;
+		actions[step] = gBotMoveActions[parentMove[index]];
+		states[step] = stateFromIndex(start.type, parent[index]);
+	}
+	return length;
+}
+
+//Weighted sum of the features, danger grows with the square of the height above the danger line
+//Wells stay out, penalizing them fills in the slots T-spins need
+static int scoreFeatures(const LBotWeights& weights, int aggregateHeight, int maxHeight, int holes, int bumpiness, int rowTransitions)
+{
+	int danger = std::max(0, maxHeight - weights.dangerHeight);
+	return -weights.height * aggregateHeight - weights.holes * holes - weights.bumpiness * bumpiness
+		- weights.transitions * rowTransitions - weights.danger * danger * danger;
+}
+
+int evaluateBoard(const LBoard& board, const LBotWeights& weights)
+{
+	LBoardFeatures features;
+	getBoardFeatures(board, &features);
+	return scoreFeatures(weights, features.aggregateHeight, features.maxHeight, features.holes, features.bumpiness, features.rowTransitions);
+}
+
+//Position inside the search tree
+struct LSearchNode
+{
+	LBoard board;
+	PieceType current;
+	PieceType hold;
+	int next;
+};
+
+//One way to continue from a node
+struct LSearchChild
+{
+	LPlacement placement;
+	bool useHold;
+	PieceType current;
+	PieceType hold;
+	int next;
+	int reward;
+	int score;
+};
+
+//Piece the preview shows at index, none past its end
+static PieceType previewPiece(const LBotState& state, int index)
+{
+	return index < NEXT_QUEUE_SIZE ? state.next[index] : PIECE_NONE;
+}
+
+static LPiece spawnPiece(PieceType type)
+{
+	LPiece piece = { type, ROTATION_SPAWN, PIECE_SPAWN_X, PIECE_SPAWN_Y };
+	return piece;
+}
+
+//Locks a placement on a copy of the board, returns the reward or BOT_LOST_VALUE when the game would end
+static int applyPlacement(const LBoard& board, const LPlacement& placement, PieceType nextPiece, LBoard* after)
+{
+	if (isLockOut(placement.piece))
+	{
+		return BOT_LOST_VALUE;
+	}
+	*after = board;
+	int lines = after->lock(placement.piece);
+	if (nextPiece != PIECE_NONE && !after->canSpawn(nextPiece))
+	{
+		return BOT_LOST_VALUE;
+	}
+	return placement.tSpin == TSPIN_FULL ? gBotTSpinRewards[lines < 3 ? lines : 3] : gBotLineRewards[lines];
+}
+
+//Lists placements of the piece and what the node looks like after each
+static int addChildren(const LBoard& board, const LPiece& start, bool useHold, PieceType hold, int next, const LBotState& state, const LBotWeights& weights, LSearchChild* children, int count)
+{
+	LPlacement placements[BOT_MAX_PLACEMENTS];
+	int placementCount = generatePlacements(board, start, placements, BOT_MAX_PLACEMENTS);
+	PieceType current = previewPiece(state, next);
+
+	//Boards after each placement go through the evaluation kernel a batch at a time, unused lanes stay empty
+	LBoardBatch batch;
+	LFeatureBatch features;
+	clearBoardBatch(&batch);
+	for (int first = 0; first < placementCount; first += EVAL_BATCH_SIZE)
+	{
+		int lanes = std::min(EVAL_BATCH_SIZE, placementCount - first);
+		for (int lane = 0; lane < lanes; ++lane)
+		{
+			LSearchChild& child = children[count + first + lane];
+			child.placement = placements[first + lane];
+			child.useHold = useHold;
+			child.current = current;
+			child.hold = hold;
+			child.next = next + 1;
+
+			LBoard after;
+			child.reward = applyPlacement(board, child.placement, current, &after);
+			packBoard(&batch, lane, child.reward == BOT_LOST_VALUE ? board : after);
+		}
+
+		evaluateBatch(batch, &features);
+		for (int lane = 0; lane < lanes; ++lane)
+		{
+			LSearchChild& child = children[count + first + lane];
+			child.score = child.reward == BOT_LOST_VALUE ? BOT_LOST_VALUE : child.reward + scoreFeatures(weights, features.aggregateHeight[lane], features.maxHeight[lane],
+				features.holes[lane], features.bumpiness[lane], features.rowTransitions[lane]);
+		}
+	}
+	return count + placementCount;
+}
+
+//Lists children for placing the current piece, or the held one after a hold
+static int expandNode(const LSearchNode& node, const LPiece& start, bool holdAllowed, const LBotState& state, const LBotWeights& weights, LSearchChild* children)
+{
+	int count = addChildren(node.board, start, false, node.hold, node.next, state, weights, children, 0);
+	if (holdAllowed && node.hold != node.current)
+	{
+		if (node.hold != PIECE_NONE)
+		{
+			count = addChildren(node.board, spawnPiece(node.hold), true, node.current, node.next, state, weights, children, count);
+		}
+		else if (previewPiece(state, node.next) != PIECE_NONE)
+		{
+			//Holding into an empty slot brings the next piece in
+			count = addChildren(node.board, spawnPiece(previewPiece(state, node.next)), true, node.current, node.next + 1, state, weights, children, count);
+		}
+	}
+	return count;
+}
+
+static bool compareChildren(const LSearchChild& a, const LSearchChild& b)
+{
+	return a.score > b.score;
+}
+
+//Best total of rewards plus the final board score reachable from the node
+static int searchNode(const LSearchNode& node, int depth, const LBotState& state, const LBotWeights& weights, std::atomic<int>* nodes)
+{
+	if (node.current == PIECE_NONE)
+	{
+		return evaluateBoard(node.board, weights);
+	}
+
+	//Holding on the last piece only changes what comes after the search, so leaves skip it and cost half
+	LSearchChild children[2 * BOT_MAX_PLACEMENTS];
+	int count = expandNode(node, spawnPiece(node.current), depth > 1, state, weights, children);
+	nodes->fetch_add(count, std::memory_order_relaxed);
+	if (count == 0)
+	{
+		return BOT_LOST_VALUE;
+	}
+
+	//The last piece is scored directly, above it only the most promising children go deeper
+	std::sort(children, children + count, compareChildren);
+	if (depth <= 1 || children[0].score == BOT_LOST_VALUE)
+	{
+		return children[0].score;
+	}
+
+	int best = BOT_LOST_VALUE;
+	int expand = std::min(count, BOT_BEAM_WIDTH);
+	for (int i = 0; i < expand && children[i].score != BOT_LOST_VALUE; ++i)
+	{
+		LSearchNode child;
+		applyPlacement(node.board, children[i].placement, children[i].current, &child.board);
+		child.current = children[i].current;
+		child.hold = children[i].hold;
+		child.next = children[i].next;
+		int value = searchNode(child, depth - 1, state, weights, nodes);
+		if (value != BOT_LOST_VALUE)
+		{
+			best = std::max(best, children[i].reward + value);
+		}
+	}
+	return best;
+}
+
+//Root children handed to the task pool
+struct LRootSearch
+{
+	const LBotState* state;
+	const LBotWeights* weights;
+	int depth;
+	LSearchChild children[2 * BOT_MAX_PLACEMENTS];
+	int values[2 * BOT_MAX_PLACEMENTS];
+	std::atomic<int> nodes;
+};
+
+static void searchRootChild(void* data, int index)
+{
+	LRootSearch* search = (LRootSearch*)data;
+	const LSearchChild& root = search->children[index];
+	if (root.reward == BOT_LOST_VALUE || search->depth <= 1)
+	{
+		search->values[index] = root.score;
+		return;
+	}
+
+	LSearchNode child;
+	applyPlacement(search->state->board, root.placement, root.current, &child.board);
+	child.current = root.current;
+	child.hold = root.hold;
+	child.next = root.next;
+	int value = searchNode(child, search->depth - 1, *search->state, *search->weights, &search->nodes);
+	search->values[index] = value == BOT_LOST_VALUE ? BOT_LOST_VALUE : root.reward + value;
+}
+
+LBotPlan searchBestPlacement(const LBotState& state, const LBotWeights& weights, int depth, bool parallel)
+{
+	LProfileZone zone("Bot search");
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	LBotPlan plan;
+	memset(&plan, 0, sizeof(plan));
+	plan.value = BOT_LOST_VALUE;
+
+	//Every root child is its own task, their subtrees differ a lot in size so idle threads steal
+	//Kept on the stack, parallelFor() returns only once every task is done with it
+	LRootSearch search;
+	search.state = &state;
+	search.weights = &weights;
+	search.depth = depth;
+	search.nodes.store(0);
+	LSearchNode root;
+	root.board = state.board;
+	root.current = state.piece.type;
+	root.hold = state.hold;
+	root.next = 0;
+	int count = expandNode(root, state.piece, !state.holdUsed, state, weights, search.children);
+	if (parallel)
+	{
+		gTaskPool.parallelFor(count, searchRootChild, &search);
+	}
+	else
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			searchRootChild(&search, i);
+		}
+	}
+
+	//Earlier children win ties, they take fewer inputs
+	for (int i = 0; i < count; ++i)
+	{
+		if (search.values[i] > plan.value || (!plan.valid && search.values[i] == BOT_LOST_VALUE))
+		{
+			plan.valid = true;
+			plan.useHold = search.children[i].useHold;
+			plan.target = search.children[i].placement.piece;
+			plan.tSpin = search.children[i].placement.tSpin;
+			plan.value = search.values[i];
+		}
+	}
+	plan.nodes = count + search.nodes.load();
+
+	plan.milliseconds = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+	return plan;
+}
+
+LBotPlan searchBestPlacement(const LBotState& state, int depth)
+{
+	return searchBestPlacement(state, gBotDefaultWeights, depth, true);
+}
+
+//Bot used for hints and for playing by itself
+LBotPlayer gBot;
+
+LBotPlayer::LBotPlayer()
+{
+	//Initialize
+	memset(&mPlan, 0, sizeof(mPlan));
+	mHasPlan = false;
+	mPathLength = 0;
+	mPathIndex = 0;
+	mPathValid = false;
+	mActionInterval = BOT_ACTION_INTERVAL_TICKS;
+	mTicksUntilAction = 0;
+	mWeights = gBotDefaultWeights;
+	mParallelSearch = true;
+	mRequestedPieces = -1;
+	mRequestedHoldUsed = false;
+	mRequestId = 0;
+	mRequestPending = false;
+	memset(&mResult, 0, sizeof(mResult));
+	mResultId = 0;
+	mResultReady = false;
+	mLastSearchMs = 0.0;
+	mMaxSearchMs = 0.0;
+	mTotalSearchMs = 0.0;
+	mSearchCount = 0;
+	mThread = NULL;
+	mMutex = NULL;
+	mCondition = NULL;
+	mQuit = false;
+}
+
+LBotPlayer::~LBotPlayer()
+{
+	//Deallocate
+	stop();
+}
+
+bool LBotPlayer::start()
+{
+	//Get rid of preexisting thread
+	stop();
+
+	mMutex = SDL_CreateMutex();
+	mCondition = SDL_CreateCond();
+	if (mMutex == NULL || mCondition == NULL)
+	{
+		printf("Unable to create bot lock! SDL Error: %s\n", SDL_GetError());
+		stop();
+		return false;
+	}
+
+	mQuit = false;
+	mThread = SDL_CreateThread(searchThread, "BotSearch", this);
+	if (mThread == NULL)
+	{
+		printf("Unable to create bot thread! SDL Error: %s\n", SDL_GetError());
+		stop();
+		return false;
+	}
+	return true;
+}
+
+void LBotPlayer::stop()
+{
+	if (mThread != NULL)
+	{
+		SDL_LockMutex(mMutex);
+		mQuit = true;
+		SDL_CondSignal(mCondition);
+		SDL_UnlockMutex(mMutex);
+		SDL_WaitThread(mThread, NULL);
+		mThread = NULL;
+	}
+	if (mCondition != NULL)
+	{
+		SDL_DestroyCond(mCondition);
+		mCondition = NULL;
+	}
+	if (mMutex != NULL)
+	{
+		SDL_DestroyMutex(mMutex);
+		mMutex = NULL;
+	}
+	mRequestPending = false;
+	mResultReady = false;
+}
+
+void LBotPlayer::reset()
+{
+	mHasPlan = false;
+	mPathValid = false;
+	mTicksUntilAction = 0;
+	mRequestedPieces = -1;
+}
+
+int LBotPlayer::searchThread(void* data)
+{
+	((LBotPlayer*)data)->searchLoop();
+	return 0;
+}
+
+void LBotPlayer::searchLoop()
+{
+	SDL_LockMutex(mMutex);
+	while (!mQuit)
+	{
+		if (!mRequestPending)
+		{
+			SDL_CondWait(mCondition, mMutex);
+			continue;
+		}
+
+		//Search without holding the lock, a newer request just replaces this one
+		LBotState state = mRequest;
+		LBotWeights weights = mWeights;
+		bool parallel = mParallelSearch;
+		int id = mRequestId;
+		mRequestPending = false;
+		SDL_UnlockMutex(mMutex);
+		LBotPlan plan = searchBestPlacement(state, weights, BOT_SEARCH_DEPTH, parallel);
+		SDL_LockMutex(mMutex);
+
+		mResult = plan;
+		mResultId = id;
+		mResultReady = true;
+	}
+	SDL_UnlockMutex(mMutex);
+}
+
+void LBotPlayer::takeResult()
+{
+	if (mThread == NULL)
+	{
+		return;
+	}
+
+	SDL_LockMutex(mMutex);
+	bool ready = mResultReady && mResultId == mRequestId;
+	LBotPlan plan = mResult;
+	mResultReady = false;
+	SDL_UnlockMutex(mMutex);
+
+	if (ready)
+	{
+		mPlan = plan;
+		mHasPlan = plan.valid;
+		mPathValid = false;
+		mLastSearchMs = plan.milliseconds;
+		mMaxSearchMs = std::max(mMaxSearchMs, plan.milliseconds);
+		mTotalSearchMs += plan.milliseconds;
+		++mSearchCount;
+	}
+}
+
+void LBotPlayer::update(const LGame& game)
+{
+	takeResult();
+	if (game.isOver())
+	{
+		return;
+	}
+
+	//Search again whenever the piece to place changed
+	int pieces = game.getStats().pieces;
+	if (pieces == mRequestedPieces && game.isHoldUsed() == mRequestedHoldUsed)
+	{
+		return;
+	}
+	mRequestedPieces = pieces;
+	mRequestedHoldUsed = game.isHoldUsed();
+	mHasPlan = false;
+	mPathValid = false;
+
+	LBotState state;
+	captureBotState(game, &state);
+	if (mThread != NULL)
+	{
+		SDL_LockMutex(mMutex);
+		mRequest = state;
+		++mRequestId;
+		mRequestPending = true;
+		SDL_CondSignal(mCondition);
+		SDL_UnlockMutex(mMutex);
+	}
+	else
+	{
+		mPlan = searchBestPlacement(state, mWeights, BOT_SEARCH_DEPTH, mParallelSearch);
+		mHasPlan = mPlan.valid;
+		mLastSearchMs = mPlan.milliseconds;
+		mMaxSearchMs = std::max(mMaxSearchMs, mPlan.milliseconds);
+		mTotalSearchMs += mPlan.milliseconds;
+		++mSearchCount;
+	}
+}
+
+bool LBotPlayer::hasPlan() const
+{
+	return mHasPlan;
+}
+
+const LBotPlan& LBotPlayer::getPlan() const
+{
+	return mPlan;
+}
+
+void LBotPlayer::setActionInterval(int ticks)
+{
+	mActionInterval = ticks > 1 ? ticks : 1;
+}
+
+void LBotPlayer::setWeights(const LBotWeights& weights)
+{
+	//The search thread copies them along with each request
+	if (mMutex != NULL)
+	{
+		SDL_LockMutex(mMutex);
+	}
+	mWeights = weights;
+	if (mMutex != NULL)
+	{
+		SDL_UnlockMutex(mMutex);
+	}
+}
+
+const LBotWeights& LBotPlayer::getWeights() const
+{
+	return mWeights;
+}
+
+void LBotPlayer::setParallelSearch(bool parallel)
+{
+	if (mMutex != NULL)
+	{
+		SDL_LockMutex(mMutex);
+	}
+	mParallelSearch = parallel;
+	if (mMutex != NULL)
+	{
+		SDL_UnlockMutex(mMutex);
+	}
+}
+
+bool LBotPlayer::planPath(const LGame& game)
+{
+	mPathIndex = 0;
+	mPathLength = findPath(game.getBoard(), game.getPiece(), mPlan.target, mPlan.tSpin, mPath, mPathStates, BOT_MAX_PATH);
+	mPathValid = mPathLength >= 0;
+	return mPathValid;
+}
+
+static bool samePiece(const LPiece& a, const LPiece& b)
+{
+	return a.type == b.type && a.rotation == b.rotation && a.x == b.x && a.y == b.y;
+}
+
+bool LBotPlayer::isDropping(int index, const LPiece& piece) const
+{
+	//Soft drop takes several ticks, the piece is still on the path on its way down
+	if (index >= mPathLength || mPath[index] != ACTION_SOFT_DROP)
+	{
+		return false;
+	}
+	const LPiece& from = mPathStates[index];
+	return piece.type == from.type && piece.rotation == from.rotation && piece.x == from.x && piece.y > from.y && piece.y < mPathStates[index + 1].y;
+}
+
+Uint32 LBotPlayer::getActions(const LGame& game)
+{
+	update(game);
+	if (!mHasPlan || game.isOver())
+	{
+		return ACTION_NONE;
+	}
+	if (mTicksUntilAction > 0)
+	{
+		--mTicksUntilAction;
+		return ACTION_NONE;
+	}
+
+	//Hold first, the search already knows which piece comes in
+	if (mPlan.useHold && !game.isHoldUsed())
+	{
+		mRequestedHoldUsed = true;
+		mPathValid = false;
+		mTicksUntilAction = mActionInterval - 1;
+		return ACTION_HOLD;
+	}
+
+	//Follow the path, gravity or a failed move puts the piece somewhere else and the path is found again
+	const LPiece& piece = game.getPiece();
+	if (mPathValid)
+	{
+		int index = mPathIndex;
+		while (index <= mPathLength && !samePiece(mPathStates[index], piece) && !isDropping(index, piece))
+		{
+			++index;
+		}
+		mPathValid = index <= mPathLength;
+		mPathIndex = index;
+	}
+	if (!mPathValid && !planPath(game))
+	{
+		//Target out of reach now, search again from here
+		mHasPlan = false;
+		mRequestedPieces = -1;
+		return ACTION_NONE;
+	}
+
+	if (mPathIndex == mPathLength)
+	{
+		return ACTION_HARD_DROP;
+	}
+
+	//Soft drop is held until the piece gets there, everything else is one press
+	Uint32 action = mPath[mPathIndex];
+	if (action != ACTION_SOFT_DROP)
+	{
+		mTicksUntilAction = mActionInterval - 1;
+	}
+	return action;
+}
+
+double LBotPlayer::getLastSearchMs() const
+{
+	return mLastSearchMs;
+}
+
+double LBotPlayer::getMaxSearchMs() const
+{
+	return mMaxSearchMs;
+}
+
+double LBotPlayer::getTotalSearchMs() const
+{
+	return mTotalSearchMs;
+}
+
+int LBotPlayer::getSearchCount() const
+{
+	return mSearchCount;
+}
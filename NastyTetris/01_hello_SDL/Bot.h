@@ -0,0 +1,204 @@
+#pragma once
+
+/* Headers */
+//Using SDL threads and the game rules
+#include <SDL.h>
+#include "Game.h"
+
+
+
+/* Constants */
+
+//Pieces placed ahead in one search, the current piece included
+const int BOT_SEARCH_DEPTH = 3;
+
+//Children expanded below the root, the best ones by static score
+const int BOT_BEAM_WIDTH = 8;
+
+//Most distinct landing spots one piece can have
+const int BOT_MAX_PLACEMENTS = 128;
+
+//Longest input sequence from spawn to a landing spot
+const int BOT_MAX_PATH = 64;
+
+//Ticks between two bot inputs when it plays next to the rendered game
+const int BOT_ACTION_INTERVAL_TICKS = 4;
+
+//Evaluation weights, each one is subtracted per unit of its board feature
+struct LBotWeights
+{
+	int height;
+	int holes;
+	int bumpiness;
+	int transitions;
+
+	//Squared penalty on every row the stack rises above dangerHeight
+	int dangerHeight;
+	int danger;
+};
+
+//Weights the bot plays with unless told otherwise
+extern const LBotWeights gBotDefaultWeights;
+
+//Everything the search needs to know about a game, copied so searches can run on other threads
+struct LBotState
+{
+	LBoard board;
+	LPiece piece;
+	PieceType hold;
+	bool holdUsed;
+	PieceType next[NEXT_QUEUE_SIZE];
+};
+
+//A spot a piece can lock in, reached by shifts, soft drops and rotations
+struct LPlacement
+{
+	LPiece piece;
+	TSpinType tSpin;
+};
+
+//Outcome of a search
+struct LBotPlan
+{
+	//Whether the search found anything
+	bool valid;
+
+	//Hold before moving, target is then the held or next piece
+	bool useHold;
+	LPiece target;
+	TSpinType tSpin;
+
+	//Score of the best line and how much work finding it took
+	int value;
+	int nodes;
+	double milliseconds;
+};
+
+//Copies the parts of a game the search looks at
+void captureBotState(const LGame& game, LBotState* state);
+
+//Lists every distinct spot the piece can reach from where it is and lock in
+int generatePlacements(const LBoard& board, const LPiece& start, LPlacement* placements, int maxPlacements);
+
+//Finds the shortest input sequence from start to target, returns its length or -1 when unreachable
+//A T-spin target is only reached by a rotation that scores at least that T-spin
+//actions receives one GameAction per step, soft drop standing for a drop to the floor, states the piece before each step and the target
+int findPath(const LBoard& board, const LPiece& start, const LPiece& target, TSpinType tSpin, Uint32* actions, LPiece* states, int maxLength);
+
+//Heuristic score of a board, higher is better
+int evaluateBoard(const LBoard& board, const LBotWeights& weights = gBotDefaultWeights);
+
+//Searches placements of the current piece and the preview, on every core when parallel or else on the calling thread
+//Runs without allocating, so callers that are themselves pool tasks search serially
+LBotPlan searchBestPlacement(const LBotState& state, const LBotWeights& weights, int depth, bool parallel);
+
+//Searches with the default weights on every core
+LBotPlan searchBestPlacement(const LBotState& state, int depth = BOT_SEARCH_DEPTH);
+
+//Plays or suggests moves, searching in the background and steering the piece to the result
+class LBotPlayer
+{
+public:
+	//Initializes variables
+	LBotPlayer();
+
+	//Stops the search thread
+	~LBotPlayer();
+
+	//Starts the search thread, without it searches run inline
+	bool start();
+
+	//Waits for the search thread
+	void stop();
+
+	//Forgets the plan, for a new game
+	void reset();
+
+	//Picks up finished searches and starts one whenever a new piece comes up
+	void update(const LGame& game);
+
+	//Gets the plan for the current piece
+	bool hasPlan() const;
+	const LBotPlan& getPlan() const;
+
+	//Sets the ticks between inputs, 1 for full speed
+	void setActionInterval(int ticks);
+
+	//Sets the weights later searches use
+	void setWeights(const LBotWeights& weights);
+	const LBotWeights& getWeights() const;
+
+	//Spreads searches over the task pool or keeps them on one thread, for bots that already run as pool tasks
+	void setParallelSearch(bool parallel);
+
+	//Gets the inputs for this tick that move the piece along the plan
+	Uint32 getActions(const LGame& game);
+
+	//Gets search statistics
+	double getLastSearchMs() const;
+	double getMaxSearchMs() const;
+	double getTotalSearchMs() const;
+	int getSearchCount() const;
+
+private:
+	//Search thread entry point
+	static int searchThread(void* data);
+
+	//Runs requested searches until stopped
+	void searchLoop();
+
+	//Takes a finished plan from the search thread
+	void takeResult();
+
+	//Recomputes the inputs from the current piece to the target
+	bool planPath(const LGame& game);
+
+	//Checks whether the piece is between the ends of a soft drop step of the path
+	bool isDropping(int index, const LPiece& piece) const;
+
+	//Plan being followed
+	LBotPlan mPlan;
+	bool mHasPlan;
+
+	//Inputs toward the target and the states they lead through
+	Uint32 mPath[BOT_MAX_PATH];
+	LPiece mPathStates[BOT_MAX_PATH + 1];
+	int mPathLength;
+	int mPathIndex;
+	bool mPathValid;
+
+	//Pacing
+	int mActionInterval;
+	int mTicksUntilAction;
+
+	//How searches run
+	LBotWeights mWeights;
+	bool mParallelSearch;
+
+	//Position a search was last started for
+	int mRequestedPieces;
+	bool mRequestedHoldUsed;
+
+	//Search handed to the thread and its result, ids tell stale results apart
+	LBotState mRequest;
+	int mRequestId;
+	bool mRequestPending;
+	LBotPlan mResult;
+	int mResultId;
+	bool mResultReady;
+
+	//Statistics
+	double mLastSearchMs;
+	double mMaxSearchMs;
+	double mTotalSearchMs;
+	int mSearchCount;
+
+	//Search thread and the lock shared with it
+	SDL_Thread* mThread;
+	SDL_mutex* mMutex;
+	SDL_cond* mCondition;
+	bool mQuit;
+};
+
+//Bot used for hints and for playing by itself
+extern LBotPlayer gBot;
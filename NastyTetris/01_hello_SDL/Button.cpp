@@ -0,0 +1,51 @@
+/* Headers */
+#include "Button.h"
+
+
+
+//Mouse button sprites
+SDL_Rect gSpriteClips[BUTTON_SPRITE_TOTAL];
+LTexture gButtonSpriteSheetTexture;
+
+LButton::LButton()
+{
+	mBounds.w = BUTTON_WIDTH;
+	mBounds.h = BUTTON_HEIGHT;
+
+	mCurrentSprite = BUTTON_SPRITE_MOUSE_OUT;
+}
+
+void LButton::setPosition(int x, int y)
+{
+	mBounds.x = x;
+	mBounds.y = y;
+	gUIRouter.invalidate();
+}
+
+void LButton::onLeave()
+{
+	//Mouse is outside button
+	mCurrentSprite = BUTTON_SPRITE_MOUSE_OUT;
+}
+
+void LButton::onMotion(int, int)
+{
+	//Set mouse over sprite
+	mCurrentSprite = BUTTON_SPRITE_MOUSE_OVER_MOTION;
+}
+
+void LButton::onPress(int, int, Uint8)
+{
+	mCurrentSprite = BUTTON_SPRITE_MOUSE_DOWN;
+}
+
+void LButton::onRelease(int, int, Uint8)
+{
+	mCurrentSprite = BUTTON_SPRITE_MOUSE_UP;
+}
+
+void LButton::render()
+{
+	//Show current button sprite
+	gButtonSpriteSheetTexture.render(mBounds.x, mBounds.y, &gSpriteClips[mCurrentSprite]);
+}
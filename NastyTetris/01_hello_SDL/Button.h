@@ -0,0 +1,52 @@
+#pragma once
+
+/* Headers */
+//Using SDL, textures and the UI router
+#include <SDL.h>
+#include "LTexture.h"
+#include "UIRouter.h"
+
+
+
+/* Constants */
+
+//Button constants
+const int BUTTON_WIDTH = 300;
+const int BUTTON_HEIGHT = 200;
+const int TOTAL_BUTTONS = 4;
+
+enum LButtonSprite
+{
+	BUTTON_SPRITE_MOUSE_OUT = 0,
+	BUTTON_SPRITE_MOUSE_OVER_MOTION = 1,
+	BUTTON_SPRITE_MOUSE_DOWN = 2,
+	BUTTON_SPRITE_MOUSE_UP = 3,
+	BUTTON_SPRITE_TOTAL = 4
+};
+
+//The mouse button, gets its events from the UI router
+class LButton : public LWidget
+{
+public:
+	//Initializes internal variables
+	LButton();
+	
+	//Sets top left position
+	void setPosition(int x, int y);
+
+	//Mouse events routed to the button
+	void onLeave();
+	void onMotion(int x, int y);
+	void onPress(int x, int y, Uint8 button);
+	void onRelease(int x, int y, Uint8 button);
+
+	//Shows button sprite
+	void render();
+private:
+	//Currently used global sprite
+	LButtonSprite mCurrentSprite;
+};
+
+//Mouse button sprites
+extern SDL_Rect gSpriteClips[BUTTON_SPRITE_TOTAL];
+extern LTexture gButtonSpriteSheetTexture;
@@ -0,0 +1,202 @@
+/* Headers */
+#include "FrameScheduler.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+
+//Pacing of the main loop
+LFrameScheduler gFrameScheduler;
+
+LFrameScheduler::LFrameScheduler()
+{
+	//Initialize, the clocks start with the first pollEvent()
+	mMode = FRAME_MODE_ACTIVE;
+	mWaiting = true;
+	mNextFrame = 0;
+	mDeadline = ~(Uint64)0;
+	mFramePeriod = 0;
+	mLastWake = 0;
+	mLastCpu = 0.0;
+	mStartTime = 0;
+	mStartCpu = 0.0;
+	mPeriodStart = 0;
+	mPeriodCpu = 0.0;
+	mPeriodWakeups = 0;
+	mWakeupRate = 0.0;
+	mCpuPercent = 0.0;
+	memset(mModeWakeups, 0, sizeof(mModeWakeups));
+	memset(mModeTime, 0, sizeof(mModeTime));
+	memset(mModeCpu, 0, sizeof(mModeCpu));
+}
+
+void LFrameScheduler::setMode(FrameMode mode)
+{
+	mMode = mode;
+}
+
+FrameMode LFrameScheduler::getMode() const
+{
+	return mMode;
+}
+
+void LFrameScheduler::requestDeadline(Uint64 time)
+{
+	if (time < mDeadline)
+	{
+		mDeadline = time;
+	}
+}
+
+bool LFrameScheduler::pollEvent(SDL_Event* e)
+{
+	if (mStartTime == 0)
+	{
+		mFramePeriod = SDL_GetPerformanceFrequency() / FRAME_ACTIVE_RATE;
+		mStartTime = SDL_GetPerformanceCounter();
+		mStartCpu = getProcessCpuSeconds();
+		mLastWake = mPeriodStart = mNextFrame = mStartTime;
+		mLastCpu = mPeriodCpu = mStartCpu;
+	}
+
+	//Past this frame's wait, hand out what is queued and wait again next frame
+	if (!mWaiting)
+	{
+		if (SDL_PollEvent(e))
+		{
+			return true;
+		}
+		mWaiting = true;
+		return false;
+	}
+
+	if (mMode == FRAME_MODE_ACTIVE)
+	{
+		//Spin on the queue until the frame is due, events are handed out the moment they arrive
+		while (SDL_GetPerformanceCounter() < mNextFrame)
+		{
+			if (SDL_PollEvent(e))
+			{
+				return true;
+			}
+		}
+		wake();
+		return pollEvent(e);
+	}
+
+	//Sleep in the queue until an event or the deadline, whichever comes first
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 deadline = now + frequency * FRAME_IDLE_MAX_WAIT_MS / 1000;
+	if (mDeadline < deadline)
+	{
+		deadline = mDeadline;
+	}
+	int timeout = deadline > now ? (int)(((deadline - now) * 1000 + frequency - 1) / frequency) : 0;
+	bool received = SDL_WaitEventTimeout(e, timeout) != 0;
+	wake();
+	if (!received)
+	{
+		mWaiting = true;
+	}
+	return received;
+}
+
+double LFrameScheduler::getWakeupRate() const
+{
+	return mWakeupRate;
+}
+
+double LFrameScheduler::getCpuPercent() const
+{
+	return mCpuPercent;
+}
+
+double LFrameScheduler::getCpuSeconds() const
+{
+	return getProcessCpuSeconds() - mStartCpu;
+}
+
+void LFrameScheduler::printReport() const
+{
+	if (mStartTime == 0)
+	{
+		return;
+	}
+
+	static const char* const modeNames[FRAME_MODE_TOTAL] = { "active", "idle" };
+	double frequency = (double)SDL_GetPerformanceFrequency();
+	printf("Frame scheduler, %.1f s CPU over %.1f s\n", getCpuSeconds(), (SDL_GetPerformanceCounter() - mStartTime) / frequency);
+	printf("%-7s %9s %9s %11s %7s\n", "mode", "time s", "wakeups", "wakeups/s", "cpu %");
+	for (int i = 0; i < FRAME_MODE_TOTAL; ++i)
+	{
+		double seconds = mModeTime[i] / frequency;
+		printf("%-7s %9.1f %9d %11.1f %7.1f\n", modeNames[i], seconds, mModeWakeups[i],
+			seconds > 0.0 ? mModeWakeups[i] / seconds : 0.0, seconds > 0.0 ? mModeCpu[i] * 100.0 / seconds : 0.0);
+	}
+}
+
+void LFrameScheduler::wake()
+{
+	mWaiting = false;
+	Uint64 now = SDL_GetPerformanceCounter();
+	double cpu = getProcessCpuSeconds();
+
+	//The frame before the wait and the wait itself belong to the mode the wait was done in
+	++mModeWakeups[mMode];
+	mModeTime[mMode] += now - mLastWake;
+	mModeCpu[mMode] += cpu - mLastCpu;
+	mLastWake = now;
+	mLastCpu = cpu;
+
+	//Next active frame is due a period from now, deadlines have to be asked for again
+	mNextFrame = now + mFramePeriod;
+	mDeadline = ~(Uint64)0;
+
+	//Rates over the last whole period
+	++mPeriodWakeups;
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	if (now - mPeriodStart >= frequency * FRAME_STATS_PERIOD_MS / 1000)
+	{
+		double seconds = (double)(now - mPeriodStart) / (double)frequency;
+		mWakeupRate = mPeriodWakeups / seconds;
+		mCpuPercent = (cpu - mPeriodCpu) * 100.0 / seconds;
+		mPeriodStart = now;
+		mPeriodCpu = cpu;
+		mPeriodWakeups = 0;
+	}
+}
+
+double LFrameScheduler::getProcessCpuSeconds()
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+	{
+		return 0.0;
+	}
+
+	//100 ns units
+	ULARGE_INTEGER kernelTime, userTime;
+	kernelTime.LowPart = kernel.dwLowDateTime;
+	kernelTime.HighPart = kernel.dwHighDateTime;
+	userTime.LowPart = user.dwLowDateTime;
+	userTime.HighPart = user.dwHighDateTime;
+	return (kernelTime.QuadPart + userTime.QuadPart) / 1e7;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0.0;
+	}
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/* Headers */
+//Using SDL events and timers
+#include <SDL.h>
+
+
+
+/* Constants */
+
+//Frame rate active mode paces to when frames come faster than the display, vsync usually paces first
+const int FRAME_ACTIVE_RATE = 240;
+
+//Longest idle sleep without an event or a deadline, so anything changed off the main thread still shows up eventually
+const int FRAME_IDLE_MAX_WAIT_MS = 1000;
+
+//Window the wakeup and CPU rates are measured over
+const int FRAME_STATS_PERIOD_MS = 1000;
+
+//How the main loop waits between frames
+enum FrameMode
+{
+	FRAME_MODE_ACTIVE,
+	FRAME_MODE_IDLE,
+	FRAME_MODE_TOTAL
+};
+
+//Decides how long the main loop sleeps between frames
+//Active mode keeps polling events at a fixed frame rate, for gameplay where every frame moves
+//Idle mode sleeps in the event queue until an event or the nearest animation deadline, for screens that only change on input
+//Every wakeup and the process CPU time are counted per mode, so idle power draw can be checked
+class LFrameScheduler
+{
+public:
+	//Initializes variables
+	LFrameScheduler();
+
+	//Sets how the next wait is done
+	void setMode(FrameMode mode);
+	FrameMode getMode() const;
+
+	//Asks idle mode to wake up by a performance counter time, the earliest request wins and requests last for one wait
+	void requestDeadline(Uint64 time);
+
+	//Gets the next event, the first call of a frame waits as the mode says and later ones only drain the queue
+	//Returns false once the queue is empty, the frame should be built then
+	bool pollEvent(SDL_Event* e);
+
+	//Gets wakeups per second and the share of one core used by the whole process over the last period
+	double getWakeupRate() const;
+	double getCpuPercent() const;
+
+	//Gets process CPU time since the scheduler started, in seconds
+	double getCpuSeconds() const;
+
+	//Prints time, wakeups and CPU use per mode
+	void printReport() const;
+
+private:
+	//Ends a wait, counts it against the mode it was done in
+	void wake();
+
+	//Gets CPU time of every thread of the process in seconds
+	static double getProcessCpuSeconds();
+
+	//Current mode and whether the next pollEvent() waits
+	FrameMode mMode;
+	bool mWaiting;
+
+	//Earliest time the next active frame starts and the idle deadline, performance counter values
+	Uint64 mNextFrame;
+	Uint64 mDeadline;
+
+	//Performance counter ticks per active frame
+	Uint64 mFramePeriod;
+
+	//Last wakeup, as a performance counter value and in process CPU seconds
+	Uint64 mLastWake;
+	double mLastCpu;
+
+	//Start of the scheduler and of the current measuring period
+	Uint64 mStartTime;
+	double mStartCpu;
+	Uint64 mPeriodStart;
+	double mPeriodCpu;
+	int mPeriodWakeups;
+
+	//Rates of the last finished period
+	double mWakeupRate;
+	double mCpuPercent;
+
+	//Totals per mode
+	int mModeWakeups[FRAME_MODE_TOTAL];
+	Uint64 mModeTime[FRAME_MODE_TOTAL];
+	double mModeCpu[FRAME_MODE_TOTAL];
+};
+
+//Pacing of the main loop
+extern LFrameScheduler gFrameScheduler;
@@ -0,0 +1,438 @@
+/* Headers */
+#include "Game.h"
+#include <string.h>
+
+
+
+/* Constants */
+
+//Highest level with its own gravity
+const int MAX_LEVEL = 15;
+
+//Guideline gravity as milliseconds per row, kept as integers so every platform steps identically
+const int gGravityMs[MAX_LEVEL + 1] = { 1000, 1000, 793, 618, 473, 355, 262, 190, 135, 94, 64, 43, 28, 18, 11, 7 };
+
+//Score for 0 to 4 cleared lines, without and with a T-spin
+const int gLineScores[5] = { 0, 100, 300, 500, 800 };
+const int gTSpinScores[4] = { 400, 800, 1200, 1600 };
+const int gTSpinMiniScores[3] = { 100, 200, 400 };
+
+//Garbage sent for 0 to 4 cleared lines, without and with a T-spin
+const int gLineAttack[5] = { 0, 0, 1, 2, 4 };
+const int gTSpinAttack[4] = { 0, 2, 4, 6 };
+
+//Extra garbage for consecutive clears
+const int MAX_COMBO_ATTACK = 12;
+const int gComboAttack[MAX_COMBO_ATTACK] = { 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4, 5 };
+
+LGame::LGame()
+{
+	//Initialize
+	mBoardVersion = 0;
+	reset(0);
+}
+
+void LGame::reset(uint32_t seed)
+{
+	mBoard.clear();
+	memset(mCells, PIECE_NONE, sizeof(mCells));
+	++mBoardVersion;
+	memset(&mLastLock, 0, sizeof(mLastLock));
+
+	//xorshift must never be seeded with 0
+	mRandom = seed * 2654435761u + 0x9E3779B9u;
+	if (mRandom == 0)
+	{
+		mRandom = 1;
+	}
+
+	mBagIndex = PIECE_TOTAL;
+	for (int i = 0; i < NEXT_QUEUE_SIZE; ++i)
+	{
+		mQueue[i] = nextFromBag();
+	}
+
+	mHold = PIECE_NONE;
+	mHoldUsed = false;
+	mOver = false;
+
+	mStats.score = 0;
+	mStats.lines = 0;
+	mStats.level = 1;
+	mStats.pieces = 0;
+	mStats.tSpins = 0;
+	mStats.combo = -1;
+	mStats.maxCombo = 0;
+	mStats.garbageSent = 0;
+	mStats.backToBack = false;
+	mStats.ticks = 0;
+
+	spawnNext();
+}
+
+uint32_t LGame::nextRandom()
+{
+	//xorshift32
+	uint32_t x = mRandom;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	mRandom = x;
+	return x;
+}
+
+PieceType LGame::nextFromBag()
+{
+	//Refill and shuffle the bag when it runs out
+	if (mBagIndex >= PIECE_TOTAL)
+	{
+		for (int i = 0; i < PIECE_TOTAL; ++i)
+		{
+			mBag[i] = (PieceType)i;
+		}
+		for (int i = PIECE_TOTAL - 1; i > 0; --i)
+		{
+			int j = (int)(nextRandom() % (uint32_t)(i + 1));
+			PieceType swap = mBag[i];
+			mBag[i] = mBag[j];
+			mBag[j] = swap;
+		}
+		mBagIndex = 0;
+	}
+
+	return mBag[mBagIndex++];
+}
+
+void LGame::spawn(PieceType type)
+{
+	mPiece.type = type;
+	mPiece.rotation = ROTATION_SPAWN;
+	mPiece.x = PIECE_SPAWN_X;
+	mPiece.y = PIECE_SPAWN_Y;
+
+	mGravity = 0;
+	mLockTimer = 0;
+	mLockResets = 0;
+	mLastMoveRotation = false;
+	mLastKick = 0;
+
+	//Block out
+	if (mBoard.collides(mPiece))
+	{
+		mOver = true;
+	}
+}
+
+void LGame::spawnNext()
+{
+	PieceType type = mQueue[0];
+	for (int i = 0; i < NEXT_QUEUE_SIZE - 1; ++i)
+	{
+		mQueue[i] = mQueue[i + 1];
+	}
+	mQueue[NEXT_QUEUE_SIZE - 1] = nextFromBag();
+
+	spawn(type);
+}
+
+int LGame::gravityPerTick() const
+{
+	int level = mStats.level < MAX_LEVEL ? mStats.level : MAX_LEVEL;
+	return (int)((int64_t)GRAVITY_ONE * 1000 / ((int64_t)gGravityMs[level] * LOGIC_TICK_RATE));
+}
+
+void LGame::onPieceMoved(bool rotated)
+{
+	mLastMoveRotation = rotated;
+
+	//Moving on the ground buys more time, up to a limit
+	if (mBoard.collides(mPiece.type, mPiece.rotation, mPiece.x, mPiece.y + 1) && mLockResets < MAX_LOCK_RESETS)
+	{
+		mLockTimer = 0;
+		++mLockResets;
+	}
+}
+
+void LGame::lockPiece()
+{
+	TSpinType tSpin = mLastMoveRotation ? mBoard.checkTSpin(mPiece, mLastKick) : TSPIN_NONE;
+
+	//Lock out when the piece never reached the visible rows
+	int hiddenRows = BOARD_HIDDEN_HEIGHT - mPiece.y;
+	bool lockOut = hiddenRows >= 4 || (hiddenRows > 0 && (gPieceMasks[mPiece.type][mPiece.rotation] >> (16 * hiddenRows)) == 0);
+
+	//Paint the piece into the color grid
+	uint64_t mask = gPieceMasks[mPiece.type][mPiece.rotation];
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			if ((mask >> (16 * row + column)) & 1)
+			{
+				mCells[mPiece.y + row][mPiece.x + column] = (uint8_t)mPiece.type;
+			}
+		}
+	}
+
+	uint32_t cleared = 0;
+	int lines = mBoard.lock(mPiece, &cleared);
+	++mStats.pieces;
+	++mBoardVersion;
+
+	//Remember the cleared rows before they are compacted away
+	mLastLock.piece = mPiece;
+	mLastLock.clearedRows = cleared;
+	int clearedIndex = 0;
+	for (int row = 0; row < BOARD_HEIGHT && clearedIndex < 4; ++row)
+	{
+		if ((cleared >> row) & 1)
+		{
+			memcpy(mLastLock.clearedCells[clearedIndex++], mCells[row], BOARD_WIDTH);
+		}
+	}
+
+	//Compact the color grid the same way the board did
+	if (cleared != 0)
+	{
+		int write = BOARD_HEIGHT - 1;
+		for (int read = BOARD_HEIGHT - 1; read >= 0; --read)
+		{
+			if (!((cleared >> read) & 1))
+			{
+				if (write != read)
+				{
+					memcpy(mCells[write], mCells[read], BOARD_WIDTH);
+				}
+				--write;
+			}
+		}
+		while (write >= 0)
+		{
+			memset(mCells[write--], PIECE_NONE, BOARD_WIDTH);
+		}
+	}
+
+	//Score and attack
+	int score = 0;
+	int attack = 0;
+	bool difficult = lines == 4 || (tSpin != TSPIN_NONE && lines > 0);
+	if (tSpin == TSPIN_FULL)
+	{
+		score = gTSpinScores[lines < 3 ? lines : 3];
+		attack = gTSpinAttack[lines < 3 ? lines : 3];
+		++mStats.tSpins;
+	}
+	else if (tSpin == TSPIN_MINI)
+	{
+		score = gTSpinMiniScores[lines < 2 ? lines : 2];
+		attack = lines > 0 ? 1 : 0;
+		++mStats.tSpins;
+	}
+	else
+	{
+		score = gLineScores[lines];
+		attack = gLineAttack[lines];
+	}
+
+	if (lines > 0)
+	{
+		//Back to back difficult clears
+		if (difficult && mStats.backToBack)
+		{
+			score += score / 2;
+			++attack;
+		}
+		mStats.backToBack = difficult;
+
+		//Combo
+		++mStats.combo;
+		if (mStats.combo > mStats.maxCombo)
+		{
+			mStats.maxCombo = mStats.combo;
+		}
+		score += 50 * mStats.combo;
+		attack += gComboAttack[mStats.combo < MAX_COMBO_ATTACK ? mStats.combo : MAX_COMBO_ATTACK - 1];
+	}
+	else
+	{
+		mStats.combo = -1;
+	}
+
+	mStats.score += score * mStats.level;
+	mStats.garbageSent += attack;
+
+	//Level up
+	mStats.lines += lines;
+	mStats.level = 1 + mStats.lines / LINES_PER_LEVEL;
+
+	mHoldUsed = false;
+	if (lockOut)
+	{
+		mOver = true;
+	}
+	else
+	{
+		spawnNext();
+	}
+}
+
+//FNV-1a over one value
+static uint64_t hashValue(uint64_t hash, uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		hash ^= (value >> (8 * i)) & 0xFF;
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
+
+uint64_t LGame::getStateHash() const
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (int y = 0; y < BOARD_HEIGHT; ++y)
+	{
+		hash = hashValue(hash, mBoard.getRow(y));
+		for (int x = 0; x < BOARD_WIDTH; ++x)
+		{
+			hash = hashValue(hash, mCells[y][x]);
+		}
+	}
+
+	hash = hashValue(hash, mPiece.type);
+	hash = hashValue(hash, mPiece.rotation);
+	hash = hashValue(hash, (uint32_t)mPiece.x);
+	hash = hashValue(hash, (uint32_t)mPiece.y);
+	hash = hashValue(hash, mHold);
+	hash = hashValue(hash, mHoldUsed);
+	for (int i = 0; i < NEXT_QUEUE_SIZE; ++i)
+	{
+		hash = hashValue(hash, mQueue[i]);
+	}
+	for (int i = 0; i < PIECE_TOTAL; ++i)
+	{
+		hash = hashValue(hash, mBag[i]);
+	}
+	hash = hashValue(hash, mBagIndex);
+	hash = hashValue(hash, mRandom);
+	hash = hashValue(hash, (uint32_t)mGravity);
+	hash = hashValue(hash, (uint32_t)mLockTimer);
+	hash = hashValue(hash, (uint32_t)mLockResets);
+	hash = hashValue(hash, mLastMoveRotation);
+	hash = hashValue(hash, (uint32_t)mLastKick);
+	hash = hashValue(hash, mOver);
+
+	hash = hashValue(hash, (uint32_t)mStats.score);
+	hash = hashValue(hash, (uint32_t)mStats.lines);
+	hash = hashValue(hash, (uint32_t)mStats.level);
+	hash = hashValue(hash, (uint32_t)mStats.pieces);
+	hash = hashValue(hash, (uint32_t)mStats.tSpins);
+	hash = hashValue(hash, (uint32_t)mStats.combo);
+	hash = hashValue(hash, (uint32_t)mStats.maxCombo);
+	hash = hashValue(hash, (uint32_t)mStats.garbageSent);
+	hash = hashValue(hash, mStats.backToBack);
+	hash = hashValue(hash, mStats.ticks);
+	return hash;
+}
+
+void LGame::step(uint32_t actions)
+{
+	if (mOver)
+	{
+		return;
+	}
+	++mStats.ticks;
+
+	//Hold swaps the active piece once per drop
+	if ((actions & ACTION_HOLD) && !mHoldUsed)
+	{
+		PieceType held = mHold;
+		mHold = mPiece.type;
+		if (held == PIECE_NONE)
+		{
+			spawnNext();
+		}
+		else
+		{
+			spawn(held);
+		}
+		mHoldUsed = true;
+		if (mOver)
+		{
+			return;
+		}
+	}
+
+	//Rotation
+	int kick = 0;
+	if ((actions & ACTION_ROTATE_CW) && mBoard.tryRotate(mPiece, 1, &kick))
+	{
+		mLastKick = kick;
+		onPieceMoved(true);
+	}
+	if ((actions & ACTION_ROTATE_CCW) && mBoard.tryRotate(mPiece, -1, &kick))
+	{
+		mLastKick = kick;
+		onPieceMoved(true);
+	}
+
+	//Shifting
+	if ((actions & ACTION_LEFT) && mBoard.tryMove(mPiece, -1, 0))
+	{
+		onPieceMoved(false);
+	}
+	if ((actions & ACTION_RIGHT) && mBoard.tryMove(mPiece, 1, 0))
+	{
+		onPieceMoved(false);
+	}
+
+	//Hard drop locks right away
+	if (actions & ACTION_HARD_DROP)
+	{
+		int distance = mBoard.dropDistance(mPiece);
+		mPiece.y += distance;
+		mStats.score += 2 * distance;
+		if (distance > 0)
+		{
+			mLastMoveRotation = false;
+		}
+		lockPiece();
+		return;
+	}
+
+	//Gravity, sped up while soft dropping
+	int gravity = gravityPerTick();
+	if (actions & ACTION_SOFT_DROP)
+	{
+		gravity *= SOFT_DROP_FACTOR;
+	}
+	mGravity += gravity;
+	while (mGravity >= GRAVITY_ONE)
+	{
+		mGravity -= GRAVITY_ONE;
+		if (!mBoard.tryMove(mPiece, 0, 1))
+		{
+			mGravity = 0;
+			break;
+		}
+
+		mLastMoveRotation = false;
+		if (actions & ACTION_SOFT_DROP)
+		{
+			mStats.score += 1;
+		}
+	}
+
+	//Lock delay
+	if (mBoard.collides(mPiece.type, mPiece.rotation, mPiece.x, mPiece.y + 1))
+	{
+		if (++mLockTimer >= LOCK_DELAY_MS * LOGIC_TICK_RATE / 1000)
+		{
+			lockPiece();
+		}
+	}
+	else
+	{
+		mLockTimer = 0;
+	}
+}
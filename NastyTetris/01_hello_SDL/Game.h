@@ -0,0 +1,234 @@
+#pragma once
+
+/* Headers */
+//Using the bitboard playfield
+#include "Board.h"
+
+
+
+/* Constants */
+
+//Logic ticks per second, every timer below is converted to ticks with it
+const int LOGIC_TICK_RATE = 240;
+
+//Number of upcoming pieces shown
+const int NEXT_QUEUE_SIZE = 5;
+
+//Time a grounded piece waits before locking
+const int LOCK_DELAY_MS = 500;
+
+//Moves that can restart the lock delay before the piece is forced down
+const int MAX_LOCK_RESETS = 15;
+
+//Lines needed to advance one level
+const int LINES_PER_LEVEL = 10;
+
+//Fixed point unit for gravity, in rows
+const int GRAVITY_ONE = 1 << 16;
+
+//Soft drop multiplies gravity by this
+const int SOFT_DROP_FACTOR = 20;
+
+//Player actions, several can be combined in one tick
+enum GameAction
+{
+	ACTION_NONE = 0,
+	ACTION_LEFT = 1 << 0,
+	ACTION_RIGHT = 1 << 1,
+	ACTION_SOFT_DROP = 1 << 2,
+	ACTION_HARD_DROP = 1 << 3,
+	ACTION_ROTATE_CW = 1 << 4,
+	ACTION_ROTATE_CCW = 1 << 5,
+	ACTION_HOLD = 1 << 6
+};
+
+//Running totals for one game
+struct LGameStats
+{
+	int score;
+	int lines;
+	int level;
+	int pieces;
+	int tSpins;
+	int combo;
+	int maxCombo;
+	int garbageSent;
+	bool backToBack;
+	uint64_t ticks;
+};
+
+//What the last lock did, for effects, not part of the game state
+struct LLockInfo
+{
+	//Piece as it locked
+	LPiece piece;
+
+	//Bitmask of the rows that were removed
+	uint32_t clearedRows;
+
+	//Piece type of every cell of the removed rows before they went, top row first
+	uint8_t clearedCells[4][BOARD_WIDTH];
+};
+
+//Tetris rules on top of the playfield, one call to step() per logic tick
+class LGame
+{
+public:
+	//Initializes a game with seed 0
+	LGame();
+
+	//Starts a new game, the seed fully determines the piece sequence
+	void reset(uint32_t seed);
+
+	//Advances the game by one logic tick
+	void step(uint32_t actions);
+
+	//Checks whether the stack topped out
+	bool isOver() const;
+
+	//Gets game state
+	const LBoard& getBoard() const;
+	const LPiece& getPiece() const;
+	PieceType getHold() const;
+	bool isHoldUsed() const;
+	PieceType getNext(int index) const;
+	const LGameStats& getStats() const;
+
+	//Gets the piece a locked cell came from, PIECE_NONE when empty
+	PieceType getCell(int x, int y) const;
+
+	//Row the active piece would land on
+	int getGhostY() const;
+
+	//Changes whenever locked cells change, lets renderers cache the board
+	uint32_t getBoardVersion() const;
+
+	//Gets what the last lock did, valid once stats show a piece was placed
+	const LLockInfo& getLastLock() const;
+
+	//Hash of everything that decides how the game continues, equal hashes mean identical games
+	uint64_t getStateHash() const;
+
+private:
+	//Draws the next piece from the 7-bag randomizer
+	PieceType nextFromBag();
+
+	//Advances the seeded generator
+	uint32_t nextRandom();
+
+	//Puts a new piece at the top of the well
+	void spawn(PieceType type);
+
+	//Takes the next piece off the queue
+	void spawnNext();
+
+	//Locks the active piece and scores any cleared lines
+	void lockPiece();
+
+	//Restarts the lock delay after a successful move on the ground
+	void onPieceMoved(bool rotated);
+
+	//Gravity per tick for the current level, in GRAVITY_ONE units
+	int gravityPerTick() const;
+
+	//The playfield
+	LBoard mBoard;
+
+	//Piece type of every locked cell, only kept for drawing
+	uint8_t mCells[BOARD_HEIGHT][BOARD_WIDTH];
+
+	//Falling piece
+	LPiece mPiece;
+
+	//Held piece and whether hold was used for the current piece
+	PieceType mHold;
+	bool mHoldUsed;
+
+	//Upcoming pieces
+	PieceType mQueue[NEXT_QUEUE_SIZE];
+
+	//7-bag state
+	PieceType mBag[PIECE_TOTAL];
+	int mBagIndex;
+
+	//Randomizer state
+	uint32_t mRandom;
+
+	//Fractional rows of gravity accumulated
+	int mGravity;
+
+	//Ticks the piece has spent on the ground
+	int mLockTimer;
+	int mLockResets;
+
+	//Last successful move was a rotation, and which kick it used
+	bool mLastMoveRotation;
+	int mLastKick;
+
+	//Game over flag
+	bool mOver;
+
+	//Bumped by every lock and reset
+	uint32_t mBoardVersion;
+
+	//Last lock, for effects
+	LLockInfo mLastLock;
+
+	//Totals
+	LGameStats mStats;
+};
+
+inline bool LGame::isOver() const
+{
+	return mOver;
+}
+
+inline const LBoard& LGame::getBoard() const
+{
+	return mBoard;
+}
+
+inline const LPiece& LGame::getPiece() const
+{
+	return mPiece;
+}
+
+inline PieceType LGame::getHold() const
+{
+	return mHold;
+}
+
+inline bool LGame::isHoldUsed() const
+{
+	return mHoldUsed;
+}
+
+inline PieceType LGame::getNext(int index) const
+{
+	return mQueue[index];
+}
+
+inline const LGameStats& LGame::getStats() const
+{
+	return mStats;
+}
+
+inline PieceType LGame::getCell(int x, int y) const
+{
+	return (PieceType)mCells[y][x];
+}
+
+inline int LGame::getGhostY() const
+{
+	return mBoard.ghostY(mPiece);
+}
+
+inline uint32_t LGame::getBoardVersion() const
+{
+	return mBoardVersion;
+}
+
+inline const LLockInfo& LGame::getLastLock() const
+{
+	return mLastLock;
+}
@@ -0,0 +1,262 @@
+/* Headers */
+#include "GlyphCache.h"
+#include "LTexture.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+//Glyphs of the menu font
+LGlyphCache gGlyphCache;
+
+LGlyphCache::LGlyphCache()
+{
+	//Initialize
+	mTexture = NULL;
+	mLineHeight = 0;
+	memset(mGlyphs, 0, sizeof(mGlyphs));
+	memset(mKerning, 0, sizeof(mKerning));
+}
+
+LGlyphCache::~LGlyphCache()
+{
+	//Deallocate
+	free();
+}
+
+void LGlyphCache::free()
+{
+	if (mTexture != NULL)
+	{
+		SDL_DestroyTexture(mTexture);
+		mTexture = NULL;
+	}
+}
+
+int LGlyphCache::glyphIndex(char c)
+{
+	int code = (unsigned char)c;
+	if (code < GLYPH_FIRST || code > GLYPH_LAST)
+	{
+		return -1;
+	}
+	return code - GLYPH_FIRST;
+}
+
+bool LGlyphCache::load(TTF_Font* font)
+{
+	return upload(rasterize(font));
+}
+
+SDL_Surface* LGlyphCache::rasterize(TTF_Font* font)
+{
+	//Rasterize every glyph white
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	SDL_Surface* glyphSurfaces[GLYPH_TOTAL];
+	int penX = 0;
+	int penY = 0;
+	int rowHeight = 0;
+	for (int i = 0; i < GLYPH_TOTAL; ++i)
+	{
+		Uint16 code = (Uint16)(GLYPH_FIRST + i);
+		glyphSurfaces[i] = NULL;
+
+		int advance = 0;
+		if (TTF_GlyphMetrics(font, code, NULL, NULL, NULL, NULL, &advance) == 0)
+		{
+			mGlyphs[i].advance = advance;
+		}
+
+		//Spaces have nothing to draw
+		SDL_Surface* rendered = code == ' ' ? NULL : TTF_RenderGlyph_Blended(font, code, white);
+		if (rendered != NULL)
+		{
+			glyphSurfaces[i] = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_RGBA32, 0);
+			SDL_FreeSurface(rendered);
+		}
+		if (glyphSurfaces[i] == NULL)
+		{
+			continue;
+		}
+
+		//Shelf pack with a pixel of padding
+		if (penX + glyphSurfaces[i]->w + 1 > GLYPH_ATLAS_WIDTH)
+		{
+			penX = 0;
+			penY += rowHeight + 1;
+			rowHeight = 0;
+		}
+		mGlyphs[i].rect.x = penX;
+		mGlyphs[i].rect.y = penY;
+		mGlyphs[i].rect.w = glyphSurfaces[i]->w;
+		mGlyphs[i].rect.h = glyphSurfaces[i]->h;
+		penX += glyphSurfaces[i]->w + 1;
+		if (glyphSurfaces[i]->h > rowHeight)
+		{
+			rowHeight = glyphSurfaces[i]->h;
+		}
+	}
+
+	//Copy the glyphs into one surface
+	SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_ATLAS_WIDTH, penY + rowHeight + 1, 32, SDL_PIXELFORMAT_RGBA32);
+	if (atlas == NULL)
+	{
+		printf("Unable to create glyph atlas! SDL Error: %s\n", SDL_GetError());
+	}
+	else
+	{
+		SDL_FillRect(atlas, NULL, 0);
+		for (int i = 0; i < GLYPH_TOTAL; ++i)
+		{
+			if (glyphSurfaces[i] != NULL)
+			{
+				SDL_Rect destination = mGlyphs[i].rect;
+				SDL_SetSurfaceBlendMode(glyphSurfaces[i], SDL_BLENDMODE_NONE);
+				SDL_BlitSurface(glyphSurfaces[i], NULL, atlas, &destination);
+			}
+		}
+	}
+
+	for (int i = 0; i < GLYPH_TOTAL; ++i)
+	{
+		SDL_FreeSurface(glyphSurfaces[i]);
+	}
+
+	//Kerning pairs
+	for (int a = 0; a < GLYPH_TOTAL; ++a)
+	{
+		for (int b = 0; b < GLYPH_TOTAL; ++b)
+		{
+			mKerning[a][b] = (Sint8)TTF_GetFontKerningSizeGlyphs(font, (Uint16)(GLYPH_FIRST + a), (Uint16)(GLYPH_FIRST + b));
+		}
+	}
+
+	mLineHeight = TTF_FontLineSkip(font);
+	return atlas;
+}
+
+bool LGlyphCache::upload(SDL_Surface* atlas)
+{
+	//Get rid of preexisting texture
+	free();
+
+	if (atlas == NULL)
+	{
+		return false;
+	}
+
+	//Upload the glyphs once
+	bool success = true;
+	mTexture = SDL_CreateTextureFromSurface(gRenderer, atlas);
+	if (mTexture == NULL)
+	{
+		printf("Unable to create glyph texture! SDL Error: %s\n", SDL_GetError());
+		success = false;
+	}
+	else
+	{
+		SDL_SetTextureBlendMode(mTexture, SDL_BLENDMODE_BLEND);
+	}
+	SDL_FreeSurface(atlas);
+
+	return success;
+}
+
+bool LGlyphCache::isLoaded() const
+{
+	return mTexture != NULL;
+}
+
+void LGlyphCache::render(int x, int y, const char* text, SDL_Color color)
+{
+	if (mTexture == NULL)
+	{
+		return;
+	}
+
+	int penX = x;
+	int penY = y;
+	int previous = -1;
+	for (const char* c = text; *c != '\0'; ++c)
+	{
+		//Line break
+		if (*c == '\n')
+		{
+			penX = x;
+			penY += mLineHeight;
+			previous = -1;
+			continue;
+		}
+
+		int index = glyphIndex(*c);
+		if (index < 0)
+		{
+			continue;
+		}
+		if (previous >= 0)
+		{
+			penX += mKerning[previous][index];
+		}
+
+		const LGlyph& glyph = mGlyphs[index];
+		if (glyph.rect.w > 0)
+		{
+			SDL_FRect destination = { (float)penX, (float)penY, (float)glyph.rect.w, (float)glyph.rect.h };
+			gSpriteBatch.draw(mTexture, &glyph.rect, destination, color, SDL_BLENDMODE_BLEND);
+		}
+
+		penX += glyph.advance;
+		previous = index;
+	}
+}
+
+int LGlyphCache::measure(const char* text) const
+{
+	//Metrics are still being written until the texture exists
+	if (mTexture == NULL)
+	{
+		return 0;
+	}
+
+	int width = 0;
+	int lineWidth = 0;
+	int previous = -1;
+	for (const char* c = text; *c != '\0'; ++c)
+	{
+		if (*c == '\n')
+		{
+			lineWidth = 0;
+			previous = -1;
+			continue;
+		}
+
+		int index = glyphIndex(*c);
+		if (index < 0)
+		{
+			continue;
+		}
+		if (previous >= 0)
+		{
+			lineWidth += mKerning[previous][index];
+		}
+		lineWidth += mGlyphs[index].advance;
+		previous = index;
+
+		if (lineWidth > width)
+		{
+			width = lineWidth;
+		}
+	}
+	return width;
+}
+
+int LGlyphCache::getLineHeight() const
+{
+	//Written by the loader along with the other metrics
+	if (mTexture == NULL)
+	{
+		return 0;
+	}
+
+	return mLineHeight;
+}
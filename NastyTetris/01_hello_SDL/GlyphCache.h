@@ -0,0 +1,81 @@
+#pragma once
+
+/* Headers */
+//Using SDL, SDL_ttf and the sprite batch
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include "SpriteBatch.h"
+
+
+
+/* Constants */
+
+//Cached character range, printable ASCII
+const int GLYPH_FIRST = 32;
+const int GLYPH_LAST = 126;
+const int GLYPH_TOTAL = GLYPH_LAST - GLYPH_FIRST + 1;
+
+//Width of the glyph texture, rows are added as needed
+const int GLYPH_ATLAS_WIDTH = 512;
+
+//Renders text from glyphs rasterized once, so changing strings never touch the GPU
+class LGlyphCache
+{
+public:
+	//Initializes variables
+	LGlyphCache();
+
+	//Deallocates memory
+	~LGlyphCache();
+
+	//Rasterizes every cached glyph of the font at its current size into one texture
+	bool load(TTF_Font* font);
+
+	//First half of load(), lays the glyphs out in a surface without touching the renderer
+	//Safe on a worker thread as long as nothing else uses the font meanwhile
+	SDL_Surface* rasterize(TTF_Font* font);
+
+	//Second half of load(), turns the rasterized glyphs into the texture and frees the surface
+	bool upload(SDL_Surface* atlas);
+
+	//Checks whether text can be drawn yet
+	bool isLoaded() const;
+
+	//Deallocates texture
+	void free();
+
+	//Queues text into the frame batch with its top left corner at the given point
+	void render(int x, int y, const char* text, SDL_Color color);
+
+	//Gets width of the widest line of text in pixels
+	int measure(const char* text) const;
+
+	//Gets distance between lines, 0 until uploaded
+	int getLineHeight() const;
+
+private:
+	//Where a glyph is in the texture and how far it moves the pen
+	struct LGlyph
+	{
+		SDL_Rect rect;
+		int advance;
+	};
+
+	//Maps a character to its glyph slot, -1 if not cached
+	static int glyphIndex(char c);
+
+	//Glyph texture, white so vertex colors tint it
+	SDL_Texture* mTexture;
+
+	//Glyph metrics
+	LGlyph mGlyphs[GLYPH_TOTAL];
+
+	//Kerning adjustment for every pair of cached glyphs
+	Sint8 mKerning[GLYPH_TOTAL][GLYPH_TOTAL];
+
+	//Line spacing of the font
+	int mLineHeight;
+};
+
+//Glyphs of the menu font
+extern LGlyphCache gGlyphCache;
@@ -0,0 +1,444 @@
+/* Headers */
+#include "Input.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+
+
+//Names used in the config file and the latency report
+const char* const gInputActionNames[INPUT_ACTION_TOTAL] =
+{
+	"left",
+	"right",
+	"soft_drop",
+	"hard_drop",
+	"rotate_cw",
+	"rotate_ccw",
+	"hold"
+};
+
+//Game action each input action turns into
+static const Uint32 gInputGameActions[INPUT_ACTION_TOTAL] =
+{
+	ACTION_LEFT,
+	ACTION_RIGHT,
+	ACTION_SOFT_DROP,
+	ACTION_HARD_DROP,
+	ACTION_ROTATE_CW,
+	ACTION_ROTATE_CCW,
+	ACTION_HOLD
+};
+
+//Input of the local player
+LInput gInput;
+
+//Converts milliseconds to logic ticks, rounded, at least one
+static int msToTicks(int ms)
+{
+	int ticks = (ms * LOGIC_TICK_RATE + 500) / 1000;
+	return ticks > 0 ? ticks : 1;
+}
+
+LInput::LInput()
+{
+	//Initialize
+	memset(mLatency, 0, sizeof(mLatency));
+	memset(mLatencyCount, 0, sizeof(mLatencyCount));
+	memset(mLatencyMax, 0, sizeof(mLatencyMax));
+	setDefaults();
+	reset();
+}
+
+void LInput::setDefaults()
+{
+	memset(mKeys, 0, sizeof(mKeys));
+	bind(INPUT_LEFT, SDLK_LEFT);
+	bind(INPUT_RIGHT, SDLK_RIGHT);
+	bind(INPUT_SOFT_DROP, SDLK_DOWN);
+	bind(INPUT_HARD_DROP, SDLK_SPACE);
+	bind(INPUT_ROTATE_CW, SDLK_UP);
+	bind(INPUT_ROTATE_CW, SDLK_x);
+	bind(INPUT_ROTATE_CCW, SDLK_z);
+	bind(INPUT_HOLD, SDLK_c);
+	bind(INPUT_HOLD, SDLK_LSHIFT);
+	setRepeat(INPUT_DEFAULT_DAS_MS, INPUT_DEFAULT_ARR_MS);
+}
+
+bool LInput::loadConfig(const char* path)
+{
+	//No config is fine, the defaults stay
+	SDL_RWops* file = SDL_RWFromFile(path, "rb");
+	if (file == NULL)
+	{
+		return true;
+	}
+	Sint64 size = SDL_RWsize(file);
+	std::string text(size > 0 ? (size_t)size : 0, '\0');
+	if (size > 0)
+	{
+		SDL_RWread(file, &text[0], 1, (size_t)size);
+	}
+	SDL_RWclose(file);
+
+	//Actions already rebound by an earlier line keep their new keys
+	bool rebound[INPUT_ACTION_TOTAL] = {};
+	bool success = true;
+	int lineNumber = 0;
+	size_t start = 0;
+	while (start < text.size())
+	{
+		size_t end = text.find('\n', start);
+		if (end == std::string::npos)
+		{
+			end = text.size();
+		}
+		std::string line = text.substr(start, end - start);
+		start = end + 1;
+		++lineNumber;
+
+		//Trim, skip blanks and comments
+		size_t first = line.find_first_not_of(" \t\r");
+		size_t last = line.find_last_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+		{
+			continue;
+		}
+		line = line.substr(first, last - first + 1);
+
+		//Name, then the rest of the line, key names can contain spaces
+		size_t space = line.find_first_of(" \t");
+		size_t valueStart = space == std::string::npos ? std::string::npos : line.find_first_not_of(" \t", space);
+		if (valueStart == std::string::npos)
+		{
+			printf("%s:%d: expected a name and a value\n", path, lineNumber);
+			success = false;
+			continue;
+		}
+		std::string name = line.substr(0, space);
+		std::string value = line.substr(valueStart);
+
+		int ms = 0;
+		if (name == "das" || name == "arr")
+		{
+			if (SDL_sscanf(value.c_str(), "%d", &ms) != 1 || ms < 0)
+			{
+				printf("%s:%d: bad time %s\n", path, lineNumber, value.c_str());
+				success = false;
+			}
+			else if (name == "das")
+			{
+				mDasTicks = msToTicks(ms);
+			}
+			else
+			{
+				mArrTicks = msToTicks(ms);
+			}
+			continue;
+		}
+
+		int action = 0;
+		while (action < INPUT_ACTION_TOTAL && name != gInputActionNames[action])
+		{
+			++action;
+		}
+		SDL_Keycode key = SDL_GetKeyFromName(value.c_str());
+		if (action == INPUT_ACTION_TOTAL || key == SDLK_UNKNOWN)
+		{
+			printf("%s:%d: unknown action or key \"%s\"\n", path, lineNumber, line.c_str());
+			success = false;
+			continue;
+		}
+		if (!rebound[action])
+		{
+			unbind((InputAction)action);
+			rebound[action] = true;
+		}
+		if (!bind((InputAction)action, key))
+		{
+			printf("%s:%d: %s already has %d keys\n", path, lineNumber, name.c_str(), INPUT_MAX_KEYS);
+			success = false;
+		}
+	}
+	return success;
+}
+
+bool LInput::bind(InputAction action, SDL_Keycode key)
+{
+	//A key drives one action only
+	for (int i = 0; i < INPUT_ACTION_TOTAL; ++i)
+	{
+		for (int slot = 0; slot < INPUT_MAX_KEYS; ++slot)
+		{
+			if (mKeys[i][slot] == key)
+			{
+				mKeys[i][slot] = 0;
+			}
+		}
+	}
+
+	for (int slot = 0; slot < INPUT_MAX_KEYS; ++slot)
+	{
+		if (mKeys[action][slot] == 0)
+		{
+			mKeys[action][slot] = key;
+			return true;
+		}
+	}
+	return false;
+}
+
+void LInput::unbind(InputAction action)
+{
+	for (int slot = 0; slot < INPUT_MAX_KEYS; ++slot)
+	{
+		mKeys[action][slot] = 0;
+	}
+}
+
+InputAction LInput::getAction(SDL_Keycode key) const
+{
+	for (int action = 0; action < INPUT_ACTION_TOTAL; ++action)
+	{
+		for (int slot = 0; slot < INPUT_MAX_KEYS; ++slot)
+		{
+			if (key != 0 && mKeys[action][slot] == key)
+			{
+				return (InputAction)action;
+			}
+		}
+	}
+	return INPUT_ACTION_TOTAL;
+}
+
+void LInput::setRepeat(int dasMs, int arrMs)
+{
+	mDasTicks = msToTicks(dasMs);
+	mArrTicks = msToTicks(arrMs);
+}
+
+bool LInput::handleEvent(const SDL_Event& e)
+{
+	//Keys held while the window loses focus never see their release
+	LInputEvent event;
+	if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+	{
+		event.time = SDL_GetPerformanceCounter();
+		event.action = INPUT_ACTION_TOTAL;
+		event.pressed = false;
+		mEvents.push(event);
+		return false;
+	}
+	if (e.type != SDL_KEYDOWN && e.type != SDL_KEYUP)
+	{
+		return false;
+	}
+	InputAction action = getAction(e.key.keysym.sym);
+	if (action == INPUT_ACTION_TOTAL)
+	{
+		return false;
+	}
+
+	//Repeats come from DAS and ARR, not from the OS
+	if (e.key.repeat)
+	{
+		return true;
+	}
+
+	//SDL stamps events in milliseconds of SDL_GetTicks(), move that onto the performance counter the ticks run on
+	Uint64 now = SDL_GetPerformanceCounter();
+	Sint32 age = (Sint32)(SDL_GetTicks() - e.key.timestamp);
+	Uint64 delay = age > 0 ? (Uint64)age * SDL_GetPerformanceFrequency() / 1000 : 0;
+
+	event.time = delay < now ? now - delay : 0;
+	event.action = action;
+	event.pressed = e.type == SDL_KEYDOWN;
+	if (!mEvents.push(event))
+	{
+		printf("Input queue full, dropping a key event!\n");
+	}
+	return true;
+}
+
+Uint32 LInput::tick(Uint64 tickEnd)
+{
+	Uint32 actions = ACTION_NONE;
+	bool shiftPressed = false;
+
+	//Every key change up to the end of this tick, in the order they happened
+	LInputEvent event;
+	while (mEvents.peek(&event) && event.time <= tickEnd)
+	{
+		mEvents.pop(&event);
+
+		InputAction action = event.action;
+		if (action == INPUT_ACTION_TOTAL)
+		{
+			memset(mHeld, 0, sizeof(mHeld));
+			mShift = INPUT_ACTION_TOTAL;
+			mShiftTicks = 0;
+		}
+		else if (event.pressed)
+		{
+			//Only the first key of an action presses it
+			if (mHeld[action]++ > 0)
+			{
+				continue;
+			}
+			actions |= gInputGameActions[action];
+
+			//Measured once a frame showing this tick is presented, a full queue means frames stopped and the sample is worthless anyway
+			LPendingPress press;
+			press.time = event.time;
+			press.applied = tickEnd;
+			press.action = action;
+			mPending.push(press);
+
+			//The newest direction wins and charges its own DAS
+			if (action == INPUT_LEFT || action == INPUT_RIGHT)
+			{
+				mShift = action;
+				mShiftTicks = 0;
+				shiftPressed = true;
+			}
+		}
+		else if (mHeld[action] > 0 && --mHeld[action] == 0 && action == mShift)
+		{
+			//Letting go of one direction falls back to the other if it is still down, recharging DAS
+			InputAction other = action == INPUT_LEFT ? INPUT_RIGHT : INPUT_LEFT;
+			mShift = mHeld[other] > 0 ? other : INPUT_ACTION_TOTAL;
+			mShiftTicks = 0;
+		}
+	}
+
+	//Auto shift once DAS charged, then every ARR ticks
+	if (mShift != INPUT_ACTION_TOTAL && !shiftPressed)
+	{
+		++mShiftTicks;
+		if (mShiftTicks >= mDasTicks && (mShiftTicks - mDasTicks) % mArrTicks == 0)
+		{
+			actions |= gInputGameActions[mShift];
+		}
+	}
+
+	//Soft drop lasts as long as the key
+	if (mHeld[INPUT_SOFT_DROP] > 0)
+	{
+		actions |= ACTION_SOFT_DROP;
+	}
+	return actions;
+}
+
+void LInput::reset()
+{
+	mEvents.clear();
+	memset(mHeld, 0, sizeof(mHeld));
+	mShift = INPUT_ACTION_TOTAL;
+	mShiftTicks = 0;
+}
+
+void LInput::present(Uint64 presentTime, Uint64 shownTickEnd)
+{
+	double frequency = (double)SDL_GetPerformanceFrequency();
+	LPendingPress press;
+	while (mPending.peek(&press) && press.applied <= shownTickEnd)
+	{
+		mPending.pop(&press);
+		double ms = presentTime > press.time ? (double)(presentTime - press.time) * 1000.0 / frequency : 0.0;
+		int bucket = (int)ms;
+		if (bucket >= INPUT_LATENCY_BUCKETS)
+		{
+			bucket = INPUT_LATENCY_BUCKETS - 1;
+		}
+		++mLatency[press.action][bucket];
+		++mLatencyCount[press.action];
+		if (ms > mLatencyMax[press.action])
+		{
+			mLatencyMax[press.action] = ms;
+		}
+	}
+}
+
+double LInput::getLatencyPercentile(InputAction action, double percentile) const
+{
+	int first = action == INPUT_ACTION_TOTAL ? 0 : action;
+	int last = action == INPUT_ACTION_TOTAL ? INPUT_ACTION_TOTAL - 1 : action;
+	int samples = getLatencySamples(action);
+	if (samples == 0)
+	{
+		return 0.0;
+	}
+
+	//Walk the buckets up to the sample the percentile falls on, report the bucket's middle
+	int target = (int)(percentile * samples);
+	if (target >= samples)
+	{
+		target = samples - 1;
+	}
+	int seen = 0;
+	for (int bucket = 0; bucket < INPUT_LATENCY_BUCKETS - 1; ++bucket)
+	{
+		for (int i = first; i <= last; ++i)
+		{
+			seen += mLatency[i][bucket];
+		}
+		if (seen > target)
+		{
+			return bucket + 0.5;
+		}
+	}
+
+	//Slow tail, the worst seen is all there is
+	double worst = 0.0;
+	for (int i = first; i <= last; ++i)
+	{
+		if (mLatencyMax[i] > worst)
+		{
+			worst = mLatencyMax[i];
+		}
+	}
+	return worst;
+}
+
+int LInput::getLatencySamples(InputAction action) const
+{
+	if (action != INPUT_ACTION_TOTAL)
+	{
+		return mLatencyCount[action];
+	}
+	int samples = 0;
+	for (int i = 0; i < INPUT_ACTION_TOTAL; ++i)
+	{
+		samples += mLatencyCount[i];
+	}
+	return samples;
+}
+
+void LInput::printLatencyReport() const
+{
+	if (getLatencySamples(INPUT_ACTION_TOTAL) == 0)
+	{
+		return;
+	}
+
+	printf("Input to present latency, ms\n");
+	printf("%-11s %7s %7s %7s %7s %7s\n", "action", "count", "p50", "p90", "p99", "max");
+	for (int action = 0; action <= INPUT_ACTION_TOTAL; ++action)
+	{
+		InputAction which = (InputAction)action;
+		if (getLatencySamples(which) == 0)
+		{
+			continue;
+		}
+		double worst = 0.0;
+		for (int i = 0; i < INPUT_ACTION_TOTAL; ++i)
+		{
+			if ((action == INPUT_ACTION_TOTAL || action == i) && mLatencyMax[i] > worst)
+			{
+				worst = mLatencyMax[i];
+			}
+		}
+		printf("%-11s %7d %7.1f %7.1f %7.1f %7.1f\n", action == INPUT_ACTION_TOTAL ? "all" : gInputActionNames[action], getLatencySamples(which),
+			getLatencyPercentile(which, 0.5), getLatencyPercentile(which, 0.9), getLatencyPercentile(which, 0.99), worst);
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+/* Headers */
+//Using SDL events and the game actions
+#include <SDL.h>
+#include "Game.h"
+#include "LockFree.h"
+
+
+
+/* Constants */
+
+//Where key bindings and repeat timings are read from, missing means defaults
+const char* const INPUT_CONFIG_PATH = "controls.cfg";
+
+//Default delayed auto shift and auto repeat rate
+const int INPUT_DEFAULT_DAS_MS = 133;
+const int INPUT_DEFAULT_ARR_MS = 33;
+
+//Keys one action can be bound to
+const int INPUT_MAX_KEYS = 3;
+
+//Key changes waiting for their logic tick, far more than a frame ever sees, a power of two
+const int INPUT_QUEUE_CAPACITY = 64;
+
+//Presses waiting for the frame that shows them, a power of two
+const int INPUT_MAX_PENDING = 64;
+
+//Latency histogram, one millisecond per bucket and everything slower in the last one
+const int INPUT_LATENCY_BUCKETS = 128;
+
+//Bindable player actions, each maps to one GameAction bit
+enum InputAction
+{
+	INPUT_LEFT,
+	INPUT_RIGHT,
+	INPUT_SOFT_DROP,
+	INPUT_HARD_DROP,
+	INPUT_ROTATE_CW,
+	INPUT_ROTATE_CCW,
+	INPUT_HOLD,
+	INPUT_ACTION_TOTAL
+};
+
+//Names used in the config file and the latency report
+extern const char* const gInputActionNames[INPUT_ACTION_TOTAL];
+
+//Turns key events into per tick game actions
+//Events keep the time SDL stamped them with and are applied in the logic tick they happened in, not the frame they were polled in
+//DAS and ARR count logic ticks, so a tap and a held key behave the same at any frame rate
+//Events come in and latency is measured on the main thread, tick() and reset() belong to the simulation thread
+class LInput
+{
+public:
+	//Initializes default bindings and timings
+	LInput();
+
+	//Restores default bindings and timings
+	void setDefaults();
+
+	//Reads bindings from a config file, each line is "action key name" or "das ms" or "arr ms"
+	//An action named in the file loses its default keys
+	bool loadConfig(const char* path);
+
+	//Binds a key to an action, false when the action has no free slot
+	bool bind(InputAction action, SDL_Keycode key);
+
+	//Removes every key of an action
+	void unbind(InputAction action);
+
+	//Gets the action a key is bound to, INPUT_ACTION_TOTAL when none
+	InputAction getAction(SDL_Keycode key) const;
+
+	//Sets repeat timings in milliseconds, ARR is at least one tick
+	void setRepeat(int dasMs, int arrMs);
+
+	//Queues a key event of a bound key, false when the event is not for the input layer
+	bool handleEvent(const SDL_Event& e);
+
+	//Applies queued events that happened before tickEnd, a performance counter time, and gets the tick's actions
+	Uint32 tick(Uint64 tickEnd);
+
+	//Releases every key and drops queued events
+	void reset();
+
+	//Turns presses applied by ticks up to shownTickEnd into latency samples, both performance counter times
+	void present(Uint64 presentTime, Uint64 shownTickEnd);
+
+	//Gets the latency percentile in milliseconds of one action, or of all with INPUT_ACTION_TOTAL
+	double getLatencyPercentile(InputAction action, double percentile) const;
+
+	//Gets how many latency samples an action has, or all with INPUT_ACTION_TOTAL
+	int getLatencySamples(InputAction action) const;
+
+	//Prints count, p50, p90, p99 and max latency per action
+	void printLatencyReport() const;
+
+private:
+	//Key change waiting for its tick, a release of INPUT_ACTION_TOTAL lets go of everything
+	struct LInputEvent
+	{
+		Uint64 time;
+		InputAction action;
+		bool pressed;
+	};
+
+	//Press applied to the game at the end of a tick, waiting to be seen
+	struct LPendingPress
+	{
+		Uint64 time;
+		Uint64 applied;
+		InputAction action;
+	};
+
+	//Bound keys per action, 0 for an empty slot
+	SDL_Keycode mKeys[INPUT_ACTION_TOTAL][INPUT_MAX_KEYS];
+
+	//Repeat timings in ticks
+	int mDasTicks;
+	int mArrTicks;
+
+	//Events from the main thread
+	LSpscQueue<LInputEvent, INPUT_QUEUE_CAPACITY> mEvents;
+
+	//Keys held per action, two keys on one action only press it once
+	int mHeld[INPUT_ACTION_TOTAL];
+
+	//Direction being auto shifted and ticks since it was pressed
+	InputAction mShift;
+	int mShiftTicks;
+
+	//Presses from the simulation thread not presented yet
+	LSpscQueue<LPendingPress, INPUT_MAX_PENDING> mPending;
+
+	//Input to present latency per action
+	int mLatency[INPUT_ACTION_TOTAL][INPUT_LATENCY_BUCKETS];
+	int mLatencyCount[INPUT_ACTION_TOTAL];
+	double mLatencyMax[INPUT_ACTION_TOTAL];
+};
+
+//Input of the local player
+extern LInput gInput;
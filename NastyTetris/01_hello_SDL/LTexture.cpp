@@ -0,0 +1,223 @@
+/* Headers */
+#include "LTexture.h"
+#include "Atlas.h"
+#include "SpriteBatch.h"
+#include "TextureImport.h"
+#include <stdio.h>
+
+
+
+LTexture::LTexture()
+{
+	//Initialize
+	mTexture = NULL;
+	mRegion.x = 0;
+	mRegion.y = 0;
+	mRegion.w = 0;
+	mRegion.h = 0;
+	mRed = 0xFF;
+	mGreen = 0xFF;
+	mBlue = 0xFF;
+	mAlpha = 0xFF;
+	mBlendMode = SDL_BLENDMODE_BLEND;
+	mPremultiplied = false;
+	mWidth = 0;
+	mHeight = 0;
+}
+
+LTexture::~LTexture()
+{
+	//Deallocate
+	free();
+}
+
+void LTexture::free()
+{
+	//Free texture if it exists
+	if (mTexture != NULL)
+	{
+		//The manager frees it once no other texture shares it
+		mHandle.reset();
+		mTexture = NULL;
+		mPremultiplied = false;
+		mWidth = 0;
+		mHeight = 0;
+	}
+}
+
+void LTexture::setColor(Uint8 red, Uint8 green, Uint8 blue)
+{
+	//Modulate texture
+	mRed = red;
+	mGreen = green;
+	mBlue = blue;
+}
+
+void LTexture::render(int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip)
+{
+	//Set rendering space and render to screen
+	SDL_Rect renderQuaad = { x, y, mWidth, mHeight };
+
+	//Set clip rendering dimensions, clips are relative to the image region
+	SDL_Rect source = mRegion;
+	if (clip != NULL)
+	{
+		renderQuaad.w = clip->w;
+		renderQuaad.h = clip->h;
+		source.x += clip->x;
+		source.y += clip->y;
+		source.w = clip->w;
+		source.h = clip->h;
+	}
+
+	//Premultiplied images blend their own way and fade by scaling color along with alpha
+	SDL_Color color = { mRed, mGreen, mBlue, mAlpha };
+	SDL_BlendMode blendMode = mBlendMode;
+	if (mPremultiplied && mBlendMode == SDL_BLENDMODE_BLEND)
+	{
+		color.r = (Uint8)((color.r * color.a + 127) / 255);
+		color.g = (Uint8)((color.g * color.a + 127) / 255);
+		color.b = (Uint8)((color.b * color.a + 127) / 255);
+		blendMode = gTextureImporter.getBlendMode();
+	}
+
+	//Queue into the frame batch while one is recording
+	if (gSpriteBatch.isRecording())
+	{
+		SDL_FRect destination = { (float)renderQuaad.x, (float)renderQuaad.y, (float)renderQuaad.w, (float)renderQuaad.h };
+		SDL_FPoint pivot = { 0.0f, 0.0f };
+		if (center != NULL)
+		{
+			pivot.x = (float)center->x;
+			pivot.y = (float)center->y;
+		}
+		gSpriteBatch.draw(mTexture, &source, destination, color, blendMode, angle, center != NULL ? &pivot : NULL, flip);
+		return;
+	}
+
+	//Apply this image's modulation to the possibly shared texture
+	SDL_SetTextureColorMod(mTexture, color.r, color.g, color.b);
+	SDL_SetTextureAlphaMod(mTexture, color.a);
+	SDL_SetTextureBlendMode(mTexture, blendMode);
+
+	//Render to screen
+	SDL_RenderCopyEx(gRenderer, mTexture, &source, &renderQuaad, angle, center, flip);
+}
+
+int LTexture::getWidth()
+{
+	return mWidth;
+}
+
+int LTexture::getHeight()
+{
+	return mHeight;
+}
+
+bool LTexture::loadFromFile(const std::string& path)
+{
+	//Get rid of preexisting texture
+	free();
+
+	//Packed images draw straight from the atlas
+	if (loadFromAtlas(path))
+	{
+		return true;
+	}
+
+	//Shared with every other texture loaded from the same path
+	mHandle = gResources.loadTexture(path);
+	mTexture = mHandle.get();
+	if (mTexture == NULL)
+	{
+		return false;
+	}
+
+	//Get image dimensions
+	SDL_QueryTexture(mTexture, NULL, NULL, &mWidth, &mHeight);
+	mRegion.x = 0;
+	mRegion.y = 0;
+	mRegion.w = mWidth;
+	mRegion.h = mHeight;
+	mPremultiplied = gTextureImporter.isPremultiplied();
+	return true;
+}
+
+bool LTexture::loadFromAtlas(const std::string& path)
+{
+	//Get rid of preexisting texture
+	free();
+
+	//Look up the packed image
+	if (!gAtlas.getRegion(path, &mTexture, &mRegion))
+	{
+		return false;
+	}
+
+	mWidth = mRegion.w;
+	mHeight = mRegion.h;
+	mPremultiplied = gTextureImporter.isPremultiplied();
+	return true;
+}
+
+void LTexture::setBlendMode(SDL_BlendMode blending)
+{
+	//Set blending function
+	mBlendMode = blending;
+}
+
+void LTexture::setAlpha(Uint8 alpha)
+{
+	//Module texture alpha
+	mAlpha = alpha;
+}
+
+#if defined(SDL_TTF_MAJOR_VERSION)
+bool LTexture::loadFromRenderedText(const std::string& textureText, SDL_Color textColor)
+{
+	//Get rif of preexisting texture
+	free();
+
+	//The same string in the same color and font renders identically, share it
+	char id[64];
+	SDL_snprintf(id, sizeof(id), "text:%p:%02x%02x%02x%02x:", (void*)gFont, textColor.r, textColor.g, textColor.b, textColor.a);
+	std::string textId = id + textureText;
+	mHandle = gResources.findTexture(textId);
+
+	if (!mHandle)
+	{
+		//Render text surface
+		SDL_Surface* textSurface = TTF_RenderText_Solid(gFont, textureText.c_str(), textColor);
+		if (textSurface == NULL)
+		{
+			printf("Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError());
+		}
+		else
+		{
+			//Create texture from surface pixels, the manager owns it from here
+			mHandle = gResources.addTexture(textId, SDL_CreateTextureFromSurface(gRenderer, textSurface));
+			if (!mHandle)
+			{
+				printf("Unable to create texture from rendered text! SDL Error: %s\n", SDL_GetError());
+			}
+
+			//Get rid of old surface
+			SDL_FreeSurface(textSurface);
+		}
+	}
+
+	mTexture = mHandle.get();
+	if (mTexture != NULL)
+	{
+		//Get image dimensions
+		SDL_QueryTexture(mTexture, NULL, NULL, &mWidth, &mHeight);
+		mRegion.x = 0;
+		mRegion.y = 0;
+		mRegion.w = mWidth;
+		mRegion.h = mHeight;
+	}
+
+	//Retyurn success
+	return mTexture != NULL;
+}
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+/* Headers */
+//Using SDL, SDL_image, SDL_ttf, STL string and managed texture handles
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_ttf.h>
+#include <string>
+#include "ResourceManager.h"
+
+
+
+/* Global Variables */
+//The window renderer
+extern SDL_Renderer* gRenderer;
+
+//Globally used font
+extern TTF_Font* gFont;
+
+//Texture wrapper class
+class LTexture
+{
+public:
+	//Initializes variables
+	LTexture();
+
+	//Deallocates memory
+	~LTexture();
+
+	//Loads image ad specified path
+	bool loadFromFile(const std::string& path);
+
+	//Uses the image packed in the global atlas, fails if it was not packed
+	bool loadFromAtlas(const std::string& path);
+
+	//Creates image from font string
+#if defined(SDL_TTF_MAJOR_VERSION)
+	bool loadFromRenderedText(const std::string& textureText, SDL_Color textColor);
+#endif
+
+	//Deallocates texture
+	void free();
+
+	//Set color modulation
+	void setColor(Uint8 red, Uint8 green, Uint8 blue);
+
+	//Set blending
+	void setBlendMode(SDL_BlendMode blending);
+
+	//Set alpha modulation
+	void setAlpha(Uint8 alpha);
+
+	//Renders texture at given point
+	void render(int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE);
+
+	//Gets image dimensions
+	int getWidth();
+	int getHeight();
+
+private:
+	//The actual hardware texture
+	SDL_Texture* mTexture;
+
+	//Keeps mTexture loaded, empty for atlas pages which belong to the atlas
+	LTextureHandle mHandle;
+
+	//Part of the texture holding the image, only smaller than the texture for atlas images
+	SDL_Rect mRegion;
+
+	//Modulation, applied at render time since the texture may be shared
+	Uint8 mRed;
+	Uint8 mGreen;
+	Uint8 mBlue;
+	Uint8 mAlpha;
+	SDL_BlendMode mBlendMode;
+
+	//Imported images hold color already multiplied by alpha, rendered text doesn't
+	bool mPremultiplied;
+
+	//Image dimensions
+	int mWidth;
+	int mHeight;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+/* Headers */
+//Using STL atomic
+#include <atomic>
+
+
+
+//Hands whole values from one writer thread to one reader thread without either ever waiting
+//The writer fills its own buffer and swaps it into the middle, the reader swaps the middle out when it holds something newer
+//Values the reader skipped are simply overwritten, the reader always gets the newest one
+template <typename T>
+class LTripleBuffer
+{
+public:
+	//Initializes the buffers with T's default, which is what the reader sees before the first publish
+	LTripleBuffer();
+
+	//Writer: gets the buffer to fill, only the writer touches it until publish()
+	T& getWriteBuffer();
+
+	//Writer: hands the filled buffer to the reader and gets a new one to fill
+	void publish();
+
+	//Reader: switches to the newest published buffer, false when nothing was published since the last call
+	bool update();
+
+	//Reader: gets the buffer being read, stays valid and unchanged until the next update()
+	const T& getReadBuffer() const;
+
+private:
+	//Set in mMiddle when the reader has not taken the buffer there yet
+	static const int FRESH = 4;
+
+	//Buffers, one each for writer and reader and one in between
+	T mBuffers[3];
+
+	//Index of the buffer in between, plus FRESH
+	std::atomic<int> mMiddle;
+
+	//Owned by each side
+	int mWrite;
+	int mRead;
+};
+
+//Fixed capacity queue between exactly one producer thread and one consumer thread
+//N must be a power of two, push() fails when the consumer is N items behind
+template <typename T, int N>
+class LSpscQueue
+{
+public:
+	//Initializes an empty queue
+	LSpscQueue();
+
+	//Producer: appends an item, false when full
+	bool push(const T& item);
+
+	//Consumer: gets the oldest item without removing it, false when empty
+	bool peek(T* item) const;
+
+	//Consumer: removes the oldest item, false when empty
+	bool pop(T* item);
+
+	//Consumer: drops everything pushed so far
+	void clear();
+
+private:
+	//Items, head and tail only ever grow and wrap through the mask
+	T mItems[N];
+	std::atomic<unsigned int> mHead;
+	std::atomic<unsigned int> mTail;
+};
+
+template <typename T>
+LTripleBuffer<T>::LTripleBuffer() : mMiddle(1)
+{
+	mWrite = 0;
+	mRead = 2;
+}
+
+template <typename T>
+T& LTripleBuffer<T>::getWriteBuffer()
+{
+	return mBuffers[mWrite];
+}
+
+template <typename T>
+void LTripleBuffer<T>::publish()
+{
+	//Release so the reader sees everything written to the buffer, acquire to take the middle one back safely
+	mWrite = mMiddle.exchange(mWrite | FRESH, std::memory_order_acq_rel) & (FRESH - 1);
+}
+
+template <typename T>
+bool LTripleBuffer<T>::update()
+{
+	if ((mMiddle.load(std::memory_order_relaxed) & FRESH) == 0)
+	{
+		return false;
+	}
+	mRead = mMiddle.exchange(mRead, std::memory_order_acq_rel) & (FRESH - 1);
+	return true;
+}
+
+template <typename T>
+const T& LTripleBuffer<T>::getReadBuffer() const
+{
+	return mBuffers[mRead];
+}
+
+template <typename T, int N>
+LSpscQueue<T, N>::LSpscQueue() : mHead(0), mTail(0)
+{
+	static_assert((N & (N - 1)) == 0, "LSpscQueue capacity must be a power of two");
+}
+
+template <typename T, int N>
+bool LSpscQueue<T, N>::push(const T& item)
+{
+	unsigned int tail = mTail.load(std::memory_order_relaxed);
+	if (tail - mHead.load(std::memory_order_acquire) == (unsigned int)N)
+	{
+		return false;
+	}
+	mItems[tail & (N - 1)] = item;
+	mTail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, int N>
+bool LSpscQueue<T, N>::peek(T* item) const
+{
+	unsigned int head = mHead.load(std::memory_order_relaxed);
+	if (head == mTail.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+	*item = mItems[head & (N - 1)];
+	return true;
+}
+
+template <typename T, int N>
+bool LSpscQueue<T, N>::pop(T* item)
+{
+	if (!peek(item))
+	{
+		return false;
+	}
+	mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, int N>
+void LSpscQueue<T, N>::clear()
+{
+	mHead.store(mTail.load(std::memory_order_acquire), std::memory_order_release);
+}
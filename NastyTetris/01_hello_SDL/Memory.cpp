@@ -0,0 +1,215 @@
+/* Headers */
+#include "Memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <atomic>
+#include <new>
+
+
+
+//Allocation calls so far, relaxed since only the total matters
+static std::atomic<Uint64> gAllocationCount(0);
+
+//What SDL allocated with before the counter was put in front
+static SDL_malloc_func gSDLMalloc = NULL;
+static SDL_calloc_func gSDLCalloc = NULL;
+static SDL_realloc_func gSDLRealloc = NULL;
+static SDL_free_func gSDLFree = NULL;
+
+//Arena for the main loop
+LFrameArena gFrameArena;
+
+//Every other new and delete without an alignment ends up in these, over-aligned ones keep the library's and go uncounted
+void* operator new(size_t size)
+{
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nothrow) noexcept
+{
+	return operator new(size, nothrow);
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	free(memory);
+}
+
+static void* SDLCALL countingMalloc(size_t size)
+{
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	return gSDLMalloc(size);
+}
+
+static void* SDLCALL countingCalloc(size_t count, size_t size)
+{
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	return gSDLCalloc(count, size);
+}
+
+static void* SDLCALL countingRealloc(void* memory, size_t size)
+{
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	return gSDLRealloc(memory, size);
+}
+
+void installAllocationCounter()
+{
+	if (gSDLMalloc != NULL)
+	{
+		return;
+	}
+
+	//Frees go straight through, only allocations are counted
+	SDL_GetMemoryFunctions(&gSDLMalloc, &gSDLCalloc, &gSDLRealloc, &gSDLFree);
+	if (SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, gSDLFree) < 0)
+	{
+		printf("Unable to count SDL allocations! SDL Error: %s\n", SDL_GetError());
+	}
+}
+
+Uint64 getAllocationCount()
+{
+	return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+LFrameArena::LFrameArena()
+{
+	//Initialize
+	mBlock = NULL;
+	mCapacity = 0;
+	mUsed = 0;
+	mPeak = 0;
+	mOverflows = 0;
+}
+
+LFrameArena::~LFrameArena()
+{
+	//Deallocate
+	free();
+}
+
+bool LFrameArena::init(size_t capacity)
+{
+	//Get rid of preexisting block
+	free();
+
+	mBlock = new (std::nothrow) Uint8[capacity];
+	if (mBlock == NULL)
+	{
+		printf("Unable to allocate %u byte frame arena!\n", (unsigned int)capacity);
+		return false;
+	}
+	mCapacity = capacity;
+	return true;
+}
+
+void LFrameArena::free()
+{
+	delete[] mBlock;
+	mBlock = NULL;
+	mCapacity = 0;
+	mUsed = 0;
+}
+
+void* LFrameArena::allocate(size_t size, size_t alignment)
+{
+	//Aligned against the address, the block itself only comes with new's alignment
+	size_t address = (size_t)(mBlock + mUsed);
+	size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+	if (mBlock == NULL || size > mCapacity - mUsed || padding > mCapacity - mUsed - size)
+	{
+		++mOverflows;
+		return NULL;
+	}
+
+	void* memory = mBlock + mUsed + padding;
+	mUsed += padding + size;
+	if (mUsed > mPeak)
+	{
+		mPeak = mUsed;
+	}
+	return memory;
+}
+
+const char* LFrameArena::format(const char* format, ...)
+{
+	//Measure first so the text takes exactly its own length
+	va_list args;
+	va_start(args, format);
+	int length = SDL_vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	char* text = length >= 0 ? (char*)allocate(length + 1, 1) : NULL;
+	if (text == NULL)
+	{
+		return "";
+	}
+	va_start(args, format);
+	SDL_vsnprintf(text, length + 1, format, args);
+	va_end(args);
+	return text;
+}
+
+void LFrameArena::reset()
+{
+	mUsed = 0;
+}
+
+size_t LFrameArena::getUsed() const
+{
+	return mUsed;
+}
+
+size_t LFrameArena::getPeak() const
+{
+	return mPeak;
+}
+
+int LFrameArena::getOverflows() const
+{
+	return mOverflows;
+}
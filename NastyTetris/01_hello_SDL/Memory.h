@@ -0,0 +1,187 @@
+#pragma once
+
+/* Headers */
+//Using SDL memory functions and types
+#include <SDL.h>
+#include <stddef.h>
+
+
+
+/* Constants */
+
+//Bytes the frame arena hands out between two resets
+const size_t FRAME_ARENA_CAPACITY = 64 * 1024;
+
+//Alignment the arena uses unless asked for more, enough for any scalar type
+const size_t FRAME_ARENA_ALIGNMENT = 16;
+
+//Routes SDL's own allocations through the counter, call before anything else touches SDL
+void installAllocationCounter();
+
+//Gets the number of operator new and SDL allocation calls since startup, from any thread
+Uint64 getAllocationCount();
+
+//Bump allocator for data that lives until the end of the frame, reset once per main loop iteration
+//Main thread only, nothing handed out gets destructed
+class LFrameArena
+{
+public:
+	//Initializes variables
+	LFrameArena();
+
+	//Deallocates the block
+	~LFrameArena();
+
+	//Allocates the block up front, the only allocation the arena makes
+	bool init(size_t capacity);
+
+	//Deallocates the block
+	void free();
+
+	//Hands out bytes with the given alignment, a power of two, or NULL when the frame used the block up
+	void* allocate(size_t size, size_t alignment = FRAME_ARENA_ALIGNMENT);
+
+	//Hands out an array of count trivially destructible objects
+	template <typename T>
+	T* allocateArray(int count);
+
+	//Formats text into the arena, an empty string when it does not fit
+	const char* format(const char* format, ...);
+
+	//Takes back everything handed out this frame
+	void reset();
+
+	//Gets bytes used this frame, the most any frame used, and requests that did not fit
+	size_t getUsed() const;
+	size_t getPeak() const;
+	int getOverflows() const;
+
+private:
+	//The block and how far into it this frame got
+	Uint8* mBlock;
+	size_t mCapacity;
+	size_t mUsed;
+
+	//Statistics
+	size_t mPeak;
+	int mOverflows;
+};
+
+//Fixed capacity objects in inline storage, acquire() fails rather than grow
+//Slots are reused, an acquired object starts out value initialized
+template <typename T, int N>
+class LObjectPool
+{
+public:
+	//Initializes every slot as free
+	LObjectPool();
+
+	//Takes a free slot, NULL when all are in use
+	T* acquire();
+
+	//Gives a slot back
+	void release(T* object);
+
+	//Gives every slot back
+	void clear();
+
+	//Walks slots in order, the ones in use hold live objects
+	bool isActive(int slot) const;
+	T& get(int slot);
+	const T& get(int slot) const;
+
+	//Gets slot counts
+	int getActiveCount() const;
+	int getCapacity() const;
+
+private:
+	//Objects and which of them are in use
+	T mObjects[N];
+	bool mActive[N];
+
+	//Stack of free slots
+	int mFree[N];
+	int mFreeCount;
+};
+
+//Arena for the main loop
+extern LFrameArena gFrameArena;
+
+template <typename T>
+T* LFrameArena::allocateArray(int count)
+{
+	size_t alignment = alignof(T) > FRAME_ARENA_ALIGNMENT ? alignof(T) : FRAME_ARENA_ALIGNMENT;
+	return count > 0 ? (T*)allocate(sizeof(T) * count, alignment) : NULL;
+}
+
+template <typename T, int N>
+LObjectPool<T, N>::LObjectPool()
+{
+	clear();
+}
+
+template <typename T, int N>
+T* LObjectPool<T, N>::acquire()
+{
+	if (mFreeCount == 0)
+	{
+		return NULL;
+	}
+	int slot = mFree[--mFreeCount];
+	mActive[slot] = true;
+	mObjects[slot] = T();
+	return &mObjects[slot];
+}
+
+template <typename T, int N>
+void LObjectPool<T, N>::release(T* object)
+{
+	int slot = (int)(object - mObjects);
+	if (slot >= 0 && slot < N && mActive[slot])
+	{
+		mActive[slot] = false;
+		mFree[mFreeCount++] = slot;
+	}
+}
+
+template <typename T, int N>
+void LObjectPool<T, N>::clear()
+{
+	//Lowest slots come out first
+	mFreeCount = N;
+	for (int i = 0; i < N; ++i)
+	{
+		mActive[i] = false;
+		mFree[i] = N - 1 - i;
+	}
+}
+
+template <typename T, int N>
+bool LObjectPool<T, N>::isActive(int slot) const
+{
+	return mActive[slot];
+}
+
+template <typename T, int N>
+T& LObjectPool<T, N>::get(int slot)
+{
+	return mObjects[slot];
+}
+
+template <typename T, int N>
+const T& LObjectPool<T, N>::get(int slot) const
+{
+	return mObjects[slot];
+}
+
+template <typename T, int N>
+int LObjectPool<T, N>::getActiveCount() const
+{
+	return N - mFreeCount;
+}
+
+template <typename T, int N>
+int LObjectPool<T, N>::getCapacity() const
+{
+	return N;
+}
@@ -0,0 +1,333 @@
+/* Headers */
+#include "Menu.h"
+#include "AssetArchive.h"
+#include "GlyphCache.h"
+#include <stdio.h>
+
+
+
+//Main menu
+LMenu gMenu;
+
+LMenu::LMenu()
+{
+	//Initialize
+	mDepth = 0;
+	mStack[0] = 0;
+	mVersion = 0;
+}
+
+bool LMenu::load(const std::string& path)
+{
+	//From the mapped archive when it was packed
+	const LAssetEntry* entry = gAssets.find(path);
+	if (entry != NULL)
+	{
+		return loadFromMemory((const char*)gAssets.getData(entry), (size_t)entry->size, path.c_str());
+	}
+
+	SDL_RWops* file = SDL_RWFromFile(path.c_str(), "rb");
+	if (file == NULL)
+	{
+		printf("Unable to read menu %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+		return false;
+	}
+	Sint64 size = SDL_RWsize(file);
+	std::string text(size > 0 ? (size_t)size : 0, '\0');
+	if (size > 0)
+	{
+		SDL_RWread(file, &text[0], 1, (size_t)size);
+	}
+	SDL_RWclose(file);
+	return loadFromMemory(text.c_str(), text.size(), path.c_str());
+}
+
+bool LMenu::loadFromMemory(const char* text, size_t length, const char* name)
+{
+	std::vector<LMenuScreen> screens;
+	std::vector<LMenuEntry> entries;
+	bool success = true;
+	int lineNumber = 0;
+	size_t start = 0;
+	while (start < length)
+	{
+		size_t end = start;
+		while (end < length && text[end] != '\n')
+		{
+			++end;
+		}
+		std::string line(text + start, end - start);
+		start = end + 1;
+		++lineNumber;
+
+		//Trim, skip blanks and comments
+		size_t first = line.find_first_not_of(" \t\r");
+		size_t last = line.find_last_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+		{
+			continue;
+		}
+		line = line.substr(first, last - first + 1);
+
+		//Keyword, then the rest of the line
+		size_t space = line.find_first_of(" \t");
+		std::string keyword = line.substr(0, space);
+		std::string rest = space == std::string::npos ? "" : line.substr(line.find_first_not_of(" \t", space));
+		if (keyword == "screen")
+		{
+			//Id up to the first space, title after it
+			LMenuScreen screen;
+			space = rest.find_first_of(" \t");
+			screen.name = rest.substr(0, space);
+			screen.title = space == std::string::npos ? "" : rest.substr(rest.find_first_not_of(" \t", space));
+			screen.firstEntry = (int)entries.size();
+			screen.entryCount = 0;
+			screen.selected = 0;
+			screen.titlePosition.x = 0;
+			screen.titlePosition.y = 0;
+			if (screen.name.empty())
+			{
+				printf("%s:%d: screen needs an id\n", name, lineNumber);
+				success = false;
+				continue;
+			}
+			screens.push_back(screen);
+		}
+		else if (keyword == "entry")
+		{
+			//Label up to the last '=', command and its argument after it
+			size_t equals = rest.rfind('=');
+			if (screens.empty() || equals == std::string::npos)
+			{
+				printf("%s:%d: expected \"entry label = command\" inside a screen\n", name, lineNumber);
+				success = false;
+				continue;
+			}
+			LMenuEntry entry;
+			size_t labelEnd = equals > 0 ? rest.find_last_not_of(" \t", equals - 1) : std::string::npos;
+			entry.label = labelEnd == std::string::npos ? "" : rest.substr(0, labelEnd + 1);
+			std::string command = rest.substr(equals + 1);
+			size_t commandStart = command.find_first_not_of(" \t");
+			command = commandStart == std::string::npos ? "" : command.substr(commandStart);
+			space = command.find_first_of(" \t");
+			entry.targetName = space == std::string::npos ? "" : command.substr(command.find_first_not_of(" \t", space));
+			command = command.substr(0, space);
+			entry.target = -1;
+			entry.position.x = 0;
+			entry.position.y = 0;
+			entry.color = MENU_TEXT_COLOR;
+
+			if (command == "open")
+			{
+				entry.command = MENU_COMMAND_OPEN;
+			}
+			else if (command == "back")
+			{
+				entry.command = MENU_COMMAND_BACK;
+			}
+			else if (command == "play")
+			{
+				entry.command = MENU_COMMAND_PLAY;
+			}
+			else if (command == "quit")
+			{
+				entry.command = MENU_COMMAND_QUIT;
+			}
+			else
+			{
+				printf("%s:%d: unknown command \"%s\"\n", name, lineNumber, command.c_str());
+				success = false;
+				continue;
+			}
+
+			//Entries follow their screen, so each screen's entries stay contiguous
+			entries.push_back(entry);
+			++screens.back().entryCount;
+		}
+		else
+		{
+			printf("%s:%d: unknown keyword \"%s\"\n", name, lineNumber, keyword.c_str());
+			success = false;
+		}
+	}
+
+	//Open commands point at screens by index from here on
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i].command != MENU_COMMAND_OPEN)
+		{
+			continue;
+		}
+		for (size_t screen = 0; screen < screens.size(); ++screen)
+		{
+			if (screens[screen].name == entries[i].targetName)
+			{
+				entries[i].target = (int)screen;
+			}
+		}
+		if (entries[i].target < 0)
+		{
+			printf("%s: entry \"%s\" opens unknown screen \"%s\"\n", name, entries[i].label.c_str(), entries[i].targetName.c_str());
+			entries[i].command = MENU_COMMAND_NONE;
+			success = false;
+		}
+	}
+
+	if (screens.empty() || screens[0].entryCount == 0)
+	{
+		printf("%s: menu has no entries\n", name);
+		return false;
+	}
+
+	//Keep the old menu unless the new one is usable
+	mScreens.swap(screens);
+	mEntries.swap(entries);
+	reset();
+	return success;
+}
+
+void LMenu::layout(int width, int height)
+{
+	int lineHeight = gGlyphCache.getLineHeight();
+	for (size_t i = 0; i < mScreens.size(); ++i)
+	{
+		//Title and entries as one block centered on the area
+		LMenuScreen& screen = mScreens[i];
+		int titleHeight = screen.title.empty() ? 0 : lineHeight + MENU_TITLE_GAP;
+		int blockHeight = titleHeight + (screen.entryCount - 1) * MENU_ENTRY_SPACING + lineHeight;
+		int y = (height - blockHeight) / 2;
+
+		screen.titlePosition.x = (width - gGlyphCache.measure(screen.title.c_str())) / 2;
+		screen.titlePosition.y = y;
+		y += titleHeight;
+		for (int entry = 0; entry < screen.entryCount; ++entry)
+		{
+			LMenuEntry& item = mEntries[screen.firstEntry + entry];
+			item.position.x = (width - gGlyphCache.measure(item.label.c_str())) / 2;
+			item.position.y = y;
+			y += MENU_ENTRY_SPACING;
+		}
+	}
+	++mVersion;
+}
+
+void LMenu::reset()
+{
+	for (size_t i = 0; i < mEntries.size(); ++i)
+	{
+		mEntries[i].color = MENU_TEXT_COLOR;
+	}
+	for (size_t i = 0; i < mScreens.size(); ++i)
+	{
+		mScreens[i].selected = 0;
+		if (mScreens[i].entryCount > 0)
+		{
+			mEntries[mScreens[i].firstEntry].color = MENU_SELECTED_COLOR;
+		}
+	}
+	mDepth = 0;
+	mStack[0] = 0;
+	++mVersion;
+}
+
+LMenu::LMenuScreen& LMenu::current()
+{
+	return mScreens[mStack[mDepth]];
+}
+
+const LMenu::LMenuScreen& LMenu::current() const
+{
+	return mScreens[mStack[mDepth]];
+}
+
+void LMenu::select(int index)
+{
+	//Wraps around both ends
+	LMenuScreen& screen = current();
+	if (screen.entryCount == 0)
+	{
+		return;
+	}
+	index = (index + screen.entryCount) % screen.entryCount;
+	if (index == screen.selected)
+	{
+		return;
+	}
+	mEntries[screen.firstEntry + screen.selected].color = MENU_TEXT_COLOR;
+	mEntries[screen.firstEntry + index].color = MENU_SELECTED_COLOR;
+	screen.selected = index;
+	++mVersion;
+}
+
+MenuCommand LMenu::handleKey(SDL_Keycode key)
+{
+	if (mScreens.empty())
+	{
+		return MENU_COMMAND_NONE;
+	}
+
+	LMenuScreen& screen = current();
+	MenuCommand command = MENU_COMMAND_NONE;
+	switch (key)
+	{
+	case SDLK_UP:
+		select(screen.selected - 1);
+		return MENU_COMMAND_NONE;
+
+	case SDLK_DOWN:
+		select(screen.selected + 1);
+		return MENU_COMMAND_NONE;
+
+	case SDLK_ESCAPE:
+	case SDLK_BACKSPACE:
+		command = MENU_COMMAND_BACK;
+		break;
+
+	case SDLK_RETURN:
+		command = screen.entryCount > 0 ? mEntries[screen.firstEntry + screen.selected].command : MENU_COMMAND_NONE;
+		break;
+
+	default:
+		return MENU_COMMAND_NONE;
+	}
+
+	//Screens open and close here, the rest is for the caller
+	if (command == MENU_COMMAND_OPEN && mDepth + 1 < MENU_MAX_DEPTH)
+	{
+		mStack[++mDepth] = mEntries[screen.firstEntry + screen.selected].target;
+		++mVersion;
+		return MENU_COMMAND_NONE;
+	}
+	if (command == MENU_COMMAND_BACK && mDepth > 0)
+	{
+		--mDepth;
+		++mVersion;
+		return MENU_COMMAND_NONE;
+	}
+	return command == MENU_COMMAND_PLAY || command == MENU_COMMAND_QUIT ? command : MENU_COMMAND_NONE;
+}
+
+Uint32 LMenu::getVersion() const
+{
+	return mVersion;
+}
+
+void LMenu::render() const
+{
+	if (mScreens.empty())
+	{
+		return;
+	}
+
+	gSpriteBatch.setLayer(1);
+	const LMenuScreen& screen = current();
+	if (!screen.title.empty())
+	{
+		gGlyphCache.render(screen.titlePosition.x, screen.titlePosition.y, screen.title.c_str(), MENU_TITLE_COLOR);
+	}
+	for (int i = 0; i < screen.entryCount; ++i)
+	{
+		const LMenuEntry& entry = mEntries[screen.firstEntry + i];
+		gGlyphCache.render(entry.position.x, entry.position.y, entry.label.c_str(), entry.color);
+	}
+}
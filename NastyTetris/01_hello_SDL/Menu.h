@@ -0,0 +1,120 @@
+#pragma once
+
+/* Headers */
+//Using SDL and STL string and vector
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+
+
+/* Constants */
+
+//Menu layout, packed into the archive like any other asset
+const char* const MENU_CONFIG_PATH = "assets/menu.cfg";
+
+//Menu used when the config can't be read
+const char* const MENU_FALLBACK = "screen main\nentry Play = play\nentry Quit = quit\n";
+
+//Text colors
+const SDL_Color MENU_TEXT_COLOR = { 138, 138, 138, 0xFF };
+const SDL_Color MENU_SELECTED_COLOR = { 255, 255, 0, 0xFF };
+const SDL_Color MENU_TITLE_COLOR = { 0x40, 0x40, 0x40, 0xFF };
+
+//Vertical distance between entries and between the title and the first entry, in pixels
+const int MENU_ENTRY_SPACING = 25;
+const int MENU_TITLE_GAP = 20;
+
+//Screens deep the menu can be opened
+const int MENU_MAX_DEPTH = 8;
+
+//What activating an entry does
+enum MenuCommand
+{
+	MENU_COMMAND_NONE,
+	MENU_COMMAND_OPEN,
+	MENU_COMMAND_BACK,
+	MENU_COMMAND_PLAY,
+	MENU_COMMAND_QUIT
+};
+
+//Retained menu tree read from a config file
+//Screens and entries are laid out once when the font arrives, and selection only touches the colors of the two entries it moves between
+//Everything renders from the glyph cache, so entries cost neither textures nor allocations after loading
+class LMenu
+{
+public:
+	//Initializes variables
+	LMenu();
+
+	//Reads screens and entries from the archive, or from disk when it was not packed
+	bool load(const std::string& path);
+
+	//Reads screens and entries from text, name is only used in error messages
+	//Lines are "screen id [title]" followed by that screen's "entry label = command [screen id]"
+	//Commands are open, back, play and quit, the first screen is where the menu starts
+	bool loadFromMemory(const char* text, size_t length, const char* name);
+
+	//Positions every entry of every screen centered on an area, needs the glyph cache loaded
+	void layout(int width, int height);
+
+	//Goes back to the first entry of the first screen
+	void reset();
+
+	//Moves the selection or opens and closes screens, gets what main has to act on (play or quit)
+	MenuCommand handleKey(SDL_Keycode key);
+
+	//Changes whenever what the menu shows changes, lets renderers cache it
+	Uint32 getVersion() const;
+
+	//Queues the current screen into the frame batch
+	void render() const;
+
+private:
+	//One selectable line
+	struct LMenuEntry
+	{
+		std::string label;
+		MenuCommand command;
+
+		//Screen id an open command goes to, resolved to an index after loading
+		std::string targetName;
+		int target;
+
+		//Layout and current color
+		SDL_Point position;
+		SDL_Color color;
+	};
+
+	//One page of entries, its entries are contiguous
+	struct LMenuScreen
+	{
+		std::string name;
+		std::string title;
+		int firstEntry;
+		int entryCount;
+		int selected;
+		SDL_Point titlePosition;
+	};
+
+	//Moves the selection of the current screen and recolors the two entries involved
+	void select(int index);
+
+	//Screen on top of the stack
+	LMenuScreen& current();
+	const LMenuScreen& current() const;
+
+	//Every screen and entry
+	std::vector<LMenuScreen> mScreens;
+	std::vector<LMenuEntry> mEntries;
+
+	//Open screens, the first is the root
+	int mStack[MENU_MAX_DEPTH];
+	int mDepth;
+
+	//Bumped by anything visible
+	Uint32 mVersion;
+};
+
+//Main menu
+extern LMenu gMenu;
@@ -0,0 +1,254 @@
+/* Headers */
+#include "Particles.h"
+#include "SpriteBatch.h"
+#include <math.h>
+#include <new>
+#include <stdio.h>
+
+
+
+//Debris of cleared lines
+LParticleSystem gLineClearParticles;
+
+//Dust kicked up where hard dropped pieces land
+LParticleSystem gDropParticles;
+
+LParticleSystem::LParticleSystem()
+{
+	//Initialize
+	mX = NULL;
+	mY = NULL;
+	mVelocityX = NULL;
+	mVelocityY = NULL;
+	mLife = NULL;
+	mInverseLifetime = NULL;
+	mSize = NULL;
+	mColor = NULL;
+	mCount = 0;
+	mCapacity = 0;
+	mVertices = NULL;
+	mTexture = NULL;
+	mUV0.x = 0.0f;
+	mUV0.y = 0.0f;
+	mUV1.x = 1.0f;
+	mUV1.y = 1.0f;
+	mBlendMode = SDL_BLENDMODE_BLEND;
+	mGravity = 0.0f;
+	mDrag = 1.0f;
+	mRandom = 0x9E3779B9;
+}
+
+LParticleSystem::~LParticleSystem()
+{
+	//Deallocate
+	free();
+}
+
+bool LParticleSystem::init(int capacity)
+{
+	//Get rid of preexisting arrays
+	free();
+
+	mX = new (std::nothrow) float[capacity];
+	mY = new (std::nothrow) float[capacity];
+	mVelocityX = new (std::nothrow) float[capacity];
+	mVelocityY = new (std::nothrow) float[capacity];
+	mLife = new (std::nothrow) float[capacity];
+	mInverseLifetime = new (std::nothrow) float[capacity];
+	mSize = new (std::nothrow) float[capacity];
+	mColor = new (std::nothrow) SDL_Color[capacity];
+	mVertices = new (std::nothrow) SDL_Vertex[capacity * 4];
+	if (mX == NULL || mY == NULL || mVelocityX == NULL || mVelocityY == NULL || mLife == NULL || mInverseLifetime == NULL ||
+		mSize == NULL || mColor == NULL || mVertices == NULL)
+	{
+		printf("Unable to allocate %d particles!\n", capacity);
+		free();
+		return false;
+	}
+	mCapacity = capacity;
+	return true;
+}
+
+void LParticleSystem::free()
+{
+	delete[] mX;
+	delete[] mY;
+	delete[] mVelocityX;
+	delete[] mVelocityY;
+	delete[] mLife;
+	delete[] mInverseLifetime;
+	delete[] mSize;
+	delete[] mColor;
+	delete[] mVertices;
+	mX = NULL;
+	mY = NULL;
+	mVelocityX = NULL;
+	mVelocityY = NULL;
+	mLife = NULL;
+	mInverseLifetime = NULL;
+	mSize = NULL;
+	mColor = NULL;
+	mVertices = NULL;
+	mCount = 0;
+	mCapacity = 0;
+}
+
+void LParticleSystem::setTexture(SDL_Texture* texture, const SDL_Rect* region)
+{
+	mTexture = texture;
+	mUV0.x = 0.0f;
+	mUV0.y = 0.0f;
+	mUV1.x = 1.0f;
+	mUV1.y = 1.0f;
+	if (texture != NULL && region != NULL)
+	{
+		int width = 0;
+		int height = 0;
+		SDL_QueryTexture(texture, NULL, NULL, &width, &height);
+		if (width > 0 && height > 0)
+		{
+			mUV0.x = (float)region->x / width;
+			mUV0.y = (float)region->y / height;
+			mUV1.x = (float)(region->x + region->w) / width;
+			mUV1.y = (float)(region->y + region->h) / height;
+		}
+	}
+}
+
+void LParticleSystem::setPhysics(float gravity, float drag)
+{
+	mGravity = gravity;
+	mDrag = drag;
+}
+
+void LParticleSystem::setBlendMode(SDL_BlendMode blendMode)
+{
+	mBlendMode = blendMode;
+}
+
+bool LParticleSystem::emit(float x, float y, float vx, float vy, float lifetime, float size, SDL_Color color)
+{
+	if (mCount == mCapacity || lifetime <= 0.0f)
+	{
+		return false;
+	}
+
+	int i = mCount++;
+	mX[i] = x;
+	mY[i] = y;
+	mVelocityX[i] = vx;
+	mVelocityY[i] = vy;
+	mLife[i] = lifetime;
+	mInverseLifetime[i] = 1.0f / lifetime;
+	mSize[i] = size;
+	mColor[i] = color;
+	return true;
+}
+
+float LParticleSystem::random(float min, float max)
+{
+	mRandom ^= mRandom << 13;
+	mRandom ^= mRandom >> 17;
+	mRandom ^= mRandom << 5;
+	return min + (max - min) * (float)(mRandom >> 8) * (1.0f / 16777216.0f);
+}
+
+void LParticleSystem::update(float seconds)
+{
+	//Local pointers and no branches, so each loop turns into vector code
+	float* x = mX;
+	float* y = mY;
+	float* vx = mVelocityX;
+	float* vy = mVelocityY;
+	float* life = mLife;
+	int count = mCount;
+	float damping = powf(mDrag, seconds);
+	float fall = mGravity * seconds;
+	for (int i = 0; i < count; ++i)
+	{
+		vx[i] *= damping;
+		x[i] += vx[i] * seconds;
+	}
+	for (int i = 0; i < count; ++i)
+	{
+		vy[i] = vy[i] * damping + fall;
+		y[i] += vy[i] * seconds;
+	}
+	for (int i = 0; i < count; ++i)
+	{
+		life[i] -= seconds;
+	}
+
+	//Keep live ones packed by moving the last particle into each gap, order doesn't matter
+	int i = 0;
+	while (i < mCount)
+	{
+		if (mLife[i] > 0.0f)
+		{
+			++i;
+			continue;
+		}
+		int last = --mCount;
+		mX[i] = mX[last];
+		mY[i] = mY[last];
+		mVelocityX[i] = mVelocityX[last];
+		mVelocityY[i] = mVelocityY[last];
+		mLife[i] = mLife[last];
+		mInverseLifetime[i] = mInverseLifetime[last];
+		mSize[i] = mSize[last];
+		mColor[i] = mColor[last];
+	}
+}
+
+void LParticleSystem::render()
+{
+	if (mCount == 0)
+	{
+		return;
+	}
+
+	//Squares centered on each particle, fading out over their lifetime
+	SDL_Vertex* vertex = mVertices;
+	for (int i = 0; i < mCount; ++i, vertex += 4)
+	{
+		float half = mSize[i] * 0.5f;
+		float left = mX[i] - half;
+		float top = mY[i] - half;
+		float right = mX[i] + half;
+		float bottom = mY[i] + half;
+		float fade = mLife[i] * mInverseLifetime[i];
+		SDL_Color color = mColor[i];
+		color.a = (Uint8)(color.a * (fade < 1.0f ? fade : 1.0f));
+
+		vertex[0].position.x = left;
+		vertex[0].position.y = top;
+		vertex[0].tex_coord = mUV0;
+		vertex[1].position.x = right;
+		vertex[1].position.y = top;
+		vertex[1].tex_coord.x = mUV1.x;
+		vertex[1].tex_coord.y = mUV0.y;
+		vertex[2].position.x = right;
+		vertex[2].position.y = bottom;
+		vertex[2].tex_coord = mUV1;
+		vertex[3].position.x = left;
+		vertex[3].position.y = bottom;
+		vertex[3].tex_coord.x = mUV0.x;
+		vertex[3].tex_coord.y = mUV1.y;
+		vertex[0].color = color;
+		vertex[1].color = color;
+		vertex[2].color = color;
+		vertex[3].color = color;
+	}
+
+	gSpriteBatch.drawQuads(mTexture, mVertices, mCount, mBlendMode);
+}
+
+void LParticleSystem::clear()
+{
+	mCount = 0;
+}
+
+int LParticleSystem::getCount() const
+{
+	return mCount;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+/* Headers */
+//Using SDL render geometry
+#include <SDL.h>
+
+
+
+/* Constants */
+
+//Live particles one system holds, emitting beyond this is dropped
+const int PARTICLE_CAPACITY = 65536;
+
+//Short lived quads that fly, fall and fade, one system per texture and one batch submission per frame
+//Particles are kept as separate arrays per field, the update is a few flat loops the compiler vectorizes
+class LParticleSystem
+{
+public:
+	//Initializes variables
+	LParticleSystem();
+
+	//Deallocates the arrays
+	~LParticleSystem();
+
+	//Allocates every array up front, the only allocation the system makes
+	bool init(int capacity);
+
+	//Deallocates the arrays
+	void free();
+
+	//Sets what every particle draws, NULL for solid quads, region in texels and NULL for the whole texture
+	void setTexture(SDL_Texture* texture, const SDL_Rect* region);
+
+	//Sets acceleration in pixels per second squared and the fraction of speed kept each second
+	void setPhysics(float gravity, float drag);
+
+	//Sets how particles are blended
+	void setBlendMode(SDL_BlendMode blendMode);
+
+	//Adds a particle in pixels, pixels per second and seconds, false when full
+	bool emit(float x, float y, float vx, float vy, float lifetime, float size, SDL_Color color);
+
+	//Gets a uniformly distributed number for emitters
+	float random(float min, float max);
+
+	//Moves every particle and drops the ones that ran out
+	void update(float seconds);
+
+	//Builds the vertices and queues them as one submission on the frame batch
+	void render();
+
+	//Drops every particle
+	void clear();
+
+	//Gets how many particles are alive
+	int getCount() const;
+
+private:
+	//Particle fields, index i of each array is particle i, live ones packed at the front
+	float* mX;
+	float* mY;
+	float* mVelocityX;
+	float* mVelocityY;
+	float* mLife;
+	float* mInverseLifetime;
+	float* mSize;
+	SDL_Color* mColor;
+	int mCount;
+	int mCapacity;
+
+	//Four vertices per particle, rebuilt by every render()
+	SDL_Vertex* mVertices;
+
+	//Look
+	SDL_Texture* mTexture;
+	SDL_FPoint mUV0;
+	SDL_FPoint mUV1;
+	SDL_BlendMode mBlendMode;
+
+	//Motion
+	float mGravity;
+	float mDrag;
+
+	//Emitter randomness
+	Uint32 mRandom;
+};
+
+//Debris of cleared lines
+extern LParticleSystem gLineClearParticles;
+
+//Dust kicked up where hard dropped pieces land
+extern LParticleSystem gDropParticles;
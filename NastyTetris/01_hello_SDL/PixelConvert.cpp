@@ -0,0 +1,153 @@
+/* Headers */
+#include "PixelConvert.h"
+
+//x86 builds carry the vector kernel, everything else only the scalar one
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PIXEL_X86 1
+#include <emmintrin.h>
+#endif
+
+//GCC and Clang only emit instructions a function is marked for, MSVC takes intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_SSE2_FUNCTION __attribute__((target("sse2")))
+#else
+#define PIXEL_SSE2_FUNCTION
+#endif
+
+
+
+//Works on bytes, so it gives the same result on any byte order
+static void convertScalar(const Uint32* source, Uint32* destination, int count, bool swapRedBlue, bool premultiply)
+{
+	const Uint8* in = (const Uint8*)source;
+	Uint8* out = (Uint8*)destination;
+	for (int i = 0; i < count; ++i, in += 4, out += 4)
+	{
+		Uint8 red = in[0];
+		Uint8 green = in[1];
+		Uint8 blue = in[2];
+		Uint8 alpha = in[3];
+		if (red == PIXEL_KEY_RED && green == PIXEL_KEY_GREEN && blue == PIXEL_KEY_BLUE)
+		{
+			red = green = blue = alpha = 0;
+		}
+		else if (premultiply)
+		{
+			//c * a / 255 rounded, without a division
+			Uint32 t = red * alpha + 128;
+			red = (Uint8)((t + (t >> 8)) >> 8);
+			t = green * alpha + 128;
+			green = (Uint8)((t + (t >> 8)) >> 8);
+			t = blue * alpha + 128;
+			blue = (Uint8)((t + (t >> 8)) >> 8);
+		}
+		out[0] = swapRedBlue ? blue : red;
+		out[1] = green;
+		out[2] = swapRedBlue ? red : blue;
+		out[3] = alpha;
+	}
+}
+
+#ifdef PIXEL_X86
+//Color channels times alpha of eight 16 bit channels, two pixels, rounded like the scalar kernel
+PIXEL_SSE2_FUNCTION static inline __m128i premultiplySSE2(__m128i channels)
+{
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(channels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, alpha), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+//Four pixels per step, x86 is little endian so RGBA32 pixels read as 0xAABBGGRR
+PIXEL_SSE2_FUNCTION static void convertSSE2(const Uint32* source, Uint32* destination, int count, bool swapRedBlue, bool premultiply)
+{
+	const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+	const __m128i key = _mm_set1_epi32((PIXEL_KEY_BLUE << 16) | (PIXEL_KEY_GREEN << 8) | PIXEL_KEY_RED);
+	const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+	const __m128i greenAlphaMask = _mm_set1_epi32((int)0xFF00FF00);
+	const __m128i lowMask = _mm_set1_epi32(0x000000FF);
+	const __m128i zero = _mm_setzero_si128();
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128((const __m128i*)(source + i));
+
+		//Key color, whatever its alpha, becomes zero
+		__m128i keyed = _mm_cmpeq_epi32(_mm_and_si128(pixels, colorMask), key);
+		pixels = _mm_andnot_si128(keyed, pixels);
+
+		if (premultiply)
+		{
+			__m128i low = premultiplySSE2(_mm_unpacklo_epi8(pixels, zero));
+			__m128i high = premultiplySSE2(_mm_unpackhi_epi8(pixels, zero));
+			__m128i scaled = _mm_packus_epi16(low, high);
+
+			//Alpha was multiplied by itself above, put the original back
+			pixels = _mm_or_si128(_mm_andnot_si128(alphaMask, scaled), _mm_and_si128(pixels, alphaMask));
+		}
+
+		if (swapRedBlue)
+		{
+			__m128i red = _mm_and_si128(pixels, lowMask);
+			__m128i blue = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowMask);
+			pixels = _mm_or_si128(_mm_and_si128(pixels, greenAlphaMask), _mm_or_si128(_mm_slli_epi32(red, 16), blue));
+		}
+		_mm_storeu_si128((__m128i*)(destination + i), pixels);
+	}
+
+	//Leftover pixels
+	convertScalar(source + i, destination + i, count - i, swapRedBlue, premultiply);
+}
+#endif
+
+void convertPixels(const Uint32* source, Uint32* destination, int count, Uint32 format, bool premultiply, PixelKernel kernel)
+{
+	bool swapRedBlue = format == SDL_PIXELFORMAT_BGRA32;
+	switch (kernel)
+	{
+#ifdef PIXEL_X86
+	case PIXEL_KERNEL_SSE2:
+		convertSSE2(source, destination, count, swapRedBlue, premultiply);
+		break;
+#endif
+
+	default:
+		convertScalar(source, destination, count, swapRedBlue, premultiply);
+		break;
+	}
+}
+
+void convertPixels(const Uint32* source, Uint32* destination, int count, Uint32 format, bool premultiply)
+{
+	convertPixels(source, destination, count, format, premultiply, getBestPixelKernel());
+}
+
+bool isPixelKernelSupported(PixelKernel kernel)
+{
+	switch (kernel)
+	{
+	case PIXEL_KERNEL_SCALAR:
+		return true;
+
+#ifdef PIXEL_X86
+	case PIXEL_KERNEL_SSE2:
+		return SDL_HasSSE2() == SDL_TRUE;
+#endif
+
+	default:
+		return false;
+	}
+}
+
+PixelKernel getBestPixelKernel()
+{
+	//CPU features don't change while running, ask once
+	static const PixelKernel best = isPixelKernelSupported(PIXEL_KERNEL_SSE2) ? PIXEL_KERNEL_SSE2 : PIXEL_KERNEL_SCALAR;
+	return best;
+}
+
+const char* getPixelKernelName(PixelKernel kernel)
+{
+	static const char* const names[PIXEL_KERNEL_TOTAL] = { "scalar", "SSE2" };
+	return kernel >= 0 && kernel < PIXEL_KERNEL_TOTAL ? names[kernel] : "unknown";
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+/* Headers */
+//Using SDL pixel formats and CPU detection
+#include <SDL.h>
+
+
+
+/* Constants */
+
+//Color images are keyed with, cyan
+const Uint8 PIXEL_KEY_RED = 0x00;
+const Uint8 PIXEL_KEY_GREEN = 0xFF;
+const Uint8 PIXEL_KEY_BLUE = 0xFF;
+
+//Kernels, every one gives exactly the same pixels
+enum PixelKernel
+{
+	PIXEL_KERNEL_SCALAR,
+	PIXEL_KERNEL_SSE2,
+	PIXEL_KERNEL_TOTAL
+};
+
+//Converts RGBA32 pixels to RGBA32 or BGRA32, the byte orders textures take
+//Pixels of the key color become transparent black, premultiply scales color by alpha rounding to nearest
+//Source and destination may be the same, the kernel must be supported
+void convertPixels(const Uint32* source, Uint32* destination, int count, Uint32 format, bool premultiply, PixelKernel kernel);
+
+//Converts with the fastest kernel the CPU runs
+void convertPixels(const Uint32* source, Uint32* destination, int count, Uint32 format, bool premultiply);
+
+//Checks whether this build and CPU can run a kernel
+bool isPixelKernelSupported(PixelKernel kernel);
+
+//Gets the kernel convertPixels() picks
+PixelKernel getBestPixelKernel();
+
+//Gets a kernel's name for logs
+const char* getPixelKernelName(PixelKernel kernel);
@@ -0,0 +1,321 @@
+/* Headers */
+#include "Profiler.h"
+#include "SpriteBatch.h"
+#include "GlyphCache.h"
+#include "Memory.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+
+
+//Frame time the graph is scaled to, bars reach the top at this many milliseconds
+const double PROFILER_GRAPH_MS = 33.3;
+const int PROFILER_GRAPH_HEIGHT = 60;
+
+//Weight of the newest frame in the smoothed zone times
+const double PROFILER_ZONE_SMOOTHING = 0.05;
+
+//Overlay colors
+const SDL_Color PROFILER_BACK_COLOR = { 0x00, 0x00, 0x00, 0xA0 };
+const SDL_Color PROFILER_BAR_COLOR = { 0x40, 0xD0, 0x40, 0xFF };
+const SDL_Color PROFILER_SLOW_BAR_COLOR = { 0xE0, 0x40, 0x40, 0xFF };
+const SDL_Color PROFILER_LINE_COLOR = { 0xFF, 0xFF, 0xFF, 0x80 };
+const SDL_Color PROFILER_TEXT_COLOR = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+//Profiler for the whole game
+LProfiler gProfiler;
+
+LProfiler::LProfiler()
+{
+	//Initialize
+	for (int i = 0; i < PROFILER_EVENT_CAPACITY; ++i)
+	{
+		mSlots[i].sequence.store(0, std::memory_order_relaxed);
+	}
+	mWrite.store(0, std::memory_order_relaxed);
+	mRead = 0;
+	mMainThread = SDL_ThreadID();
+	memset(mFrameMs, 0, sizeof(mFrameMs));
+	mFrameIndex = 0;
+	mFrameCount = 0;
+	mFrameStart = 0;
+	mFrameAllocations = 0;
+	mAllocationCount = 0;
+	mZoneCount = 0;
+	mOverlay = false;
+}
+
+Uint64 LProfiler::now()
+{
+	return SDL_GetPerformanceCounter();
+}
+
+void LProfiler::record(const char* name, Uint64 start, Uint64 end)
+{
+	//Claim a slot, writers never wait on each other or on readers
+	Uint32 index = mWrite.fetch_add(1, std::memory_order_relaxed);
+	LProfileSlot& slot = mSlots[index & (PROFILER_EVENT_CAPACITY - 1)];
+
+	//Readers skip the slot while it is half written
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.start.store(start, std::memory_order_relaxed);
+	slot.end.store(end, std::memory_order_relaxed);
+	slot.thread.store(SDL_ThreadID(), std::memory_order_relaxed);
+	slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool LProfiler::readSlot(Uint32 index, LProfileEvent* event) const
+{
+	const LProfileSlot& slot = mSlots[index & (PROFILER_EVENT_CAPACITY - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+	{
+		return false;
+	}
+	event->name = slot.name.load(std::memory_order_relaxed);
+	event->start = slot.start.load(std::memory_order_relaxed);
+	event->end = slot.end.load(std::memory_order_relaxed);
+	event->thread = slot.thread.load(std::memory_order_relaxed);
+
+	//Make sure no writer came by while copying
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+void LProfiler::endFrame()
+{
+	Uint64 frameEnd = now();
+	if (mFrameStart != 0)
+	{
+		mFrameMs[mFrameIndex] = (double)(frameEnd - mFrameStart) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+		mFrameIndex = (mFrameIndex + 1) % PROFILER_FRAME_HISTORY;
+		if (mFrameCount < PROFILER_FRAME_HISTORY)
+		{
+			++mFrameCount;
+		}
+	}
+	mFrameStart = frameEnd;
+
+	//Every thread's allocations count, steady state should show none at all
+	Uint64 allocations = getAllocationCount();
+	mFrameAllocations = mAllocationCount != 0 ? (int)(allocations - mAllocationCount) : 0;
+	mAllocationCount = allocations;
+
+	//Sum this frame's main thread zones by name
+	double frameZoneMs[PROFILER_MAX_ZONES] = { 0 };
+	Uint32 write = mWrite.load(std::memory_order_acquire);
+	if (write - mRead > (Uint32)PROFILER_EVENT_CAPACITY)
+	{
+		mRead = write - PROFILER_EVENT_CAPACITY;
+	}
+	for (; mRead != write; ++mRead)
+	{
+		LProfileEvent event;
+		if (!readSlot(mRead, &event) || event.thread != mMainThread)
+		{
+			continue;
+		}
+
+		int zone = 0;
+		while (zone < mZoneCount && mZoneNames[zone] != event.name)
+		{
+			++zone;
+		}
+		if (zone == mZoneCount)
+		{
+			if (mZoneCount == PROFILER_MAX_ZONES)
+			{
+				continue;
+			}
+			mZoneNames[mZoneCount] = event.name;
+			mZoneMs[mZoneCount] = 0.0;
+			++mZoneCount;
+		}
+		frameZoneMs[zone] += (double)(event.end - event.start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+	}
+
+	for (int i = 0; i < mZoneCount; ++i)
+	{
+		mZoneMs[i] += (frameZoneMs[i] - mZoneMs[i]) * PROFILER_ZONE_SMOOTHING;
+	}
+}
+
+double LProfiler::getFrameMs() const
+{
+	if (mFrameCount == 0)
+	{
+		return 0.0;
+	}
+	return mFrameMs[(mFrameIndex + PROFILER_FRAME_HISTORY - 1) % PROFILER_FRAME_HISTORY];
+}
+
+int LProfiler::getFrameAllocations() const
+{
+	return mFrameAllocations;
+}
+
+float LProfiler::getFps() const
+{
+	//Average over the whole history so the number stays readable
+	double total = 0.0;
+	for (int i = 0; i < mFrameCount; ++i)
+	{
+		total += mFrameMs[i];
+	}
+	if (total <= 0.0)
+	{
+		return 0.f;
+	}
+	return (float)(mFrameCount * 1000.0 / total);
+}
+
+void LProfiler::getPercentiles(double* p50, double* p99) const
+{
+	*p50 = 0.0;
+	*p99 = 0.0;
+	if (mFrameCount == 0)
+	{
+		return;
+	}
+
+	double sorted[PROFILER_FRAME_HISTORY];
+	memcpy(sorted, mFrameMs, sizeof(double) * mFrameCount);
+	std::sort(sorted, sorted + mFrameCount);
+	*p50 = sorted[(mFrameCount - 1) * 50 / 100];
+	*p99 = sorted[(mFrameCount - 1) * 99 / 100];
+}
+
+void LProfiler::toggleOverlay()
+{
+	mOverlay = !mOverlay;
+}
+
+bool LProfiler::isOverlayVisible() const
+{
+	return mOverlay;
+}
+
+void LProfiler::renderOverlay(int x, int y) const
+{
+	gSpriteBatch.setLayer(10);
+
+	//Backdrop behind graph and text
+	int lineHeight = gGlyphCache.getLineHeight();
+	SDL_Rect back = { x, y, PROFILER_FRAME_HISTORY, PROFILER_GRAPH_HEIGHT + lineHeight * (3 + mZoneCount) + 4 };
+	gSpriteBatch.fillRect(back, PROFILER_BACK_COLOR);
+
+	//One bar per frame, oldest on the left, frames over the 60 Hz budget in red
+	int oldest = mFrameCount < PROFILER_FRAME_HISTORY ? 0 : mFrameIndex;
+	for (int i = 0; i < mFrameCount; ++i)
+	{
+		double ms = mFrameMs[(oldest + i) % PROFILER_FRAME_HISTORY];
+		int height = (int)(ms * PROFILER_GRAPH_HEIGHT / PROFILER_GRAPH_MS);
+		if (height > PROFILER_GRAPH_HEIGHT)
+		{
+			height = PROFILER_GRAPH_HEIGHT;
+		}
+		SDL_Rect bar = { x + i, y + PROFILER_GRAPH_HEIGHT - height, 1, height };
+		gSpriteBatch.fillRect(bar, ms > 1000.0 / 60.0 + 0.5 ? PROFILER_SLOW_BAR_COLOR : PROFILER_BAR_COLOR);
+	}
+
+	//60 Hz budget line
+	SDL_Rect budget = { x, y + PROFILER_GRAPH_HEIGHT - (int)(1000.0 / 60.0 * PROFILER_GRAPH_HEIGHT / PROFILER_GRAPH_MS), PROFILER_FRAME_HISTORY, 1 };
+	gSpriteBatch.fillRect(budget, PROFILER_LINE_COLOR);
+
+	//Numbers
+	char text[64];
+	int penY = y + PROFILER_GRAPH_HEIGHT + 2;
+	SDL_snprintf(text, sizeof(text), "%.0f FPS %.1f ms", getFps(), getFrameMs());
+	gGlyphCache.render(x + 2, penY, text, PROFILER_TEXT_COLOR);
+	penY += lineHeight;
+
+	double p50 = 0.0;
+	double p99 = 0.0;
+	getPercentiles(&p50, &p99);
+	SDL_snprintf(text, sizeof(text), "p50 %.1f p99 %.1f", p50, p99);
+	gGlyphCache.render(x + 2, penY, text, PROFILER_TEXT_COLOR);
+	penY += lineHeight;
+
+	SDL_snprintf(text, sizeof(text), "allocs %d arena %u/%u", mFrameAllocations, (unsigned int)gFrameArena.getUsed(), (unsigned int)gFrameArena.getPeak());
+	gGlyphCache.render(x + 2, penY, text, PROFILER_TEXT_COLOR);
+	penY += lineHeight;
+
+	for (int i = 0; i < mZoneCount; ++i)
+	{
+		SDL_snprintf(text, sizeof(text), "%s %.2f", mZoneNames[i], mZoneMs[i]);
+		gGlyphCache.render(x + 2, penY, text, PROFILER_TEXT_COLOR);
+		penY += lineHeight;
+	}
+}
+
+bool LProfiler::dumpChromeTrace(const char* path) const
+{
+	SDL_RWops* file = SDL_RWFromFile(path, "wb");
+	if (file == NULL)
+	{
+		printf("Unable to write trace %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+
+	//Everything still in the ring, timestamps in microseconds from the earliest start
+	//Zones are recorded when they end, so nested ones come before their parents
+	Uint32 write = mWrite.load(std::memory_order_acquire);
+	Uint32 first = write > (Uint32)PROFILER_EVENT_CAPACITY ? write - PROFILER_EVENT_CAPACITY : 0;
+	double toMicroseconds = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+	Uint64 origin = 0;
+	for (Uint32 index = first; index != write; ++index)
+	{
+		LProfileEvent event;
+		if (readSlot(index, &event) && (origin == 0 || event.start < origin))
+		{
+			origin = event.start;
+		}
+	}
+
+	const char* header = "{\"traceEvents\":[\n";
+	SDL_RWwrite(file, header, 1, strlen(header));
+	int written = 0;
+	for (Uint32 index = first; index != write; ++index)
+	{
+		LProfileEvent event;
+		if (!readSlot(index, &event) || event.start < origin)
+		{
+			continue;
+		}
+
+		char line[256];
+		int length = SDL_snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+			written > 0 ? ",\n" : "", event.name, (unsigned long)event.thread,
+			(double)(event.start - origin) * toMicroseconds, (double)(event.end - event.start) * toMicroseconds);
+		SDL_RWwrite(file, line, 1, length < (int)sizeof(line) ? length : sizeof(line) - 1);
+		++written;
+	}
+	const char* footer = "\n]}\n";
+	SDL_RWwrite(file, footer, 1, strlen(footer));
+	SDL_RWclose(file);
+
+	printf("Wrote %d profiler events to %s\n", written, path);
+	return true;
+}
+
+LProfileZone::LProfileZone(const char* name)
+{
+	mName = name;
+	mStart = LProfiler::now();
+}
+
+LProfileZone::~LProfileZone()
+{
+	end();
+}
+
+void LProfileZone::end()
+{
+	if (mName != NULL)
+	{
+		gProfiler.record(mName, mStart, LProfiler::now());
+		mName = NULL;
+	}
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+/* Headers */
+//Using SDL timers and threads, STL atomic
+#include <SDL.h>
+#include <atomic>
+
+
+
+/* Constants */
+
+//Zone events kept for the trace dump, a power of two
+const int PROFILER_EVENT_CAPACITY = 1 << 15;
+
+//Frames kept for the graph and the percentiles
+const int PROFILER_FRAME_HISTORY = 240;
+
+//Distinct zone names the overlay breaks a frame into
+const int PROFILER_MAX_ZONES = 16;
+
+//Default trace file, next to the assets directory
+const char* const PROFILER_TRACE_PATH = "profile.json";
+
+//One timed span of work
+struct LProfileEvent
+{
+	const char* name;
+	Uint64 start;
+	Uint64 end;
+	SDL_threadID thread;
+};
+
+//Records zones from any thread into a lock-free ring and keeps frame statistics for the main thread
+class LProfiler
+{
+public:
+	//Initializes variables
+	LProfiler();
+
+	//Gets the high resolution clock zones are measured with
+	static Uint64 now();
+
+	//Records a finished zone, name must stay valid for the whole run
+	void record(const char* name, Uint64 start, Uint64 end);
+
+	//Closes the current frame, main thread only
+	void endFrame();
+
+	//Gets frame statistics
+	float getFps() const;
+	double getFrameMs() const;
+	int getFrameAllocations() const;
+	void getPercentiles(double* p50, double* p99) const;
+
+	//Shows or hides the overlay
+	void toggleOverlay();
+	bool isOverlayVisible() const;
+
+	//Queues the frame graph and zone times into the frame batch
+	void renderOverlay(int x, int y) const;
+
+	//Writes the recorded zones as a Chrome trace (chrome://tracing, Perfetto)
+	bool dumpChromeTrace(const char* path) const;
+
+private:
+	//Ring slot, sequence is the event index plus one once the event is complete
+	//Fields are relaxed atomics so a reader racing a writer sees a torn event, never undefined behavior
+	struct LProfileSlot
+	{
+		std::atomic<Uint32> sequence;
+		std::atomic<const char*> name;
+		std::atomic<Uint64> start;
+		std::atomic<Uint64> end;
+		std::atomic<SDL_threadID> thread;
+	};
+
+	//Reads a slot, false if it is being written or was overwritten
+	bool readSlot(Uint32 index, LProfileEvent* event) const;
+
+	//Zone events, written by any thread
+	LProfileSlot mSlots[PROFILER_EVENT_CAPACITY];
+	std::atomic<Uint32> mWrite;
+
+	//First event endFrame() has not looked at
+	Uint32 mRead;
+
+	//Main thread, zones are only summed for it
+	SDL_threadID mMainThread;
+
+	//Frame times in milliseconds, oldest overwritten first
+	double mFrameMs[PROFILER_FRAME_HISTORY];
+	int mFrameIndex;
+	int mFrameCount;
+	Uint64 mFrameStart;
+
+	//Allocation calls during the last frame, and the count it started from
+	int mFrameAllocations;
+	Uint64 mAllocationCount;
+
+	//Smoothed milliseconds per frame spent in each zone
+	const char* mZoneNames[PROFILER_MAX_ZONES];
+	double mZoneMs[PROFILER_MAX_ZONES];
+	int mZoneCount;
+
+	//Overlay switch
+	bool mOverlay;
+};
+
+//Times a scope, or up to end() when the zone should close early
+class LProfileZone
+{
+public:
+	//Starts timing
+	explicit LProfileZone(const char* name);
+
+	//Records the zone if end() was not called
+	~LProfileZone();
+
+	//Records the zone now
+	void end();
+
+private:
+	const char* mName;
+	Uint64 mStart;
+};
+
+//Profiler for the whole game
+extern LProfiler gProfiler;
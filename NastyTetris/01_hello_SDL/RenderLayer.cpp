@@ -0,0 +1,93 @@
+/* Headers */
+#include "RenderLayer.h"
+#include "LTexture.h"
+#include "SpriteBatch.h"
+#include <stdio.h>
+
+
+
+LRenderLayer::LRenderLayer()
+{
+	//Initialize
+	mTexture = NULL;
+	mWidth = 0;
+	mHeight = 0;
+	mVersion = 0;
+	mValid = false;
+}
+
+LRenderLayer::~LRenderLayer()
+{
+	//Deallocate
+	free();
+}
+
+bool LRenderLayer::create(int width, int height)
+{
+	//Get rid of preexisting texture
+	free();
+
+	mTexture = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+	if (mTexture == NULL)
+	{
+		printf("Unable to create layer texture! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	mWidth = width;
+	mHeight = height;
+	return true;
+}
+
+void LRenderLayer::free()
+{
+	if (mTexture != NULL)
+	{
+		SDL_DestroyTexture(mTexture);
+		mTexture = NULL;
+		mWidth = 0;
+		mHeight = 0;
+	}
+	mValid = false;
+}
+
+void LRenderLayer::invalidate()
+{
+	mValid = false;
+}
+
+bool LRenderLayer::needsRedraw(Uint32 version) const
+{
+	return !mValid || mVersion != version;
+}
+
+bool LRenderLayer::begin(SDL_Color background)
+{
+	if (mTexture == NULL || SDL_SetRenderTarget(gRenderer, mTexture) != 0)
+	{
+		return false;
+	}
+
+	SDL_SetRenderDrawColor(gRenderer, background.r, background.g, background.b, background.a);
+	SDL_RenderClear(gRenderer);
+
+	gSpriteBatch.begin();
+	return true;
+}
+
+void LRenderLayer::end(Uint32 version)
+{
+	gSpriteBatch.flush();
+	SDL_SetRenderTarget(gRenderer, NULL);
+
+	mVersion = version;
+	mValid = true;
+}
+
+void LRenderLayer::render(int x, int y) const
+{
+	//Layers hold the opaque background, copying replaces the screen clear
+	SDL_FRect destination = { (float)x, (float)y, (float)mWidth, (float)mHeight };
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	gSpriteBatch.draw(mTexture, NULL, destination, white, SDL_BLENDMODE_NONE);
+}
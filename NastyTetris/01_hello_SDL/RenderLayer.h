@@ -0,0 +1,49 @@
+#pragma once
+
+/* Headers */
+//Using SDL
+#include <SDL.h>
+
+
+
+//Caches content that rarely changes in a target texture, redrawn only when its version changes
+class LRenderLayer
+{
+public:
+	//Initializes variables
+	LRenderLayer();
+
+	//Deallocates memory
+	~LRenderLayer();
+
+	//Creates the target texture
+	bool create(int width, int height);
+
+	//Deallocates texture
+	void free();
+
+	//Forces a redraw, needed when the renderer lost its targets
+	void invalidate();
+
+	//Checks whether the cached content is older than the given version
+	bool needsRedraw(Uint32 version) const;
+
+	//Points rendering at the layer, fills it with the background and starts a batch for the content
+	bool begin(SDL_Color background);
+
+	//Submits the batch into the layer, points rendering back at the window and remembers the version
+	void end(Uint32 version);
+
+	//Queues the cached content at the given point into the frame batch
+	void render(int x, int y) const;
+
+private:
+	//Target texture
+	SDL_Texture* mTexture;
+	int mWidth;
+	int mHeight;
+
+	//Version of the content drawn into the texture
+	Uint32 mVersion;
+	bool mValid;
+};
@@ -0,0 +1,252 @@
+/* Headers */
+#include "Replay.h"
+#include <stdio.h>
+
+
+
+//Replay of the game being played
+LReplay gReplay;
+
+LReplay::LReplay()
+{
+	//Initialize
+	mEventCount = 0;
+	mSeed = 0;
+	mTicks = 0;
+	mFinalHash = 0;
+	mRecording = false;
+	mLastActions = ACTION_NONE;
+	mLastEventTick = 0;
+	rewind();
+}
+
+void LReplay::beginRecording(Uint32 seed)
+{
+	//Keeps the capacity of earlier games, recording only allocates again past the reserve
+	mStream.clear();
+	mStream.reserve(REPLAY_RESERVE_BYTES);
+	mEventCount = 0;
+	mSeed = seed;
+	mTicks = 0;
+	mFinalHash = 0;
+	mRecording = true;
+	mLastActions = ACTION_NONE;
+	mLastEventTick = 0;
+	rewind();
+}
+
+bool LReplay::isRecording() const
+{
+	return mRecording;
+}
+
+void LReplay::record(Uint32 actions)
+{
+	if (!mRecording)
+	{
+		return;
+	}
+
+	//Held actions repeat, so most ticks store nothing
+	if (actions != mLastActions)
+	{
+		writeVarint(mTicks - mLastEventTick);
+		mStream.push_back((Uint8)actions);
+		++mEventCount;
+		mLastActions = actions;
+		mLastEventTick = mTicks;
+	}
+	++mTicks;
+}
+
+void LReplay::writeVarint(Uint64 value)
+{
+	//Seven bits per byte, high bit set while more follow
+	while (value >= 0x80)
+	{
+		mStream.push_back((Uint8)(value | 0x80));
+		value >>= 7;
+	}
+	mStream.push_back((Uint8)value);
+}
+
+bool LReplay::save(const char* path, const LGame& game)
+{
+	mRecording = false;
+	mFinalHash = game.getStateHash();
+
+	SDL_RWops* file = SDL_RWFromFile(path, "wb");
+	if (file == NULL)
+	{
+		printf("Unable to write replay %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+	LReplayHeader header = { REPLAY_MAGIC, REPLAY_VERSION, mSeed, LOGIC_TICK_RATE, mTicks, mFinalHash, mEventCount, (Uint32)mStream.size() };
+	SDL_RWwrite(file, &header, sizeof(header), 1);
+	if (!mStream.empty())
+	{
+		SDL_RWwrite(file, &mStream[0], 1, mStream.size());
+	}
+	SDL_RWclose(file);
+	return true;
+}
+
+bool LReplay::load(const char* path)
+{
+	mRecording = false;
+	mStream.clear();
+	mEventCount = 0;
+	mTicks = 0;
+
+	SDL_RWops* file = SDL_RWFromFile(path, "rb");
+	if (file == NULL)
+	{
+		printf("Unable to open replay %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+
+	LReplayHeader header;
+	bool success = SDL_RWread(file, &header, sizeof(header), 1) == 1;
+	if (!success || header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION)
+	{
+		printf("%s is not a replay!\n", path);
+		success = false;
+	}
+	else if (header.tickRate != (Uint32)LOGIC_TICK_RATE)
+	{
+		//Every timer is counted in ticks, a different rate is a different game
+		printf("%s was recorded at %u ticks per second, the game runs at %d!\n", path, header.tickRate, LOGIC_TICK_RATE);
+		success = false;
+	}
+	else
+	{
+		mStream.resize(header.streamSize);
+		if (header.streamSize > 0 && SDL_RWread(file, &mStream[0], 1, header.streamSize) != header.streamSize)
+		{
+			printf("Replay %s is truncated!\n", path);
+			success = false;
+		}
+	}
+	SDL_RWclose(file);
+
+	if (!success)
+	{
+		mStream.clear();
+		rewind();
+		return false;
+	}
+
+	mSeed = header.seed;
+	mTicks = header.ticks;
+	mFinalHash = header.finalHash;
+	mEventCount = header.eventCount;
+
+	//Walk the stream once so playback can trust it
+	bool valid = true;
+	Uint32 events = 0;
+	Uint64 tick = 0;
+	size_t offset = 0;
+	while (valid && offset < mStream.size())
+	{
+		Uint64 delta = 0;
+		valid = readVarint(&offset, &delta) && offset < mStream.size();
+		tick += delta;
+		valid = valid && tick < mTicks && (mStream[offset++] & 0x80) == 0;
+		++events;
+	}
+	if (!valid || events != mEventCount)
+	{
+		printf("Replay %s has a corrupt event stream!\n", path);
+		mStream.clear();
+		mTicks = 0;
+		rewind();
+		return false;
+	}
+
+	rewind();
+	return true;
+}
+
+bool LReplay::readVarint(size_t* offset, Uint64* value) const
+{
+	*value = 0;
+	for (int shift = 0; shift < 64 && *offset < mStream.size(); shift += 7)
+	{
+		Uint8 byte = mStream[(*offset)++];
+		*value |= (Uint64)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void LReplay::readEvent(Uint64 previousTick)
+{
+	//load() checked the stream, so running out of bytes means running out of events
+	Uint64 delta = 0;
+	mHasNextEvent = mReadOffset < mStream.size() && readVarint(&mReadOffset, &delta) && mReadOffset < mStream.size();
+	if (mHasNextEvent)
+	{
+		mNextEventTick = previousTick + delta;
+		mNextActions = mStream[mReadOffset++];
+	}
+}
+
+Uint32 LReplay::getSeed() const
+{
+	return mSeed;
+}
+
+Uint64 LReplay::getTickCount() const
+{
+	return mTicks;
+}
+
+Uint64 LReplay::getFinalHash() const
+{
+	return mFinalHash;
+}
+
+Uint32 LReplay::getEventCount() const
+{
+	return mEventCount;
+}
+
+void LReplay::rewind()
+{
+	mReadOffset = 0;
+	mPlayTick = 0;
+	mPlayActions = ACTION_NONE;
+	mNextEventTick = 0;
+	mNextActions = ACTION_NONE;
+	readEvent(0);
+}
+
+bool LReplay::isFinished() const
+{
+	return mPlayTick >= mTicks;
+}
+
+Uint32 LReplay::nextTick()
+{
+	if (mHasNextEvent && mNextEventTick == mPlayTick)
+	{
+		mPlayActions = mNextActions;
+		readEvent(mPlayTick);
+	}
+	++mPlayTick;
+	return mPlayActions;
+}
+
+bool LReplay::play(LGame* game)
+{
+	rewind();
+	game->reset(mSeed);
+	while (!isFinished())
+	{
+		game->step(nextTick());
+	}
+	return game->getStateHash() == mFinalHash;
+}
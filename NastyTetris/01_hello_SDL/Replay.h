@@ -0,0 +1,109 @@
+#pragma once
+
+/* Headers */
+//Using SDL, the game rules and STL vector
+#include <SDL.h>
+#include <vector>
+#include "Game.h"
+
+
+
+/* Constants */
+
+//Replay identification
+const Uint32 REPLAY_MAGIC = 0x5052544E;
+const Uint32 REPLAY_VERSION = 1;
+
+//Where the last game played is saved
+const char* const REPLAY_LAST_PATH = "last.replay";
+
+//Stream bytes reserved up front, a couple of hours of play at a few bytes per input change
+const size_t REPLAY_RESERVE_BYTES = 256 * 1024;
+
+//Replay header, followed by the event stream
+struct LReplayHeader
+{
+	Uint32 magic;
+	Uint32 version;
+	Uint32 seed;
+	Uint32 tickRate;
+	Uint64 ticks;
+	Uint64 finalHash;
+	Uint32 eventCount;
+	Uint32 streamSize;
+};
+
+//Seed plus the actions of every logic tick, enough to play a game again bit for bit
+//Only ticks whose actions differ from the tick before are stored, as a varint tick delta and an action byte
+class LReplay
+{
+public:
+	//Initializes variables
+	LReplay();
+
+	//Forgets any recorded input and starts recording a game started with the seed
+	void beginRecording(Uint32 seed);
+
+	//Checks whether ticks are being recorded
+	bool isRecording() const;
+
+	//Appends the actions of the next tick
+	void record(Uint32 actions);
+
+	//Writes the recording with the state the game ended in and stops recording
+	bool save(const char* path, const LGame& game);
+
+	//Reads a replay and rewinds it for playback
+	bool load(const char* path);
+
+	//Gets replay info
+	Uint32 getSeed() const;
+	Uint64 getTickCount() const;
+	Uint64 getFinalHash() const;
+	Uint32 getEventCount() const;
+
+	//Moves playback back to the first tick
+	void rewind();
+
+	//Checks whether every tick was played back
+	bool isFinished() const;
+
+	//Gets the actions of the next tick
+	Uint32 nextTick();
+
+	//Restarts the game from the seed and plays every tick, true if it ends in the recorded state
+	bool play(LGame* game);
+
+private:
+	//Stream encoding
+	void writeVarint(Uint64 value);
+	bool readVarint(size_t* offset, Uint64* value) const;
+
+	//Decodes the event after the one at the given tick
+	void readEvent(Uint64 previousTick);
+
+	//Recorded events
+	std::vector<Uint8> mStream;
+	Uint32 mEventCount;
+
+	//Game the events belong to
+	Uint32 mSeed;
+	Uint64 mTicks;
+	Uint64 mFinalHash;
+
+	//Recording state
+	bool mRecording;
+	Uint32 mLastActions;
+	Uint64 mLastEventTick;
+
+	//Playback state
+	size_t mReadOffset;
+	Uint64 mPlayTick;
+	Uint32 mPlayActions;
+	Uint64 mNextEventTick;
+	Uint32 mNextActions;
+	bool mHasNextEvent;
+};
+
+//Replay of the game being played
+extern LReplay gReplay;
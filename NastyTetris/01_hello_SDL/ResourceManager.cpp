@@ -0,0 +1,342 @@
+/* Headers */
+#include "ResourceManager.h"
+#include "AssetArchive.h"
+#include "LTexture.h"
+#include "TextureImport.h"
+#include <stdio.h>
+
+
+
+//Every resource the game loads
+LResourceManager gResources;
+
+LResourceManager::LResourceManager()
+{
+	//Initialize
+	mUsedBytes = 0;
+	mUnusedBytes = 0;
+	mBudget = RESOURCE_BUDGET_BYTES;
+	mClock = 0;
+
+	//SDL mutexes are recursive, handles built under the lock may take it again
+	mMutex = SDL_CreateMutex();
+
+	//Globals are constructed before main() on the main thread
+	mMainThread = SDL_ThreadID();
+}
+
+LResourceManager::~LResourceManager()
+{
+	//Deallocate
+	clear();
+
+	//Entries still referenced stay allocated so late handles can release safely
+	if (mMutex != NULL)
+	{
+		SDL_DestroyMutex(mMutex);
+		mMutex = NULL;
+	}
+}
+
+LResourceEntry* LResourceManager::find(const std::string& id, ResourceType type)
+{
+	std::map<std::string, LResourceEntry*>::iterator it = mEntries.find(id);
+	if (it == mEntries.end() || it->second->type != type)
+	{
+		return NULL;
+	}
+	return it->second;
+}
+
+LResourceEntry* LResourceManager::add(const std::string& id, ResourceType type, void* resource, size_t bytes)
+{
+	LResourceEntry* entry = new LResourceEntry;
+	entry->id = id;
+	entry->type = type;
+	entry->resource = resource;
+	entry->bytes = bytes;
+	entry->references = 0;
+	entry->lastUsed = ++mClock;
+	entry->manager = this;
+	mEntries[id] = entry;
+
+	//Counts as unused until the first handle takes it
+	mUsedBytes += bytes;
+	mUnusedBytes += bytes;
+	return entry;
+}
+
+void LResourceManager::destroy(LResourceEntry* entry)
+{
+	switch (entry->type)
+	{
+	case RESOURCE_TEXTURE:
+		SDL_DestroyTexture((SDL_Texture*)entry->resource);
+		break;
+
+	case RESOURCE_SURFACE:
+		SDL_FreeSurface((SDL_Surface*)entry->resource);
+		break;
+
+	case RESOURCE_FONT:
+		TTF_CloseFont((TTF_Font*)entry->resource);
+		break;
+	}
+	entry->resource = NULL;
+}
+
+LTextureHandle LResourceManager::loadTexture(const std::string& path)
+{
+	SDL_LockMutex(mMutex);
+
+	//Loaded before, share it
+	LResourceEntry* entry = find(path, RESOURCE_TEXTURE);
+	if (entry == NULL)
+	{
+		//Keyed and premultiplied once, from the import cache after the first run
+		SDL_Texture* texture = gTextureImporter.createTexture(gRenderer, path, NULL, NULL);
+
+		if (texture != NULL)
+		{
+			int w = 0;
+			int h = 0;
+			SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+			entry = add(path, RESOURCE_TEXTURE, texture, (size_t)w * h * 4);
+		}
+	}
+
+	LTextureHandle handle(entry);
+	evict();
+	SDL_UnlockMutex(mMutex);
+	return handle;
+}
+
+LTextureHandle LResourceManager::addTexture(const std::string& id, SDL_Texture* texture)
+{
+	if (texture == NULL)
+	{
+		return LTextureHandle();
+	}
+
+	SDL_LockMutex(mMutex);
+
+	LResourceEntry* entry = find(id, RESOURCE_TEXTURE);
+	if (entry != NULL)
+	{
+		//Somebody made the same texture already
+		SDL_DestroyTexture(texture);
+	}
+	else
+	{
+		Uint32 format = 0;
+		int w = 0;
+		int h = 0;
+		SDL_QueryTexture(texture, &format, NULL, &w, &h);
+		entry = add(id, RESOURCE_TEXTURE, texture, (size_t)w * h * SDL_BYTESPERPIXEL(format));
+	}
+
+	LTextureHandle handle(entry);
+	evict();
+	SDL_UnlockMutex(mMutex);
+	return handle;
+}
+
+LTextureHandle LResourceManager::findTexture(const std::string& id)
+{
+	SDL_LockMutex(mMutex);
+	LTextureHandle handle(find(id, RESOURCE_TEXTURE));
+	SDL_UnlockMutex(mMutex);
+	return handle;
+}
+
+LSurfaceHandle LResourceManager::loadSurface(const std::string& path, Uint32 format)
+{
+	//The same image converted to another format is another resource
+	std::string id = path + "@" + SDL_GetPixelFormatName(format);
+
+	SDL_LockMutex(mMutex);
+
+	LResourceEntry* entry = find(id, RESOURCE_SURFACE);
+	if (entry == NULL)
+	{
+		//Converted once, from the import cache after the first run
+		SDL_Surface* convertedSurface = gTextureImporter.importSurface(path, format);
+		if (convertedSurface != NULL)
+		{
+			entry = add(id, RESOURCE_SURFACE, convertedSurface, (size_t)convertedSurface->pitch * convertedSurface->h);
+		}
+	}
+
+	LSurfaceHandle handle(entry);
+	evict();
+	SDL_UnlockMutex(mMutex);
+	return handle;
+}
+
+LFontHandle LResourceManager::loadFont(const std::string& path, int size)
+{
+	//Every point size is its own font
+	char id[ASSET_NAME_LENGTH + 16];
+	SDL_snprintf(id, sizeof(id), "%s@%d", path.c_str(), size);
+
+	SDL_LockMutex(mMutex);
+
+	LResourceEntry* entry = find(id, RESOURCE_FONT);
+	if (entry == NULL)
+	{
+		//From the mapped archive when it was packed
+		TTF_Font* font = gAssets.openFont(path, size);
+		if (font == NULL)
+		{
+			font = TTF_OpenFont(path.c_str(), size);
+		}
+
+		if (font == NULL)
+		{
+			printf("Unable to load font %s! SDL_ttf Error: %s\n", path.c_str(), TTF_GetError());
+		}
+		else
+		{
+			entry = add(id, RESOURCE_FONT, font, RESOURCE_FONT_BYTES);
+		}
+	}
+
+	LFontHandle handle(entry);
+	evict();
+	SDL_UnlockMutex(mMutex);
+	return handle;
+}
+
+void LResourceManager::acquire(LResourceEntry* entry)
+{
+	if (mMutex != NULL)
+	{
+		SDL_LockMutex(mMutex);
+	}
+
+	if (entry->references++ == 0)
+	{
+		mUnusedBytes -= entry->bytes;
+	}
+
+	if (mMutex != NULL)
+	{
+		SDL_UnlockMutex(mMutex);
+	}
+}
+
+void LResourceManager::release(LResourceEntry* entry)
+{
+	if (mMutex != NULL)
+	{
+		SDL_LockMutex(mMutex);
+	}
+
+	//Unused entries stay loaded for the next request until the budget runs out
+	if (--entry->references == 0)
+	{
+		entry->lastUsed = ++mClock;
+		mUnusedBytes += entry->bytes;
+		evict();
+	}
+
+	if (mMutex != NULL)
+	{
+		SDL_UnlockMutex(mMutex);
+	}
+}
+
+void LResourceManager::evict()
+{
+	//The render API is main thread only, loader threads releasing a handle must not destroy textures
+	bool mainThread = SDL_ThreadID() == mMainThread;
+	while (mUnusedBytes > mBudget)
+	{
+		//Least recently released entry nobody holds
+		std::map<std::string, LResourceEntry*>::iterator oldest = mEntries.end();
+		for (std::map<std::string, LResourceEntry*>::iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+		{
+			if (!mainThread && it->second->type == RESOURCE_TEXTURE)
+			{
+				continue;
+			}
+			if (it->second->references == 0 && (oldest == mEntries.end() || it->second->lastUsed < oldest->second->lastUsed))
+			{
+				oldest = it;
+			}
+		}
+		if (oldest == mEntries.end())
+		{
+			break;
+		}
+
+		LResourceEntry* entry = oldest->second;
+		mUsedBytes -= entry->bytes;
+		mUnusedBytes -= entry->bytes;
+		destroy(entry);
+		delete entry;
+		mEntries.erase(oldest);
+	}
+}
+
+void LResourceManager::setBudget(size_t bytes)
+{
+	SDL_LockMutex(mMutex);
+	mBudget = bytes;
+	evict();
+	SDL_UnlockMutex(mMutex);
+}
+
+void LResourceManager::collect()
+{
+	SDL_LockMutex(mMutex);
+	evict();
+	SDL_UnlockMutex(mMutex);
+}
+
+void LResourceManager::clear()
+{
+	if (mMutex != NULL)
+	{
+		SDL_LockMutex(mMutex);
+	}
+
+	std::map<std::string, LResourceEntry*>::iterator it = mEntries.begin();
+	while (it != mEntries.end())
+	{
+		LResourceEntry* entry = it->second;
+		if (entry->references > 0)
+		{
+			//Still held somewhere, that handle frees it through the budget later
+			printf("Resource %s still has %d references!\n", entry->id.c_str(), entry->references);
+			++it;
+			continue;
+		}
+
+		mUsedBytes -= entry->bytes;
+		mUnusedBytes -= entry->bytes;
+		destroy(entry);
+		delete entry;
+		it = mEntries.erase(it);
+	}
+
+	if (mMutex != NULL)
+	{
+		SDL_UnlockMutex(mMutex);
+	}
+}
+
+size_t LResourceManager::getUsedBytes() const
+{
+	return mUsedBytes;
+}
+
+size_t LResourceManager::getUnusedBytes() const
+{
+	return mUnusedBytes;
+}
+
+int LResourceManager::getEntryCount() const
+{
+	return (int)mEntries.size();
+}
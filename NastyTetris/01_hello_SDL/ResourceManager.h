@@ -0,0 +1,236 @@
+#pragma once
+
+/* Headers */
+//Using SDL, SDL_ttf, STL map and string
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <map>
+#include <string>
+
+
+
+/* Constants */
+
+//Bytes unused resources may keep before the least recently used ones are freed
+const size_t RESOURCE_BUDGET_BYTES = 64 * 1024 * 1024;
+
+//Fonts have no pixel size to go by, count them as a typical face with its glyph cache
+const size_t RESOURCE_FONT_BYTES = 256 * 1024;
+
+//Kinds of resource the manager owns
+enum ResourceType
+{
+	RESOURCE_TEXTURE,
+	RESOURCE_SURFACE,
+	RESOURCE_FONT
+};
+
+class LResourceManager;
+
+//One loaded resource and how many handles point at it
+struct LResourceEntry
+{
+	std::string id;
+	ResourceType type;
+	void* resource;
+	size_t bytes;
+	int references;
+	Uint64 lastUsed;
+	LResourceManager* manager;
+};
+
+//Move only reference to a managed resource, the resource lives while any handle does
+template <typename T>
+class LResourceHandle
+{
+public:
+	//Initializes an empty handle
+	LResourceHandle();
+
+	//Takes a new reference on the entry
+	explicit LResourceHandle(LResourceEntry* entry);
+
+	//Moves the reference over, the other handle ends up empty
+	LResourceHandle(LResourceHandle&& other);
+	LResourceHandle& operator=(LResourceHandle&& other);
+
+	//Copies would hide where references come from, use share()
+	LResourceHandle(const LResourceHandle&) = delete;
+	LResourceHandle& operator=(const LResourceHandle&) = delete;
+
+	//Drops the reference
+	~LResourceHandle();
+
+	//Gets another handle to the same resource
+	LResourceHandle share() const;
+
+	//Drops the reference and empties the handle
+	void reset();
+
+	//Gets the resource, NULL for an empty handle
+	T* get() const;
+	explicit operator bool() const;
+
+	//Gets the asset ID the resource was loaded as
+	const char* getId() const;
+
+private:
+	LResourceEntry* mEntry;
+};
+
+typedef LResourceHandle<SDL_Texture> LTextureHandle;
+typedef LResourceHandle<SDL_Surface> LSurfaceHandle;
+typedef LResourceHandle<TTF_Font> LFontHandle;
+
+//Owns every texture, surface and font loaded by asset ID, loading the same ID twice shares it
+class LResourceManager
+{
+public:
+	//Initializes variables
+	LResourceManager();
+
+	//Frees everything left
+	~LResourceManager();
+
+	//Loads a color keyed image as a texture in the import format and blend mode, from the archive when it is open
+	//Textures need the renderer, so only call this from the main thread
+	LTextureHandle loadTexture(const std::string& path);
+
+	//Takes ownership of a texture created elsewhere, an ID already loaded keeps its texture and destroys this one
+	LTextureHandle addTexture(const std::string& id, SDL_Texture* texture);
+
+	//Gets a texture that is already loaded, empty if it is not
+	LTextureHandle findTexture(const std::string& id);
+
+	//Loads an image as a surface in the given pixel format
+	LSurfaceHandle loadSurface(const std::string& path, Uint32 format);
+
+	//Opens a font at a point size, from the archive when it is open
+	LFontHandle loadFont(const std::string& path, int size);
+
+	//Frees unused resources, least recently used first, until they fit in the budget
+	//Textures are only destroyed on the main thread, call collect() from there to free the ones other threads released
+	void setBudget(size_t bytes);
+	void collect();
+
+	//Frees every unused resource, reports the ones still referenced
+	void clear();
+
+	//Gets memory statistics
+	size_t getUsedBytes() const;
+	size_t getUnusedBytes() const;
+	int getEntryCount() const;
+
+	//Called by handles
+	void acquire(LResourceEntry* entry);
+	void release(LResourceEntry* entry);
+
+private:
+	//Finds an entry of the given type, NULL when it is not loaded
+	LResourceEntry* find(const std::string& id, ResourceType type);
+
+	//Adds a loaded resource
+	LResourceEntry* add(const std::string& id, ResourceType type, void* resource, size_t bytes);
+
+	//Frees an entry's resource
+	static void destroy(LResourceEntry* entry);
+
+	//Frees unused entries until the unused ones fit in the budget, call with the lock held
+	//Off the main thread textures are left for the next call on the main thread
+	void evict();
+
+	//Loaded resources by ID
+	std::map<std::string, LResourceEntry*> mEntries;
+
+	//Memory held by all entries and by the unreferenced ones
+	size_t mUsedBytes;
+	size_t mUnusedBytes;
+	size_t mBudget;
+
+	//Counts releases, orders unused entries for eviction
+	Uint64 mClock;
+
+	//Fonts may be opened on loader threads
+	SDL_mutex* mMutex;
+
+	//Thread the manager was created on, the only one allowed to destroy textures
+	SDL_threadID mMainThread;
+};
+
+//Every resource the game loads
+extern LResourceManager gResources;
+
+template <typename T>
+LResourceHandle<T>::LResourceHandle()
+{
+	mEntry = NULL;
+}
+
+template <typename T>
+LResourceHandle<T>::LResourceHandle(LResourceEntry* entry)
+{
+	mEntry = entry;
+	if (mEntry != NULL)
+	{
+		mEntry->manager->acquire(mEntry);
+	}
+}
+
+template <typename T>
+LResourceHandle<T>::LResourceHandle(LResourceHandle&& other)
+{
+	mEntry = other.mEntry;
+	other.mEntry = NULL;
+}
+
+template <typename T>
+LResourceHandle<T>& LResourceHandle<T>::operator=(LResourceHandle&& other)
+{
+	if (this != &other)
+	{
+		reset();
+		mEntry = other.mEntry;
+		other.mEntry = NULL;
+	}
+	return *this;
+}
+
+template <typename T>
+LResourceHandle<T>::~LResourceHandle()
+{
+	reset();
+}
+
+template <typename T>
+LResourceHandle<T> LResourceHandle<T>::share() const
+{
+	return LResourceHandle(mEntry);
+}
+
+template <typename T>
+void LResourceHandle<T>::reset()
+{
+	if (mEntry != NULL)
+	{
+		mEntry->manager->release(mEntry);
+		mEntry = NULL;
+	}
+}
+
+template <typename T>
+T* LResourceHandle<T>::get() const
+{
+	return mEntry != NULL ? (T*)mEntry->resource : NULL;
+}
+
+template <typename T>
+LResourceHandle<T>::operator bool() const
+{
+	return mEntry != NULL;
+}
+
+template <typename T>
+const char* LResourceHandle<T>::getId() const
+{
+	return mEntry != NULL ? mEntry->id.c_str() : "";
+}
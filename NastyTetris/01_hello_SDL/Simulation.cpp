@@ -0,0 +1,266 @@
+/* Headers */
+#include "Simulation.h"
+#include "Bot.h"
+#include "Input.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+//Simulation of the game on screen
+LSimulation gSimulation;
+
+LSimulation::LSimulation() : mQuit(false)
+{
+	//Initialize
+	mThread = NULL;
+	mWake = NULL;
+	mPreviousPiece = mGame.getPiece();
+	mGameNumber = 0;
+	mPlaying = false;
+	mShowHint = false;
+	mBotPlaying = false;
+	memset(mLocks, 0, sizeof(mLocks));
+	mLockCount = 0;
+}
+
+LSimulation::~LSimulation()
+{
+	//Deallocate
+	stop();
+}
+
+bool LSimulation::start()
+{
+	if (mThread != NULL)
+	{
+		return true;
+	}
+
+	mWake = SDL_CreateSemaphore(0);
+	if (mWake == NULL)
+	{
+		printf("Unable to create simulation semaphore! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	//Readers see a menu until the first publish
+	publish(SDL_GetPerformanceCounter());
+	mQuit = false;
+	mThread = SDL_CreateThread(simulationThread, "Simulation", this);
+	if (mThread == NULL)
+	{
+		printf("Unable to create simulation thread! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+	return true;
+}
+
+void LSimulation::stop()
+{
+	if (mThread != NULL)
+	{
+		mQuit.store(true, std::memory_order_release);
+		SDL_SemPost(mWake);
+		SDL_WaitThread(mThread, NULL);
+		mThread = NULL;
+	}
+	if (mWake != NULL)
+	{
+		SDL_DestroySemaphore(mWake);
+		mWake = NULL;
+	}
+
+	//Closing the window mid game still keeps it
+	if (gReplay.isRecording())
+	{
+		gReplay.save(REPLAY_LAST_PATH, mGame);
+	}
+}
+
+bool LSimulation::post(SimCommandType type, Uint32 value)
+{
+	LSimCommand command;
+	command.type = type;
+	command.value = value;
+	if (!mCommands.push(command))
+	{
+		printf("Simulation command queue full, dropping a command!\n");
+		return false;
+	}
+	if (mWake != NULL)
+	{
+		SDL_SemPost(mWake);
+	}
+	return true;
+}
+
+const LSimSnapshot& LSimulation::acquire()
+{
+	mSnapshots.update();
+	return mSnapshots.getReadBuffer();
+}
+
+int LSimulation::simulationThread(void* data)
+{
+	((LSimulation*)data)->run();
+	return 0;
+}
+
+void LSimulation::run()
+{
+	//Fixed timestep clock, independent of how fast frames are drawn and presented
+	//The accumulator counts counter ticks times LOGIC_TICK_RATE, so a logic tick is exactly frequency of them and never rounds
+	const Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 previousTime = SDL_GetPerformanceCounter();
+	Uint64 accumulator = 0;
+	while (!mQuit.load(std::memory_order_acquire))
+	{
+		LProfileZone zone("Simulation");
+		Uint64 currentTime = SDL_GetPerformanceCounter();
+		Uint64 elapsed = currentTime - previousTime;
+		previousTime = currentTime;
+		if (elapsed > frequency * MAX_FRAME_MS / 1000)
+		{
+			elapsed = frequency * MAX_FRAME_MS / 1000;
+		}
+		accumulator += elapsed * LOGIC_TICK_RATE;
+
+		bool changed = runCommands();
+		bool ticked = false;
+		while (accumulator >= frequency)
+		{
+			//Real time this tick ends at, keys pressed before it count for it
+			if (mPlaying)
+			{
+				tick(currentTime - (accumulator - frequency) / LOGIC_TICK_RATE);
+				ticked = true;
+			}
+			accumulator -= frequency;
+		}
+
+		//Searches finish in the background, the hint shows up once one did
+		if (mPlaying && (mShowHint || mBotPlaying))
+		{
+			gBot.update(mGame);
+			changed = true;
+		}
+
+		//Keep the finished or abandoned game for --replay
+		if (gReplay.isRecording() && (mGame.isOver() || !mPlaying))
+		{
+			gReplay.save(REPLAY_LAST_PATH, mGame);
+		}
+
+		if (ticked || changed)
+		{
+			publish(currentTime - accumulator / LOGIC_TICK_RATE);
+		}
+		zone.end();
+
+		//Sleep up to the next tick, waking a little late is caught up by the accumulator
+		if (mPlaying)
+		{
+			Uint32 wait = (Uint32)((frequency - accumulator) * 1000 / (frequency * LOGIC_TICK_RATE));
+			SDL_Delay(wait > 0 ? wait : 1);
+		}
+
+		//Nothing ticks between games, sleep until the main thread posts a command and start the clock over
+		else
+		{
+			//Every command posts, also the ones run while ticking, drop those so the wait doesn't return at once
+			while (SDL_SemTryWait(mWake) == 0)
+			{
+			}
+
+			//A command or stop() that raced the drain may have lost its post, don't sleep past it
+			LSimCommand pending;
+			if (!mCommands.peek(&pending) && !mQuit.load(std::memory_order_acquire))
+			{
+				SDL_SemWait(mWake);
+			}
+			previousTime = SDL_GetPerformanceCounter();
+			accumulator = 0;
+		}
+	}
+}
+
+bool LSimulation::runCommands()
+{
+	bool changed = false;
+	LSimCommand command;
+	while (mCommands.pop(&command))
+	{
+		switch (command.type)
+		{
+		case SIM_COMMAND_START:
+			mGame.reset(command.value);
+			gReplay.beginRecording(command.value);
+			gBot.reset();
+			gInput.reset();
+			mPreviousPiece = mGame.getPiece();
+			++mGameNumber;
+			mPlaying = true;
+			break;
+
+		case SIM_COMMAND_STOP:
+			mPlaying = false;
+			break;
+
+		case SIM_COMMAND_TOGGLE_HINT:
+			mShowHint = !mShowHint;
+			break;
+
+		case SIM_COMMAND_TOGGLE_BOT:
+			mBotPlaying = !mBotPlaying;
+			break;
+		}
+		changed = true;
+	}
+	return changed;
+}
+
+void LSimulation::tick(Uint64 tickEnd)
+{
+	mPreviousPiece = mGame.getPiece();
+	Uint32 actions = gInput.tick(tickEnd);
+	if (mBotPlaying)
+	{
+		actions = gBot.getActions(mGame);
+		gInput.reset();
+	}
+	if (!mGame.isOver())
+	{
+		gReplay.record(actions);
+	}
+	LGameStats before = mGame.getStats();
+	mGame.step(actions);
+
+	//Remember the lock for the renderer's effects, it may only look after several more ticks
+	if (mGame.getStats().pieces != before.pieces)
+	{
+		LLockEvent& event = mLocks[mLockCount % SIM_LOCK_HISTORY];
+		event.lock = mGame.getLastLock();
+		event.dropStart = mPreviousPiece;
+		event.hardDrop = (actions & ACTION_HARD_DROP) != 0;
+		event.before = before;
+		event.after = mGame.getStats();
+		++mLockCount;
+	}
+}
+
+void LSimulation::publish(Uint64 tickEnd)
+{
+	LSimSnapshot& snapshot = mSnapshots.getWriteBuffer();
+	snapshot.game = mGame;
+	snapshot.previousPiece = mPreviousPiece;
+	snapshot.gameNumber = mGameNumber;
+	snapshot.tickEnd = tickEnd;
+	snapshot.hintShown = mPlaying && mShowHint && gBot.hasPlan() && !mGame.isOver();
+	snapshot.hint = snapshot.hintShown ? gBot.getPlan().target : mGame.getPiece();
+	memcpy(snapshot.locks, mLocks, sizeof(mLocks));
+	snapshot.lockCount = mLockCount;
+	mSnapshots.publish();
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+/* Headers */
+//Using SDL threads, the game rules and the lock-free hand-offs
+#include <SDL.h>
+#include <atomic>
+#include "Game.h"
+#include "LockFree.h"
+
+
+
+/* Constants */
+
+//Longest stall the simulation will catch up on, anything beyond is dropped
+const int MAX_FRAME_MS = 250;
+
+//Piece locks a snapshot remembers, more than can happen between two frames
+const int SIM_LOCK_HISTORY = 16;
+
+//Commands waiting for the simulation thread, a power of two
+const int SIM_COMMAND_CAPACITY = 32;
+
+//What the main thread can ask of the simulation
+enum SimCommandType
+{
+	SIM_COMMAND_START,
+	SIM_COMMAND_STOP,
+	SIM_COMMAND_TOGGLE_HINT,
+	SIM_COMMAND_TOGGLE_BOT
+};
+
+//One request, value is the seed for SIM_COMMAND_START
+struct LSimCommand
+{
+	SimCommandType type;
+	Uint32 value;
+};
+
+//A piece lock with what effects and popups need about it
+struct LLockEvent
+{
+	LLockInfo lock;
+	LPiece dropStart;
+	bool hardDrop;
+	LGameStats before;
+	LGameStats after;
+};
+
+//Everything the renderer needs from one point of the simulation, written whole and never changed once published
+struct LSimSnapshot
+{
+	//Game as of the last tick, and the piece before that tick for interpolation
+	LGame game;
+	LPiece previousPiece;
+
+	//Which started game this is, 0 before the first
+	Uint32 gameNumber;
+
+	//Real time the last tick ended at, as a performance counter value
+	Uint64 tickEnd;
+
+	//Where the bot would put the piece
+	bool hintShown;
+	LPiece hint;
+
+	//Latest locks, lock number i is at i % SIM_LOCK_HISTORY, lockCount never goes back
+	LLockEvent locks[SIM_LOCK_HISTORY];
+	Uint64 lockCount;
+};
+
+//Runs the game at its tick rate on its own thread, whatever the renderer does
+//The main thread posts commands and key events in and reads the newest snapshot out, neither side ever waits for the other
+//Between games the thread sleeps until a command comes, so an idle menu costs no wakeups
+class LSimulation
+{
+public:
+	//Initializes variables
+	LSimulation();
+
+	//Stops the thread
+	~LSimulation();
+
+	//Starts the simulation thread
+	bool start();
+
+	//Stops the thread and saves a game still being recorded
+	void stop();
+
+	//Queues a command for the next tick, main thread only
+	bool post(SimCommandType type, Uint32 value = 0);
+
+	//Gets the newest published snapshot, main thread only, valid until the next call
+	const LSimSnapshot& acquire();
+
+private:
+	//Thread entry point
+	static int simulationThread(void* data);
+
+	//Tick loop
+	void run();
+
+	//Applies queued commands, true when one of them changed something visible
+	bool runCommands();
+
+	//Advances the game by one tick ending at tickEnd
+	void tick(Uint64 tickEnd);
+
+	//Copies the state into the write buffer and hands it over
+	void publish(Uint64 tickEnd);
+
+	//Hand-offs with the main thread
+	LTripleBuffer<LSimSnapshot> mSnapshots;
+	LSpscQueue<LSimCommand, SIM_COMMAND_CAPACITY> mCommands;
+
+	//Thread, its stop flag and what it sleeps on between games
+	SDL_Thread* mThread;
+	std::atomic<bool> mQuit;
+	SDL_sem* mWake;
+
+	//Simulation thread state
+	LGame mGame;
+	LPiece mPreviousPiece;
+	Uint32 mGameNumber;
+	bool mPlaying;
+	bool mShowHint;
+	bool mBotPlaying;
+	LLockEvent mLocks[SIM_LOCK_HISTORY];
+	Uint64 mLockCount;
+};
+
+//Simulation of the game on screen
+extern LSimulation gSimulation;
@@ -0,0 +1,282 @@
+/* Headers */
+#include "SpriteBatch.h"
+#include "LTexture.h"
+#include <algorithm>
+#include <math.h>
+
+
+
+//Degrees to radians
+const double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180.0;
+
+//Batch used for every frame
+LSpriteBatch gSpriteBatch;
+
+LSpriteBatch::LSpriteBatch()
+{
+	//Initialize
+	mSizeTexture = NULL;
+	mTextureWidth = 0;
+	mTextureHeight = 0;
+	mRecording = false;
+	mLayer = 0;
+	mDrawCalls = 0;
+	mQuadCount = 0;
+}
+
+void LSpriteBatch::begin()
+{
+	mQuads.clear();
+	mGeometry.clear();
+	mLayer = 0;
+	mRecording = true;
+
+	//Textures freed since last frame can come back at the same address with another size
+	mSizeTexture = NULL;
+}
+
+bool LSpriteBatch::isRecording() const
+{
+	return mRecording;
+}
+
+void LSpriteBatch::setLayer(int layer)
+{
+	mLayer = layer;
+}
+
+void LSpriteBatch::draw(SDL_Texture* texture, const SDL_Rect* source, const SDL_FRect& destination, SDL_Color color, SDL_BlendMode blendMode, double angle, const SDL_FPoint* center, SDL_RendererFlip flip)
+{
+	LSpriteQuad quad;
+	quad.layer = mLayer;
+	quad.blendMode = blendMode;
+	quad.texture = texture;
+	quad.order = (int)mQuads.size();
+
+	//Texture coordinates, normalized by the texture size
+	float u0 = 0.0f;
+	float v0 = 0.0f;
+	float u1 = 1.0f;
+	float v1 = 1.0f;
+	if (texture != NULL && source != NULL)
+	{
+		if (texture != mSizeTexture)
+		{
+			SDL_QueryTexture(texture, NULL, NULL, &mTextureWidth, &mTextureHeight);
+			mSizeTexture = texture;
+		}
+		u0 = (float)source->x / mTextureWidth;
+		v0 = (float)source->y / mTextureHeight;
+		u1 = (float)(source->x + source->w) / mTextureWidth;
+		v1 = (float)(source->y + source->h) / mTextureHeight;
+	}
+	if (flip & SDL_FLIP_HORIZONTAL)
+	{
+		std::swap(u0, u1);
+	}
+	if (flip & SDL_FLIP_VERTICAL)
+	{
+		std::swap(v0, v1);
+	}
+
+	//Corners relative to the rotation center, clockwise from top left
+	float cx = center != NULL ? center->x : destination.w / 2.0f;
+	float cy = center != NULL ? center->y : destination.h / 2.0f;
+	float corners[4][2] =
+	{
+		{ -cx, -cy },
+		{ destination.w - cx, -cy },
+		{ destination.w - cx, destination.h - cy },
+		{ -cx, destination.h - cy }
+	};
+	float uvs[4][2] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+
+	//SDL angles are clockwise degrees
+	float cosine = 1.0f;
+	float sine = 0.0f;
+	if (angle != 0.0)
+	{
+		double radians = angle * DEGREES_TO_RADIANS;
+		cosine = (float)cos(radians);
+		sine = (float)sin(radians);
+	}
+
+	for (int i = 0; i < 4; ++i)
+	{
+		SDL_Vertex& vertex = quad.vertices[i];
+		vertex.position.x = destination.x + cx + corners[i][0] * cosine - corners[i][1] * sine;
+		vertex.position.y = destination.y + cy + corners[i][0] * sine + corners[i][1] * cosine;
+		vertex.color = color;
+		vertex.tex_coord.x = uvs[i][0];
+		vertex.tex_coord.y = uvs[i][1];
+	}
+
+	mQuads.push_back(quad);
+}
+
+void LSpriteBatch::fillRect(const SDL_Rect& rect, SDL_Color color, SDL_BlendMode blendMode)
+{
+	SDL_FRect destination = { (float)rect.x, (float)rect.y, (float)rect.w, (float)rect.h };
+	draw(NULL, NULL, destination, color, blendMode);
+}
+
+bool LSpriteBatch::compareQuads(const LSpriteQuad* a, const LSpriteQuad* b)
+{
+	if (a->layer != b->layer)
+	{
+		return a->layer < b->layer;
+	}
+	if (a->blendMode != b->blendMode)
+	{
+		return a->blendMode < b->blendMode;
+	}
+	if (a->texture != b->texture)
+	{
+		return a->texture < b->texture;
+	}
+
+	//Keep submission order inside a run
+	return a->order < b->order;
+}
+
+void LSpriteBatch::drawQuads(SDL_Texture* texture, const SDL_Vertex* vertices, int quads, SDL_BlendMode blendMode)
+{
+	if (quads <= 0)
+	{
+		return;
+	}
+
+	LSpriteGeometry geometry;
+	geometry.layer = mLayer;
+	geometry.order = (int)mGeometry.size();
+	geometry.blendMode = blendMode;
+	geometry.texture = texture;
+	geometry.vertices = vertices;
+	geometry.quads = quads;
+	mGeometry.push_back(geometry);
+}
+
+bool LSpriteBatch::compareGeometry(const LSpriteGeometry& a, const LSpriteGeometry& b)
+{
+	if (a.layer != b.layer)
+	{
+		return a.layer < b.layer;
+	}
+	return a.order < b.order;
+}
+
+void LSpriteBatch::reserveIndices(int quads)
+{
+	//Two triangles per quad, every run starts its vertices at 0 so one index list serves all
+	while (mIndices.size() < (size_t)quads * 6)
+	{
+		int base = (int)(mIndices.size() / 6) * 4;
+		mIndices.push_back(base);
+		mIndices.push_back(base + 1);
+		mIndices.push_back(base + 2);
+		mIndices.push_back(base + 2);
+		mIndices.push_back(base + 3);
+		mIndices.push_back(base);
+	}
+}
+
+void LSpriteBatch::submit(SDL_Texture* texture, SDL_BlendMode blendMode, const SDL_Vertex* vertices, int quads)
+{
+	//Color and alpha live in the vertices, reset any modulation left on the texture
+	if (texture != NULL)
+	{
+		SDL_SetTextureColorMod(texture, 0xFF, 0xFF, 0xFF);
+		SDL_SetTextureAlphaMod(texture, 0xFF);
+		SDL_SetTextureBlendMode(texture, blendMode);
+	}
+	else
+	{
+		SDL_SetRenderDrawBlendMode(gRenderer, blendMode);
+	}
+
+	SDL_RenderGeometry(gRenderer, texture, vertices, quads * 4, &mIndices[0], quads * 6);
+	++mDrawCalls;
+}
+
+void LSpriteBatch::flush()
+{
+	mRecording = false;
+	mDrawCalls = 0;
+	mQuadCount = (int)mQuads.size();
+	if (mQuads.empty() && mGeometry.empty())
+	{
+		return;
+	}
+
+	//Sort pointers rather than the quads themselves
+	mSorted.resize(mQuads.size());
+	for (size_t i = 0; i < mQuads.size(); ++i)
+	{
+		mSorted[i] = &mQuads[i];
+	}
+	std::sort(mSorted.begin(), mSorted.end(), compareQuads);
+	std::sort(mGeometry.begin(), mGeometry.end(), compareGeometry);
+
+	int mostQuads = (int)mQuads.size();
+	for (size_t i = 0; i < mGeometry.size(); ++i)
+	{
+		mQuadCount += mGeometry[i].quads;
+		mostQuads = std::max(mostQuads, mGeometry[i].quads);
+	}
+	reserveIndices(mostQuads);
+
+	mVertices.resize(mQuads.size() * 4);
+	for (size_t i = 0; i < mSorted.size(); ++i)
+	{
+		for (int corner = 0; corner < 4; ++corner)
+		{
+			mVertices[i * 4 + corner] = mSorted[i]->vertices[corner];
+		}
+	}
+
+	//One geometry call per run of matching texture and blend mode, prebuilt quads go in once their layer is done
+	size_t runStart = 0;
+	size_t geometry = 0;
+	while (runStart < mSorted.size())
+	{
+		SDL_Texture* texture = mSorted[runStart]->texture;
+		SDL_BlendMode blendMode = mSorted[runStart]->blendMode;
+		int layer = mSorted[runStart]->layer;
+		for (; geometry < mGeometry.size() && mGeometry[geometry].layer < layer; ++geometry)
+		{
+			submit(mGeometry[geometry].texture, mGeometry[geometry].blendMode, mGeometry[geometry].vertices, mGeometry[geometry].quads);
+		}
+
+		size_t runEnd = runStart + 1;
+		while (runEnd < mSorted.size() && mSorted[runEnd]->texture == texture && mSorted[runEnd]->blendMode == blendMode)
+		{
+			//Runs only break across layers when prebuilt quads go in between
+			if (mSorted[runEnd]->layer != mSorted[runEnd - 1]->layer && geometry < mGeometry.size() && mGeometry[geometry].layer < mSorted[runEnd]->layer)
+			{
+				break;
+			}
+			++runEnd;
+		}
+		submit(texture, blendMode, &mVertices[runStart * 4], (int)(runEnd - runStart));
+
+		runStart = runEnd;
+	}
+	for (; geometry < mGeometry.size(); ++geometry)
+	{
+		submit(mGeometry[geometry].texture, mGeometry[geometry].blendMode, mGeometry[geometry].vertices, mGeometry[geometry].quads);
+	}
+
+	SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_NONE);
+	mQuads.clear();
+	mGeometry.clear();
+}
+
+int LSpriteBatch::getDrawCalls() const
+{
+	return mDrawCalls;
+}
+
+int LSpriteBatch::getQuadCount() const
+{
+	return mQuadCount;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/* Headers */
+//Using SDL and STL vector
+#include <SDL.h>
+#include <vector>
+
+
+
+//Collects quads over a frame and submits them with as few SDL_RenderGeometry calls as possible
+class LSpriteBatch
+{
+public:
+	//Initializes variables
+	LSpriteBatch();
+
+	//Starts recording a frame, draws are queued until flush()
+	void begin();
+
+	//Checks whether draws are being queued
+	bool isRecording() const;
+
+	//Sets the layer following draws go on, lower layers are drawn first
+	void setLayer(int layer);
+
+	//Queues a textured quad, source is in texels and NULL means the whole texture
+	void draw(SDL_Texture* texture, const SDL_Rect* source, const SDL_FRect& destination, SDL_Color color, SDL_BlendMode blendMode, double angle = 0.0, const SDL_FPoint* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE);
+
+	//Queues a solid rectangle
+	void fillRect(const SDL_Rect& rect, SDL_Color color, SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND);
+
+	//Queues quads built elsewhere as one submission after the quads of the current layer
+	//Four vertices per quad, clockwise from top left, they must stay untouched until flush()
+	void drawQuads(SDL_Texture* texture, const SDL_Vertex* vertices, int quads, SDL_BlendMode blendMode);
+
+	//Sorts queued quads by layer, blend mode and texture and renders them
+	void flush();
+
+	//Gets statistics of the last flush
+	int getDrawCalls() const;
+	int getQuadCount() const;
+
+private:
+	//One queued sprite
+	struct LSpriteQuad
+	{
+		int layer;
+		SDL_BlendMode blendMode;
+		SDL_Texture* texture;
+		int order;
+		SDL_Vertex vertices[4];
+	};
+
+	//Quads queued with drawQuads()
+	struct LSpriteGeometry
+	{
+		int layer;
+		int order;
+		SDL_BlendMode blendMode;
+		SDL_Texture* texture;
+		const SDL_Vertex* vertices;
+		int quads;
+	};
+
+	//Orders quads so equal textures and blend modes end up next to each other
+	static bool compareQuads(const LSpriteQuad* a, const LSpriteQuad* b);
+	static bool compareGeometry(const LSpriteGeometry& a, const LSpriteGeometry& b);
+
+	//Grows the shared index list to cover a number of quads
+	void reserveIndices(int quads);
+
+	//Sets up texture or draw state and renders one run
+	void submit(SDL_Texture* texture, SDL_BlendMode blendMode, const SDL_Vertex* vertices, int quads);
+
+	//Queued quads and their sorted order
+	std::vector<LSpriteQuad> mQuads;
+	std::vector<const LSpriteQuad*> mSorted;
+	std::vector<LSpriteGeometry> mGeometry;
+
+	//Submission buffers, kept between frames so steady state never allocates
+	std::vector<SDL_Vertex> mVertices;
+	std::vector<int> mIndices;
+
+	//Size of the last looked up texture, forgotten every frame
+	SDL_Texture* mSizeTexture;
+	int mTextureWidth;
+	int mTextureHeight;
+
+	//Recording state
+	bool mRecording;
+	int mLayer;
+
+	//Statistics
+	int mDrawCalls;
+	int mQuadCount;
+};
+
+//Batch used for every frame
+extern LSpriteBatch gSpriteBatch;
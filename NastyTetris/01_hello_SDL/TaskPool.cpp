@@ -0,0 +1,269 @@
+/* Headers */
+#include "TaskPool.h"
+#include <stdio.h>
+
+
+
+//Threads shared by everything that wants to use all cores
+LTaskPool gTaskPool;
+
+LTaskPool::LTaskPool()
+{
+	//Initialize
+	mQueued.store(0);
+	mSleepMutex = NULL;
+	mWake = NULL;
+	mQuit = false;
+	mNextWorker.store(0);
+}
+
+LTaskPool::~LTaskPool()
+{
+	//Deallocate
+	stop();
+}
+
+bool LTaskPool::start()
+{
+	//Get rid of preexisting workers
+	stop();
+
+	mSleepMutex = SDL_CreateMutex();
+	mWake = SDL_CreateCond();
+	if (mSleepMutex == NULL || mWake == NULL)
+	{
+		printf("Unable to create task pool lock! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+
+	//The caller of parallelFor() counts as one of the cores
+	int threads = SDL_GetCPUCount() - 1;
+	if (threads > TASK_POOL_MAX_THREADS)
+	{
+		threads = TASK_POOL_MAX_THREADS;
+	}
+
+	//Queues must all exist before the first worker goes looking for work
+	for (int i = 0; i <= threads; ++i)
+	{
+		LTaskQueue* queue = new LTaskQueue;
+		queue->front = 0;
+		queue->count = 0;
+		queue->mutex = SDL_CreateMutex();
+		if (queue->mutex == NULL)
+		{
+			printf("Unable to create task queue lock! SDL Error: %s\n", SDL_GetError());
+			delete queue;
+			stop();
+			return false;
+		}
+		mQueues.push_back(queue);
+	}
+
+	mQuit = false;
+	mNextWorker.store(0);
+	for (int i = 0; i < threads; ++i)
+	{
+		SDL_Thread* thread = SDL_CreateThread(workerThread, "TaskPool", this);
+		if (thread == NULL)
+		{
+			//Queues without a worker still get emptied by thieves
+			printf("Unable to create task thread! SDL Error: %s\n", SDL_GetError());
+			break;
+		}
+		mThreads.push_back(thread);
+	}
+
+	return true;
+}
+
+void LTaskPool::stop()
+{
+	//Wake the workers up and wait for them
+	if (mSleepMutex != NULL)
+	{
+		SDL_LockMutex(mSleepMutex);
+		mQuit = true;
+		SDL_CondBroadcast(mWake);
+		SDL_UnlockMutex(mSleepMutex);
+	}
+	for (size_t i = 0; i < mThreads.size(); ++i)
+	{
+		SDL_WaitThread(mThreads[i], NULL);
+	}
+	mThreads.clear();
+
+	for (size_t i = 0; i < mQueues.size(); ++i)
+	{
+		SDL_DestroyMutex(mQueues[i]->mutex);
+		delete mQueues[i];
+	}
+	mQueues.clear();
+	mQueued.store(0);
+
+	if (mWake != NULL)
+	{
+		SDL_DestroyCond(mWake);
+		mWake = NULL;
+	}
+	if (mSleepMutex != NULL)
+	{
+		SDL_DestroyMutex(mSleepMutex);
+		mSleepMutex = NULL;
+	}
+}
+
+int LTaskPool::getThreadCount() const
+{
+	return (int)mThreads.size() + 1;
+}
+
+int LTaskPool::workerThread(void* data)
+{
+	LTaskPool* pool = (LTaskPool*)data;
+	pool->work(pool->mNextWorker.fetch_add(1));
+	return 0;
+}
+
+void LTaskPool::work(int home)
+{
+	while (true)
+	{
+		LTaskRange range;
+		if (take(home, &range))
+		{
+			run(home, range);
+			continue;
+		}
+
+		//Sleep until something is queued anywhere
+		SDL_LockMutex(mSleepMutex);
+		while (!mQuit && mQueued.load() == 0)
+		{
+			SDL_CondWait(mWake, mSleepMutex);
+		}
+		bool quit = mQuit;
+		SDL_UnlockMutex(mSleepMutex);
+		if (quit)
+		{
+			break;
+		}
+	}
+}
+
+bool LTaskPool::push(int queue, const LTaskRange& range)
+{
+	LTaskQueue* target = mQueues[queue];
+	SDL_LockMutex(target->mutex);
+	bool full = target->count == TASK_QUEUE_CAPACITY;
+	if (!full)
+	{
+		target->ranges[(target->front + target->count) % TASK_QUEUE_CAPACITY] = range;
+		++target->count;
+	}
+	SDL_UnlockMutex(target->mutex);
+	if (full)
+	{
+		return false;
+	}
+
+	//Counted before signalling so a worker checking under the lock can't miss it
+	mQueued.fetch_add(1);
+	SDL_LockMutex(mSleepMutex);
+	SDL_CondSignal(mWake);
+	SDL_UnlockMutex(mSleepMutex);
+	return true;
+}
+
+bool LTaskPool::take(int home, LTaskRange* range)
+{
+	int queues = (int)mQueues.size();
+	for (int i = 0; i < queues; ++i)
+	{
+		LTaskQueue* queue = mQueues[(home + i) % queues];
+		SDL_LockMutex(queue->mutex);
+		bool found = queue->count > 0;
+		if (found)
+		{
+			//Own work newest first while it is hot in cache, stolen work oldest first since it is the biggest
+			if (i == 0)
+			{
+				*range = queue->ranges[(queue->front + queue->count - 1) % TASK_QUEUE_CAPACITY];
+			}
+			else
+			{
+				*range = queue->ranges[queue->front];
+				queue->front = (queue->front + 1) % TASK_QUEUE_CAPACITY;
+			}
+			--queue->count;
+			mQueued.fetch_sub(1);
+		}
+		SDL_UnlockMutex(queue->mutex);
+		if (found)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void LTaskPool::run(int home, LTaskRange range)
+{
+	while (range.end - range.begin > 1)
+	{
+		int middle = range.begin + (range.end - range.begin) / 2;
+		LTaskRange upper = range;
+		upper.begin = middle;
+		if (!push(home, upper))
+		{
+			break;
+		}
+		range.end = middle;
+	}
+
+	for (int i = range.begin; i < range.end; ++i)
+	{
+		range.function(range.data, i);
+	}
+	range.remaining->fetch_sub(range.end - range.begin);
+}
+
+void LTaskPool::parallelFor(int count, LTaskFunction function, void* data)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	//Not started, run everything here
+	if (mQueues.empty())
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			function(data, i);
+		}
+		return;
+	}
+
+	std::atomic<int> remaining(count);
+	LTaskRange range = { function, data, 0, count, &remaining };
+	int home = (int)mQueues.size() - 1;
+	if (!push(home, range))
+	{
+		//Other callers filled the shared queue, start on it here
+		run(home, range);
+	}
+
+	//Help out until every index ran, the last ones may still be running elsewhere
+	while (remaining.load() > 0)
+	{
+		if (take(home, &range))
+		{
+			run(home, range);
+		}
+		else
+		{
+			SDL_Delay(0);
+		}
+	}
+}
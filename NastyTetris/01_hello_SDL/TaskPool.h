@@ -0,0 +1,96 @@
+#pragma once
+
+/* Headers */
+//Using SDL threads, STL atomic and vector
+#include <SDL.h>
+#include <atomic>
+#include <vector>
+
+
+
+/* Constants */
+
+//Most worker threads the pool starts, the thread calling parallelFor() works too
+const int TASK_POOL_MAX_THREADS = 63;
+
+//Ranges one queue holds, halving keeps a parallelFor() to a few dozen, a full queue runs ranges without splitting
+const int TASK_QUEUE_CAPACITY = 64;
+
+//Runs one index of a parallelFor()
+typedef void (*LTaskFunction)(void* data, int index);
+
+//Worker threads that split index ranges in half and steal halves from each other when they run dry
+class LTaskPool
+{
+public:
+	//Initializes variables
+	LTaskPool();
+
+	//Stops the workers
+	~LTaskPool();
+
+	//Starts one worker per core, minus the calling thread
+	bool start();
+
+	//Waits for the workers to finish
+	void stop();
+
+	//Gets the number of threads parallelFor() spreads over, the caller included
+	int getThreadCount() const;
+
+	//Calls function for every index below count and returns when all calls are done
+	//Safe to call from several threads at once, but not from inside a task
+	void parallelFor(int count, LTaskFunction function, void* data);
+
+private:
+	//Indices still to run
+	struct LTaskRange
+	{
+		LTaskFunction function;
+		void* data;
+		int begin;
+		int end;
+		std::atomic<int>* remaining;
+	};
+
+	//Ranges owned by one thread, the owner works on the back and thieves take from the front
+	//A fixed ring so pushing and taking never allocate
+	struct LTaskQueue
+	{
+		SDL_mutex* mutex;
+		LTaskRange ranges[TASK_QUEUE_CAPACITY];
+		int front;
+		int count;
+	};
+
+	//Worker entry point
+	static int workerThread(void* data);
+
+	//Runs ranges until stopped
+	void work(int home);
+
+	//Adds a range to a queue and wakes a sleeping worker, false when the queue is full
+	bool push(int queue, const LTaskRange& range);
+
+	//Takes a range from the home queue, or steals one from another queue
+	bool take(int home, LTaskRange* range);
+
+	//Splits off the upper halves for others to steal and runs what is left
+	void run(int home, LTaskRange range);
+
+	//One queue per worker and one shared by callers of parallelFor(), the last one
+	std::vector<LTaskQueue*> mQueues;
+	std::atomic<int> mQueued;
+
+	//Workers sleep on this while every queue is empty
+	SDL_mutex* mSleepMutex;
+	SDL_cond* mWake;
+	bool mQuit;
+
+	//Worker threads and the next queue a starting worker takes
+	std::vector<SDL_Thread*> mThreads;
+	std::atomic<int> mNextWorker;
+};
+
+//Threads shared by everything that wants to use all cores
+extern LTaskPool gTaskPool;
@@ -0,0 +1,346 @@
+/* Headers */
+#include "TextureImport.h"
+#include "AssetArchive.h"
+#include "PixelConvert.h"
+#include <SDL_image.h>
+#include <filesystem>
+#include <stdio.h>
+
+
+
+//Imports every image the game draws
+LTextureImporter gTextureImporter;
+
+LTextureImporter::LTextureImporter()
+{
+	//Initialize, straight alpha works on every renderer
+	mFormat = SDL_PIXELFORMAT_RGBA32;
+	mPremultiplied = false;
+	mBlendMode = SDL_BLENDMODE_BLEND;
+}
+
+void LTextureImporter::init(SDL_Renderer* renderer)
+{
+	//Take the first 32 bit byte order the renderer lists, it uploads without converting
+	mFormat = SDL_PIXELFORMAT_BGRA32;
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info) == 0)
+	{
+		for (Uint32 i = 0; i < info.num_texture_formats; ++i)
+		{
+			if (info.texture_formats[i] == SDL_PIXELFORMAT_BGRA32 || info.texture_formats[i] == SDL_PIXELFORMAT_RGBA32)
+			{
+				mFormat = info.texture_formats[i];
+				break;
+			}
+		}
+	}
+
+	//Source color is already scaled by alpha, so it is added as it is
+	SDL_BlendMode premultipliedMode = SDL_ComposeCustomBlendMode(
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+
+	//Renderers refuse custom blend modes they can't do, the software one does none
+	mPremultiplied = false;
+	mBlendMode = SDL_BLENDMODE_BLEND;
+	SDL_Texture* probe = SDL_CreateTexture(renderer, mFormat, SDL_TEXTUREACCESS_STATIC, 1, 1);
+	if (probe != NULL)
+	{
+		if (SDL_SetTextureBlendMode(probe, premultipliedMode) == 0)
+		{
+			mPremultiplied = true;
+			mBlendMode = premultipliedMode;
+		}
+		SDL_DestroyTexture(probe);
+	}
+}
+
+Uint32 LTextureImporter::getFormat() const
+{
+	return mFormat;
+}
+
+bool LTextureImporter::isPremultiplied() const
+{
+	return mPremultiplied;
+}
+
+SDL_BlendMode LTextureImporter::getBlendMode() const
+{
+	return mBlendMode;
+}
+
+SDL_Surface* LTextureImporter::importTexture(const std::string& path) const
+{
+	//Up to date conversion from an earlier run
+	Uint64 sourceSize = 0;
+	Sint64 sourceTime = 0;
+	bool stamped = getSourceStamp(path, &sourceSize, &sourceTime);
+	std::string cachePath = getCachePath(path, mFormat, mPremultiplied ? "premultiplied" : "keyed");
+	if (stamped)
+	{
+		SDL_Surface* cached = readCache(cachePath, mFormat, sourceSize, sourceTime);
+		if (cached != NULL)
+		{
+			return cached;
+		}
+	}
+
+	SDL_Surface* loadedSurface = loadSource(path);
+	if (loadedSurface == NULL)
+	{
+		return NULL;
+	}
+
+	//The kernel reads RGBA32, which also copies archive views out of the mapping
+	SDL_Surface* source = SDL_ConvertSurfaceFormat(loadedSurface, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_FreeSurface(loadedSurface);
+	SDL_Surface* converted = source != NULL ? SDL_CreateRGBSurfaceWithFormat(0, source->w, source->h, 32, mFormat) : NULL;
+	if (converted == NULL)
+	{
+		printf("Unable to convert image %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+		SDL_FreeSurface(source);
+		return NULL;
+	}
+
+	//Key, premultiply and reorder a row at a time
+	SDL_LockSurface(source);
+	SDL_LockSurface(converted);
+	for (int y = 0; y < source->h; ++y)
+	{
+		const Uint32* in = (const Uint32*)((const Uint8*)source->pixels + (size_t)y * source->pitch);
+		Uint32* out = (Uint32*)((Uint8*)converted->pixels + (size_t)y * converted->pitch);
+		convertPixels(in, out, source->w, mFormat, mPremultiplied);
+	}
+	SDL_UnlockSurface(converted);
+	SDL_UnlockSurface(source);
+	SDL_FreeSurface(source);
+
+	if (stamped)
+	{
+		writeCache(cachePath, converted, sourceSize, sourceTime);
+	}
+	return converted;
+}
+
+SDL_Surface* LTextureImporter::importSurface(const std::string& path, Uint32 format) const
+{
+	//Up to date conversion from an earlier run
+	Uint64 sourceSize = 0;
+	Sint64 sourceTime = 0;
+	bool stamped = getSourceStamp(path, &sourceSize, &sourceTime);
+	std::string cachePath = getCachePath(path, format, "surface");
+	if (stamped)
+	{
+		SDL_Surface* cached = readCache(cachePath, format, sourceSize, sourceTime);
+		if (cached != NULL)
+		{
+			return cached;
+		}
+	}
+
+	SDL_Surface* loadedSurface = loadSource(path);
+	if (loadedSurface == NULL)
+	{
+		return NULL;
+	}
+
+	//Any format SDL knows, surfaces aren't keyed
+	SDL_Surface* converted = SDL_ConvertSurfaceFormat(loadedSurface, format, 0);
+	SDL_FreeSurface(loadedSurface);
+	if (converted == NULL)
+	{
+		printf("Unable to convert image %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+		return NULL;
+	}
+
+	if (stamped)
+	{
+		writeCache(cachePath, converted, sourceSize, sourceTime);
+	}
+	return converted;
+}
+
+SDL_Texture* LTextureImporter::createTexture(SDL_Renderer* renderer, const std::string& path, int* width, int* height) const
+{
+	SDL_Surface* surface = importTexture(path);
+	if (surface == NULL)
+	{
+		return NULL;
+	}
+
+	//Pixels are already in the texture's format, the upload is a plain copy
+	SDL_Texture* texture = SDL_CreateTexture(renderer, mFormat, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+	if (texture == NULL)
+	{
+		printf("Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+	}
+	else
+	{
+		SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
+		SDL_SetTextureBlendMode(texture, mBlendMode);
+		if (width != NULL)
+		{
+			*width = surface->w;
+		}
+		if (height != NULL)
+		{
+			*height = surface->h;
+		}
+	}
+	SDL_FreeSurface(surface);
+	return texture;
+}
+
+SDL_Surface* LTextureImporter::loadSource(const std::string& path)
+{
+	//From the mapped archive when it was packed
+	SDL_Surface* loadedSurface = gAssets.createSurface(path);
+	if (loadedSurface == NULL)
+	{
+		loadedSurface = IMG_Load(path.c_str());
+		if (loadedSurface == NULL)
+		{
+			printf("Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+		}
+	}
+	return loadedSurface;
+}
+
+bool LTextureImporter::getSourceStamp(const std::string& path, Uint64* size, Sint64* time)
+{
+	//Archived pixels can change without their size or place in the archive changing, the packer hashed them
+	const LAssetEntry* entry = gAssets.find(path);
+	if (entry != NULL)
+	{
+		*size = entry->size;
+		*time = (Sint64)entry->hash;
+		return true;
+	}
+
+	std::error_code error;
+	std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+	if (error)
+	{
+		return false;
+	}
+	std::filesystem::file_time_type fileTime = std::filesystem::last_write_time(path, error);
+	if (error)
+	{
+		return false;
+	}
+	*size = (Uint64)fileSize;
+	*time = (Sint64)fileTime.time_since_epoch().count();
+	return true;
+}
+
+std::string LTextureImporter::getCachePath(const std::string& path, Uint32 format, const char* kind)
+{
+	//One flat directory, path separators would need their own directories
+	std::string name = path;
+	for (size_t i = 0; i < name.size(); ++i)
+	{
+		if (name[i] == '/' || name[i] == '\\' || name[i] == ':')
+		{
+			name[i] = '_';
+		}
+	}
+
+	char suffix[64];
+	SDL_snprintf(suffix, sizeof(suffix), ".%08x.%s.tex", format, kind);
+	return std::string(TEXTURE_CACHE_DIRECTORY) + "/" + name + suffix;
+}
+
+SDL_Surface* LTextureImporter::readCache(const std::string& cachePath, Uint32 format, Uint64 sourceSize, Sint64 sourceTime)
+{
+	SDL_RWops* file = SDL_RWFromFile(cachePath.c_str(), "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	//Anything that doesn't match is converted again and overwritten
+	LTextureCacheHeader header;
+	SDL_Surface* surface = NULL;
+	if (SDL_RWread(file, &header, sizeof(header), 1) == 1 &&
+		header.magic == TEXTURE_CACHE_MAGIC && header.version == TEXTURE_CACHE_VERSION && header.format == format &&
+		header.sourceSize == sourceSize && header.sourceTime == sourceTime &&
+		header.width > 0 && header.height > 0 && header.pitch == header.width * (Sint32)SDL_BYTESPERPIXEL(format) &&
+		(Sint64)sizeof(header) + (Sint64)header.pitch * header.height == SDL_RWsize(file))
+	{
+		surface = SDL_CreateRGBSurfaceWithFormat(0, header.width, header.height, SDL_BITSPERPIXEL(format), format);
+	}
+
+	if (surface != NULL)
+	{
+		//Rows straight into the surface, one read when the pitches agree
+		bool complete = true;
+		SDL_LockSurface(surface);
+		if (surface->pitch == header.pitch)
+		{
+			complete = SDL_RWread(file, surface->pixels, (size_t)header.pitch * header.height, 1) == 1;
+		}
+		else
+		{
+			for (int y = 0; y < header.height && complete; ++y)
+			{
+				complete = SDL_RWread(file, (Uint8*)surface->pixels + (size_t)y * surface->pitch, header.pitch, 1) == 1;
+			}
+		}
+		SDL_UnlockSurface(surface);
+
+		if (!complete)
+		{
+			SDL_FreeSurface(surface);
+			surface = NULL;
+		}
+	}
+	SDL_RWclose(file);
+	return surface;
+}
+
+void LTextureImporter::writeCache(const std::string& cachePath, SDL_Surface* surface, Uint64 sourceSize, Sint64 sourceTime)
+{
+	std::error_code error;
+	std::filesystem::create_directories(TEXTURE_CACHE_DIRECTORY, error);
+
+	//Written aside and renamed over, so another thread importing the same image never reads half a file
+	char suffix[32];
+	SDL_snprintf(suffix, sizeof(suffix), ".%lu.tmp", SDL_ThreadID());
+	std::string temporaryPath = cachePath + suffix;
+	SDL_RWops* file = SDL_RWFromFile(temporaryPath.c_str(), "wb");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	LTextureCacheHeader header;
+	header.magic = TEXTURE_CACHE_MAGIC;
+	header.version = TEXTURE_CACHE_VERSION;
+	header.format = surface->format->format;
+	header.width = surface->w;
+	header.height = surface->h;
+	header.pitch = surface->w * surface->format->BytesPerPixel;
+	header.sourceSize = sourceSize;
+	header.sourceTime = sourceTime;
+
+	bool complete = SDL_RWwrite(file, &header, sizeof(header), 1) == 1;
+	SDL_LockSurface(surface);
+	for (int y = 0; y < surface->h && complete; ++y)
+	{
+		complete = SDL_RWwrite(file, (const Uint8*)surface->pixels + (size_t)y * surface->pitch, header.pitch, 1) == 1;
+	}
+	SDL_UnlockSurface(surface);
+	complete = SDL_RWclose(file) == 0 && complete;
+
+	if (complete)
+	{
+		std::filesystem::rename(temporaryPath, cachePath, error);
+		complete = !error;
+	}
+	if (!complete)
+	{
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+/* Headers */
+//Using SDL and STL string
+#include <SDL.h>
+#include <string>
+
+
+
+/* Constants */
+
+//Where converted images are kept between runs
+const char* const TEXTURE_CACHE_DIRECTORY = "cache/textures";
+
+//Identifies cache files, bump the version when their layout or the conversion changes
+const Uint32 TEXTURE_CACHE_MAGIC = 0x4349544E;
+const Uint32 TEXTURE_CACHE_VERSION = 2;
+
+//Cache file header, followed by height rows of pitch bytes
+struct LTextureCacheHeader
+{
+	Uint32 magic;
+	Uint32 version;
+	Uint32 format;
+	Sint32 width;
+	Sint32 height;
+	Sint32 pitch;
+
+	//Size and modification time of the source file, or size and hash of the archive entry's bytes
+	Uint64 sourceSize;
+	Sint64 sourceTime;
+};
+
+//Turns color keyed images into pixels the renderer takes as they are
+//Each image is keyed, premultiplied and put in the renderer's byte order once, later runs read the result back from the cache
+class LTextureImporter
+{
+public:
+	//Initializes variables
+	LTextureImporter();
+
+	//Picks the texture format and checks whether the renderer blends premultiplied alpha, falls back to straight alpha if not
+	//Call before any image is imported
+	void init(SDL_Renderer* renderer);
+
+	//Gets the pixel format imported images come in, RGBA32 or BGRA32
+	Uint32 getFormat() const;
+
+	//Checks whether imported images have their color multiplied by alpha
+	bool isPremultiplied() const;
+
+	//Gets the blend mode imported images draw with in place of SDL_BLENDMODE_BLEND
+	SDL_BlendMode getBlendMode() const;
+
+	//Gets a color keyed image in the texture format, safe to call from any thread
+	SDL_Surface* importTexture(const std::string& path) const;
+
+	//Gets an image converted to a surface format without keying, for blits to the window surface
+	SDL_Surface* importSurface(const std::string& path, Uint32 format) const;
+
+	//Uploads an imported image to a static texture with the import blend mode
+	SDL_Texture* createTexture(SDL_Renderer* renderer, const std::string& path, int* width, int* height) const;
+
+private:
+	//Decodes an image from the archive or a loose file
+	static SDL_Surface* loadSource(const std::string& path);
+
+	//Gets what identifies the current version of a source image, false if there is none
+	static bool getSourceStamp(const std::string& path, Uint64* size, Sint64* time);
+
+	//Builds the cache file name for an image in a format, kind tells apart conversions to the same format
+	static std::string getCachePath(const std::string& path, Uint32 format, const char* kind);
+
+	//Reads a cached conversion, NULL when missing or out of date
+	static SDL_Surface* readCache(const std::string& cachePath, Uint32 format, Uint64 sourceSize, Sint64 sourceTime);
+
+	//Writes a conversion to the cache, failures only cost the next run a conversion
+	static void writeCache(const std::string& cachePath, SDL_Surface* surface, Uint64 sourceSize, Sint64 sourceTime);
+
+	//Texture byte order and blending picked by init()
+	Uint32 mFormat;
+	bool mPremultiplied;
+	SDL_BlendMode mBlendMode;
+};
+
+//Imports every image the game draws
+extern LTextureImporter gTextureImporter;
@@ -0,0 +1,150 @@
+/* Headers */
+#include "Tournament.h"
+#include "TaskPool.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+LTournament::LTournament()
+{
+	//Initialize
+	mGamesPerEntry = 0;
+	mSeed = 0;
+	mMaxPieces = TOURNAMENT_DEFAULT_PIECES;
+	mSeconds = 0.0;
+	mThreads = 0;
+}
+
+int LTournament::addEntry(const LBotWeights& weights)
+{
+	mEntries.push_back(weights);
+	return (int)mEntries.size() - 1;
+}
+
+void LTournament::run(int games, Uint32 seed, int maxPieces)
+{
+	mGamesPerEntry = games > 0 ? games : 0;
+	mSeed = seed;
+	mMaxPieces = maxPieces;
+
+	//Every slot exists before the first game starts, nothing allocates while games run
+	mGames.assign(mEntries.size() * mGamesPerEntry, LTournamentGame());
+
+	mThreads = gTaskPool.getThreadCount();
+	Uint64 start = SDL_GetPerformanceCounter();
+	gTaskPool.parallelFor((int)mGames.size(), playGame, this);
+	mSeconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+void LTournament::playGame(void* data, int index)
+{
+	LTournament* tournament = (LTournament*)data;
+	int entry = index / tournament->mGamesPerEntry;
+	Uint32 seed = tournament->mSeed + index % tournament->mGamesPerEntry;
+
+	//Game and bot live on this thread's stack for the whole game
+	LGame game;
+	game.reset(seed);
+	LBotPlayer bot;
+	bot.setActionInterval(1);
+	bot.setWeights(tournament->mEntries[entry]);
+	bot.setParallelSearch(false);
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	while (!game.isOver() && game.getStats().pieces < tournament->mMaxPieces)
+	{
+		game.step(bot.getActions(game));
+	}
+	Uint64 end = SDL_GetPerformanceCounter();
+
+	const LGameStats& stats = game.getStats();
+	LTournamentGame& result = tournament->mGames[index];
+	result.entry = entry;
+	result.seed = seed;
+	result.survived = !game.isOver();
+	result.pieces = stats.pieces;
+	result.lines = stats.lines;
+	result.garbageSent = stats.garbageSent;
+	result.tSpins = stats.tSpins;
+	result.maxCombo = stats.maxCombo;
+	result.score = stats.score;
+	result.ticks = stats.ticks;
+	result.milliseconds = (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+const std::vector<LTournamentGame>& LTournament::getGames() const
+{
+	return mGames;
+}
+
+LTournamentTotals LTournament::getTotals(int entry) const
+{
+	LTournamentTotals totals;
+	memset(&totals, 0, sizeof(totals));
+	for (size_t i = 0; i < mGames.size(); ++i)
+	{
+		const LTournamentGame& game = mGames[i];
+		if (game.entry != entry)
+		{
+			continue;
+		}
+		++totals.games;
+		totals.survived += game.survived ? 1 : 0;
+		totals.pieces += game.pieces;
+		totals.lines += game.lines;
+		totals.garbageSent += game.garbageSent;
+		totals.tSpins += game.tSpins;
+		totals.score += game.score;
+	}
+	return totals;
+}
+
+bool LTournament::writeCSV(const char* path) const
+{
+	SDL_RWops* file = SDL_RWFromFile(path, "wb");
+	if (file == NULL)
+	{
+		printf("Unable to write tournament results %s! SDL Error: %s\n", path, SDL_GetError());
+		return false;
+	}
+
+	//Weights go on every line so files from different runs can be concatenated
+	const char* header = "entry,height,holes,bumpiness,transitions,danger_height,danger,seed,survived,pieces,lines,garbage_sent,t_spins,max_combo,score,ticks,ms\n";
+	SDL_RWwrite(file, header, 1, strlen(header));
+	for (size_t i = 0; i < mGames.size(); ++i)
+	{
+		const LTournamentGame& game = mGames[i];
+		const LBotWeights& weights = mEntries[game.entry];
+		char line[256];
+		int length = SDL_snprintf(line, sizeof(line), "%d,%d,%d,%d,%d,%d,%d,%u,%d,%d,%d,%d,%d,%d,%d,%llu,%.2f\n",
+			game.entry, weights.height, weights.holes, weights.bumpiness, weights.transitions, weights.dangerHeight, weights.danger,
+			(unsigned int)game.seed, game.survived ? 1 : 0, game.pieces, game.lines, game.garbageSent, game.tSpins, game.maxCombo, game.score,
+			(unsigned long long)game.ticks, game.milliseconds);
+		SDL_RWwrite(file, line, 1, length < (int)sizeof(line) ? length : sizeof(line) - 1);
+	}
+	SDL_RWclose(file);
+
+	printf("Wrote %d tournament games to %s\n", (int)mGames.size(), path);
+	return true;
+}
+
+void LTournament::printSummary() const
+{
+	Uint64 totalPieces = 0;
+	for (size_t entry = 0; entry < mEntries.size(); ++entry)
+	{
+		LTournamentTotals totals = getTotals((int)entry);
+		const LBotWeights& weights = mEntries[entry];
+		double games = totals.games > 0 ? (double)totals.games : 1.0;
+		printf("Entry %d (%d,%d,%d,%d,%d,%d): %d/%d survived, %.1f lines, %.1f pieces, %.1f garbage, %.3f lines/piece\n", (int)entry,
+			weights.height, weights.holes, weights.bumpiness, weights.transitions, weights.dangerHeight, weights.danger,
+			totals.survived, totals.games, totals.lines / games, totals.pieces / games, totals.garbageSent / games,
+			totals.pieces > 0 ? (double)totals.lines / (double)totals.pieces : 0.0);
+		totalPieces += totals.pieces;
+	}
+
+	double seconds = mSeconds > 0.0 ? mSeconds : 1e-9;
+	printf("Tournament: %d games in %.3f s on %d threads, %.1f games/s, %.0f pieces/s\n", (int)mGames.size(), mSeconds,
+		mThreads, mGames.size() / seconds, totalPieces / seconds);
+}
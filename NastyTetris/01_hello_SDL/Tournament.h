@@ -0,0 +1,91 @@
+#pragma once
+
+/* Headers */
+//Using SDL, the search bot and STL vector
+#include <SDL.h>
+#include <vector>
+#include "Bot.h"
+
+
+
+/* Constants */
+
+//Pieces a tournament game lasts unless the bot tops out first
+const int TOURNAMENT_DEFAULT_PIECES = 500;
+
+//Where tournament results go by default
+const char* const TOURNAMENT_DEFAULT_CSV = "tournament.csv";
+
+//Outcome of one tournament game
+struct LTournamentGame
+{
+	int entry;
+	Uint32 seed;
+	bool survived;
+	int pieces;
+	int lines;
+	int garbageSent;
+	int tSpins;
+	int maxCombo;
+	int score;
+	Uint64 ticks;
+	double milliseconds;
+};
+
+//Totals of every game one weight set played
+struct LTournamentTotals
+{
+	int games;
+	int survived;
+	Uint64 pieces;
+	Uint64 lines;
+	Uint64 garbageSent;
+	Uint64 tSpins;
+	Uint64 score;
+};
+
+//Plays the same seeded games with several weight sets, every game a task on the shared task pool
+//Games run their searches serially on the thread that plays them, so all cores stay busy with whole games
+class LTournament
+{
+public:
+	//Initializes variables
+	LTournament();
+
+	//Adds a weight set to the next run, returns its index
+	int addEntry(const LBotWeights& weights);
+
+	//Plays games seeded seed to seed + games - 1 with every entry, each one stops after maxPieces
+	void run(int games, Uint32 seed, int maxPieces);
+
+	//Gets the outcome of every game of the last run, entry by entry
+	const std::vector<LTournamentGame>& getGames() const;
+
+	//Sums the games an entry played
+	LTournamentTotals getTotals(int entry) const;
+
+	//Writes one line per game
+	bool writeCSV(const char* path) const;
+
+	//Prints the totals of every entry and how fast the run went
+	void printSummary() const;
+
+private:
+	//Task pool entry point, plays one game into its slot
+	static void playGame(void* data, int index);
+
+	//Weight sets playing
+	std::vector<LBotWeights> mEntries;
+
+	//Results, sized before the run so games only write their own slot
+	std::vector<LTournamentGame> mGames;
+
+	//Run settings
+	int mGamesPerEntry;
+	Uint32 mSeed;
+	int mMaxPieces;
+
+	//How the last run went
+	int mThreads;
+	double mSeconds;
+};
@@ -0,0 +1,238 @@
+/* Headers */
+#include "UIRouter.h"
+#include <algorithm>
+
+
+
+//Router for every on screen widget
+LUIRouter gUIRouter;
+
+LWidget::LWidget()
+{
+	//Initialize
+	mBounds.x = 0;
+	mBounds.y = 0;
+	mBounds.w = 0;
+	mBounds.h = 0;
+}
+
+LWidget::~LWidget()
+{
+}
+
+const SDL_Rect& LWidget::getBounds() const
+{
+	return mBounds;
+}
+
+void LWidget::onEnter()
+{
+}
+
+void LWidget::onLeave()
+{
+}
+
+void LWidget::onMotion(int, int)
+{
+}
+
+void LWidget::onPress(int, int, Uint8)
+{
+}
+
+void LWidget::onRelease(int, int, Uint8)
+{
+}
+
+LUIRouter::LUIRouter()
+{
+	//Initialize
+	mColumns = 1;
+	mRows = 1;
+	mDirty = true;
+	mHover = NULL;
+}
+
+void LUIRouter::setArea(int width, int height)
+{
+	mColumns = std::max(1, (width + UI_GRID_CELL_SIZE - 1) / UI_GRID_CELL_SIZE);
+	mRows = std::max(1, (height + UI_GRID_CELL_SIZE - 1) / UI_GRID_CELL_SIZE);
+	mDirty = true;
+}
+
+void LUIRouter::add(LWidget* widget)
+{
+	if (std::find(mWidgets.begin(), mWidgets.end(), widget) == mWidgets.end())
+	{
+		mWidgets.push_back(widget);
+		mDirty = true;
+	}
+}
+
+void LUIRouter::remove(LWidget* widget)
+{
+	std::vector<LWidget*>::iterator it = std::find(mWidgets.begin(), mWidgets.end(), widget);
+	if (it != mWidgets.end())
+	{
+		mWidgets.erase(it);
+		mDirty = true;
+	}
+	if (mHover == widget)
+	{
+		mHover = NULL;
+	}
+}
+
+void LUIRouter::clear()
+{
+	mWidgets.clear();
+	mHover = NULL;
+	mDirty = true;
+}
+
+void LUIRouter::invalidate()
+{
+	mDirty = true;
+}
+
+void LUIRouter::rebuild()
+{
+	//Two passes, count what lands in each cell then fill, so every cell is one contiguous run
+	int cells = mColumns * mRows;
+	mCellStart.assign(cells + 1, 0);
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		if (pass == 1)
+		{
+			//Counts become run starts, each cell fills from its start
+			for (int i = 0; i < cells; ++i)
+			{
+				mCellStart[i + 1] += mCellStart[i];
+			}
+			mCellWidgets.resize(mCellStart[cells]);
+		}
+		std::vector<int> fill(mCellStart.begin(), mCellStart.end() - 1);
+
+		for (int index = 0; index < (int)mWidgets.size(); ++index)
+		{
+			const SDL_Rect& bounds = mWidgets[index]->getBounds();
+			if (bounds.w <= 0 || bounds.h <= 0)
+			{
+				continue;
+			}
+			int left = std::min(std::max(bounds.x / UI_GRID_CELL_SIZE, 0), mColumns - 1);
+			int right = std::min(std::max((bounds.x + bounds.w - 1) / UI_GRID_CELL_SIZE, 0), mColumns - 1);
+			int top = std::min(std::max(bounds.y / UI_GRID_CELL_SIZE, 0), mRows - 1);
+			int bottom = std::min(std::max((bounds.y + bounds.h - 1) / UI_GRID_CELL_SIZE, 0), mRows - 1);
+			for (int row = top; row <= bottom; ++row)
+			{
+				for (int column = left; column <= right; ++column)
+				{
+					int cell = row * mColumns + column;
+					if (pass == 0)
+					{
+						++mCellStart[cell + 1];
+					}
+					else
+					{
+						mCellWidgets[fill[cell]++] = index;
+					}
+				}
+			}
+		}
+	}
+	mDirty = false;
+}
+
+LWidget* LUIRouter::hitTest(int x, int y)
+{
+	if (mDirty)
+	{
+		rebuild();
+	}
+
+	//Points off the grid still land in a border cell, the bounds check below sorts them out
+	int column = std::min(std::max(x / UI_GRID_CELL_SIZE, 0), mColumns - 1);
+	int row = std::min(std::max(y / UI_GRID_CELL_SIZE, 0), mRows - 1);
+	int cell = row * mColumns + column;
+
+	//Topmost first
+	SDL_Point point = { x, y };
+	for (int i = mCellStart[cell + 1] - 1; i >= mCellStart[cell]; --i)
+	{
+		LWidget* widget = mWidgets[mCellWidgets[i]];
+		if (SDL_PointInRect(&point, &widget->getBounds()))
+		{
+			return widget;
+		}
+	}
+	return NULL;
+}
+
+bool LUIRouter::handleEvent(const SDL_Event& e)
+{
+	//Pointer left the window, nothing is hovered anymore
+	if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_LEAVE)
+	{
+		if (mHover != NULL)
+		{
+			mHover->onLeave();
+			mHover = NULL;
+		}
+		return false;
+	}
+
+	//Position comes with the event, no need to ask SDL for the mouse state
+	int x = 0;
+	int y = 0;
+	if (e.type == SDL_MOUSEMOTION)
+	{
+		x = e.motion.x;
+		y = e.motion.y;
+	}
+	else if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP)
+	{
+		x = e.button.x;
+		y = e.button.y;
+	}
+	else
+	{
+		return false;
+	}
+
+	//Only the widget left behind and the one entered hear about the move
+	LWidget* hit = hitTest(x, y);
+	if (hit != mHover)
+	{
+		if (mHover != NULL)
+		{
+			mHover->onLeave();
+		}
+		mHover = hit;
+		if (hit != NULL)
+		{
+			hit->onEnter();
+		}
+	}
+	if (hit == NULL)
+	{
+		return false;
+	}
+
+	switch (e.type)
+	{
+	case SDL_MOUSEMOTION:
+		hit->onMotion(x, y);
+		break;
+
+	case SDL_MOUSEBUTTONDOWN:
+		hit->onPress(x, y, e.button.button);
+		break;
+
+	case SDL_MOUSEBUTTONUP:
+		hit->onRelease(x, y, e.button.button);
+		break;
+	}
+	return true;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+/* Headers */
+//Using SDL and STL vector
+#include <SDL.h>
+#include <vector>
+
+
+
+/* Constants */
+
+//Side of one hit test grid cell in pixels
+const int UI_GRID_CELL_SIZE = 32;
+
+//Something on screen that takes mouse input, the router calls it only when the pointer is on it or just left it
+class LWidget
+{
+public:
+	//Initializes variables
+	LWidget();
+
+	//Deallocates nothing, lets derived widgets clean up
+	virtual ~LWidget();
+
+	//Gets the screen rectangle events are routed by
+	const SDL_Rect& getBounds() const;
+
+	//Pointer moved onto or off the widget
+	virtual void onEnter();
+	virtual void onLeave();
+
+	//Pointer moved while on the widget, in window coordinates
+	virtual void onMotion(int x, int y);
+
+	//Mouse button went down or up while on the widget
+	virtual void onPress(int x, int y, Uint8 button);
+	virtual void onRelease(int x, int y, Uint8 button);
+
+protected:
+	//Screen rectangle, call LUIRouter::invalidate() after moving a registered widget
+	SDL_Rect mBounds;
+};
+
+//Sends mouse events to the one widget under the pointer
+//Widgets are bucketed into a uniform grid over the screen, a hit test only looks at the widgets overlapping one cell
+class LUIRouter
+{
+public:
+	//Initializes variables
+	LUIRouter();
+
+	//Sets the area the grid covers, widgets outside it are clamped to its border cells
+	void setArea(int width, int height);
+
+	//Registers a widget, later ones are on top of earlier ones
+	void add(LWidget* widget);
+
+	//Unregisters a widget
+	void remove(LWidget* widget);
+
+	//Unregisters every widget
+	void clear();
+
+	//Rebuilds the grid before the next event, for widgets that moved
+	void invalidate();
+
+	//Gets the topmost widget at a point, NULL when there is none
+	LWidget* hitTest(int x, int y);
+
+	//Routes a mouse event using the coordinates it carries, true if a widget got it
+	bool handleEvent(const SDL_Event& e);
+
+private:
+	//Buckets every widget into the cells its bounds overlap
+	void rebuild();
+
+	//Registered widgets in stacking order
+	std::vector<LWidget*> mWidgets;
+
+	//Grid size in cells
+	int mColumns;
+	int mRows;
+
+	//Widgets of cell i are mCellWidgets[mCellStart[i]] up to mCellStart[i + 1], bottom to top
+	std::vector<int> mCellStart;
+	std::vector<int> mCellWidgets;
+	bool mDirty;
+
+	//Widget under the pointer
+	LWidget* mHover;
+};
+
+//Router for every on screen widget
+extern LUIRouter gUIRouter;
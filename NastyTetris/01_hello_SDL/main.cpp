@@ -8,7 +8,37 @@ and may not be redistributed without written permission.*/
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <string>
+#include <vector>
+#include "Game.h"
+#include "LTexture.h"
+#include "Atlas.h"
+#include "SpriteBatch.h"
+#include "GlyphCache.h"
+#include "AssetArchive.h"
+#include "AssetLoader.h"
+#include "ResourceManager.h"
+#include "Profiler.h"
+#include "RenderLayer.h"
+#include "Replay.h"
+#include "TaskPool.h"
+#include "Bot.h"
+#include "BoardEval.h"
+#include "Tournament.h"
+#include "Memory.h"
+#include "Particles.h"
+#include "Input.h"
+#include "UIRouter.h"
+#include "Button.h"
+#include "Menu.h"
+#include "Simulation.h"
+#include "FrameScheduler.h"
+#include "Benchmark.h"
+#include "BoardTexture.h"
+#include "TextureImport.h"
+#include "PixelConvert.h"
 
 
 
@@ -18,6 +48,60 @@ and may not be redistributed without written permission.*/
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 480;
 
+//Playfield layout constants
+const int CELL_SIZE = 20;
+const int PREVIEW_CELL_SIZE = 12;
+const int BOARD_SCREEN_X = (SCREEN_WIDTH - BOARD_WIDTH * CELL_SIZE) / 2;
+const int BOARD_SCREEN_Y = (SCREEN_HEIGHT - BOARD_VISIBLE_HEIGHT * CELL_SIZE) / 2;
+const int HUD_X = 20;
+const int HUD_Y = BOARD_SCREEN_Y + 6 * PREVIEW_CELL_SIZE;
+
+//Pieces a headless game with the search bot lasts
+const int HEADLESS_BOT_PIECES = 1000;
+
+//Line clear popups, how many show at once and how long each floats up
+const int MAX_POPUPS = 8;
+const int POPUP_LIFETIME_TICKS = LOGIC_TICK_RATE;
+const int POPUP_RISE = 2 * CELL_SIZE;
+
+//Particle effects, how many each cleared cell and each column of a hard drop gives off
+const int LINE_CLEAR_PARTICLES_PER_CELL = 24;
+const int DROP_PARTICLES_PER_COLUMN = 12;
+const int DROP_PARTICLE_CAPACITY = 4096;
+
+//Particles the P key adds to see what the renderer takes
+const int PARTICLE_STRESS_COUNT = 50000;
+
+//How often the profiler overlay updates while the menu idles
+const int FRAME_OVERLAY_REFRESH_MS = 250;
+
+//Boards and passes over them for --bench-eval
+const int EVAL_BENCHMARK_BOARDS = 4096;
+const int EVAL_BENCHMARK_ITERATIONS = 200;
+
+//Images, text and board the --bench-render cases work on, and where results are compared to by default
+const char* const RENDER_BENCHMARK_IMAGE = "assets/images/background.png";
+const char* const RENDER_BENCHMARK_SPRITE = "assets/images/foo.png";
+const char* const RENDER_BENCHMARK_TEXT = "Score 1234567";
+const char* const RENDER_BENCHMARK_BASELINE_PATH = "render_baseline.json";
+const int RENDER_BENCHMARK_SPRITES = 64;
+const int RENDER_BENCHMARK_PIECES = 40;
+const int RENDER_BENCHMARK_PIXELS = 256 * 256;
+const Uint32 RENDER_BENCHMARK_SEED = 12345;
+
+//Piece colors, the extra entry is garbage
+const SDL_Color gPieceColors[PIECE_TOTAL + 1] =
+{
+	{ 0x00, 0xF0, 0xF0, 0xFF },
+	{ 0xF0, 0xF0, 0x00, 0xFF },
+	{ 0xA0, 0x00, 0xF0, 0xFF },
+	{ 0x00, 0xF0, 0x00, 0xFF },
+	{ 0xF0, 0x00, 0x00, 0xFF },
+	{ 0x00, 0x00, 0xF0, 0xFF },
+	{ 0xF0, 0xA0, 0x00, 0xFF },
+	{ 0x80, 0x80, 0x80, 0xFF }
+};
+
 
 //Key press surfaces constants
 //Default to start counting at 0 and go up by one for each enumeration declared
@@ -34,12 +118,26 @@ enum KeyPressSurfaces
 //Starts up SDL and creates window
 bool init();
 
-//Loads media
+//Queues images for the atlas and the rest of the media on the asset loader
 bool loadMedia();
 
 //Frees media and shuts down SDL
 void close();
 
+//Plays games without a window as fast as the CPU allows, saving each one as a replay if given a prefix
+//With bot set the search bot plays instead of the quick greedy one
+int runHeadless(int games, Uint32 seed, const char* recordPrefix, bool bot);
+
+//Plays replays back without a window and checks each ends in the recorded state
+int runReplays(const std::vector<std::string>& paths);
+
+//Plays the same seeded bot games with every weight set on all cores and writes the results as CSV
+int runTournament(int games, Uint32 seed, int pieces, const std::vector<LBotWeights>& weights, const char* csvPath);
+
+//Times loading and drawing under SDL's software renderer, offscreen unless SDL_VIDEODRIVER says otherwise
+//Compares with a baseline and fails on a regression when there is one, saves the results as the new baseline if given a path
+int runRenderBenchmark(const char* baselinePath, const char* savePath, double tolerance);
+
 /* Global Variables */
 //The window we'll be rendering to
 SDL_Window* gWindow = NULL;
@@ -48,10 +146,10 @@ SDL_Window* gWindow = NULL;
 SDL_Surface* gScreenSurface = NULL;
 
 //The image we will load and show on the screen
-SDL_Surface* gHelloWorld = NULL;
+LSurfaceHandle gHelloWorld;
 
-//Loads individual image
-SDL_Surface* loadSurface(std::string path);
+//Loads individual image in the screen format
+LSurfaceHandle loadSurface(const std::string& path);
 
 //Current displayed image
 SDL_Surface* gCurrentSurface = NULL;
@@ -62,106 +160,25 @@ SDL_Surface* gStretchedSurface = NULL;
 /***Texture hardware based rendering***/
 
 //Loads individual image as texture
-SDL_Texture* loadTexture(std::string path);
+LTextureHandle loadTexture(const std::string& path);
 
 //The window renderer
 SDL_Renderer* gRenderer = NULL;
 
 //Current displayed texture
-SDL_Texture* gTexture = NULL;
+LTextureHandle gTexture;
 
-//Globally used font
+//Globally used font, kept open by its handle
 TTF_Font* gFont = NULL;
+LFontHandle gFontHandle;
 
+//Whether presents wait for the display refresh
+bool gVsync = true;
 
 
-/************************************/
-
-//Button constants
-const int BUTTON_WIDTH = 300;
-const int BUTTON_HEIGHT = 200;
-const int TOTAL_BUTTONS = 4;
-
-enum LButtonSprite
-{
-	BUTTON_SPRITE_MOUSE_OUT = 0,
-	BUTTON_SPRITE_MOUSE_OVER_MOTION = 1,
-	BUTTON_SPRITE_MOUSE_DOWN = 2,
-	BUTTON_SPRITE_MOUSE_UP = 3,
-	BUTTON_SPRITE_TOTAL = 4
-};
-
-//Mouse button sprites
-SDL_Rect gSpriteClips[BUTTON_SPRITE_TOTAL];
-
-//Texture wrapper class
-class LTexture
-{
-public:
-	//Initializes variables
-	LTexture();
-
-	//Deallocates memory
-	~LTexture();
-
-	//Loads image ad specified path
-	bool loadFromFile(std::string path);
-
-	//Creates image from font string
-#if defined(SDL_TTF_MAJOR_VERSION)
-	bool loadFromRenderedText(std::string textureText, SDL_Color textColor);
-#endif
-
-	//Deallocates texture
-	void free();
-
-	//Set color modulation
-	void setColor(Uint8 red, Uint8 green, Uint8 blue);
-
-	//Set blending
-	void setBlendMode(SDL_BlendMode blending);
-
-	//Set alpha modulation
-	void setAlpha(Uint8 alpha);
-
-	//Renders texture at given point
-	void render(int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE);
-
-	//Gets image dimensions
-	int getWidth();
-	int getHeight();
 
-private:
-	//The actual hardware texture
-	SDL_Texture* mTexture;
-
-	//Image dimensions
-	int mWidth;
-	int mHeight;
-};
+/************************************/
 
-//The mouse button
-class LButton
-{
-public:
-	//Initializes internal variables
-	LButton();
-	
-	//Sets top left position
-	void setPosition(int x, int y);
-
-	//Handles mouse event
-	void handleEvent(SDL_Event* e);
-
-	//Shows button sprite
-	void render();
-private:
-	//Top left position
-	SDL_Point mPosition;
-
-	//Currently used global sprite
-	LButtonSprite mCurrentSprite;
-};
 
 
 
@@ -173,236 +190,60 @@ LTexture gArrowTexture;
 
 //Rendered Texture
 LTexture gTextTexture;
-LTexture* gMenuTextures[2];
-
-LTexture::LTexture()
-{
-	//Initialize
-	mTexture = NULL;
-	mWidth = 0;
-	mHeight = 0;
-}
-
-LTexture::~LTexture()
-{
-	//Deallocate
-	free();
-}
-
-void LTexture::free()
-{
-	//Free texture if it exists
-	if (mTexture != NULL)
-	{
-		SDL_DestroyTexture(mTexture);
-		mTexture = NULL;
-		mWidth = 0;
-		mHeight = 0;
-	}
-}
-
-void LTexture::setColor(Uint8 red, Uint8 green, Uint8 blue)
-{
-	//Modulate texture
-	SDL_SetTextureColorMod(mTexture, red, green, blue);
-}
-
-void LTexture::render(int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip)
-{
-	//Set rendering space and render to screen
-	SDL_Rect renderQuaad = { x, y, mWidth, mHeight };
-
-	//Set clip rendering dimensions
-	if (clip != NULL)
-	{
-		renderQuaad.w = clip->w;
-		renderQuaad.h = clip->h;
-	}
-
-	//Render to screen
-	SDL_RenderCopyEx(gRenderer, mTexture, clip, &renderQuaad, angle, center, flip);
-}
-
-int LTexture::getWidth()
-{
-	return mWidth;
-}
-
-int LTexture::getHeight()
-{
-	return mHeight;
-}
-
-bool LTexture::loadFromFile(std::string path)
-{
-	//Get rid of preexisting texture
-	free();
-
-	//The final texture
-	SDL_Texture* newTexture = NULL;
-
-	//Load image at a specified path
-	SDL_Surface* loadedSurface = IMG_Load(path.c_str());
-	if (loadedSurface == NULL)
-	{
-		printf("Unable to load image %s\n!, SDL_Image error%s\n:", path.c_str(), SDL_GetError());
-	}
-	else
-	{
-		//Color key image
-		SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, 0, 0xFF, 0xFF));
 
-		//Create texture form surface pixels
-		newTexture = SDL_CreateTextureFromSurface(gRenderer, loadedSurface);
-		if (newTexture == NULL)
-		{
-			printf("Unable to create texture form %s! SDL_Error: %s\n", path.c_str(), SDL_GetError());
-		}
-		else
-		{
-			//Get image dimensions
-			mWidth = loadedSurface->w;
-			mHeight = loadedSurface->h;
-		}
-
-		//Get rid of old loaded surface
-		SDL_FreeSurface(loadedSurface);
-	}
-
-	//Return success
-	mTexture = newTexture;
-	return mTexture != NULL;
-}
-
-void LTexture::setBlendMode(SDL_BlendMode blending)
-{
-	//Set blending function
-	SDL_SetTextureBlendMode(mTexture, blending);
-}
-
-void LTexture::setAlpha(Uint8 alpha)
-{
-	//Module texture alpha
-	SDL_SetTextureAlphaMod(mTexture, alpha);
-}
-
-#if defined(SDL_TTF_MAJOR_VERSION)
-bool LTexture::loadFromRenderedText(std::string textureText, SDL_Color textColor)
-{
-	//Get rif of preexisting texture
-	free();
+//Text colors
+const SDL_Color HUD_TEXT_COLOR = { 0x40, 0x40, 0x40, 0xFF };
 
-	//Render text surface
-	SDL_Surface* textSurface = TTF_RenderText_Solid(gFont, textureText.c_str(), textColor);
-	if (textSurface == NULL)
-	{
-		printf("Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError());
-	}
-	else
-	{
-		//Create texture from surface pixels
-		mTexture = SDL_CreateTextureFromSurface(gRenderer, textSurface);
-		if (mTexture == NULL)
-		{
-			printf("Unable to create texture from rendered text!SDL Error : % s\n", SDL_GetError());
-		}
-		else
-		{
-			//Get Image dimesnions
-			mWidth = textSurface->w;
-			mHeight = textSurface->h;
-		}
+//Screen background, also what cached layers are filled with
+const SDL_Color BACKGROUND_COLOR = { 0xFF, 0xFF, 0xFF, 0xFF };
 
-		//Get rid opf old surface
-		SDL_FreeSurface(textSurface);
-	}
+//Cached static content, the menu entries
+LRenderLayer gMenuLayer;
 
-	//Retyurn success
-	return mTexture != NULL;
-}
-#endif
+//The well with its locked cells, only rows that changed are uploaded
+LBoardTexture gBoardTexture;
+const SDL_Color WELL_COLOR = { 0x20, 0x20, 0x20, 0xFF };
 
-LButton::LButton()
+//A line clear or T-spin called out over the well
+struct LPopup
 {
-	mPosition.x = 0;
-	mPosition.y = 0;
-
-	mCurrentSprite = BUTTON_SPRITE_MOUSE_OUT;
-}
+	int lines;
+	bool tSpin;
+	int points;
+	Uint64 spawnTick;
+};
 
-void LButton::setPosition(int x, int y)
-{
-	mPosition.x = x;
-	mPosition.y = y;
-}
+//Popups on screen, from a fixed pool so clears never allocate
+LObjectPool<LPopup, MAX_POPUPS> gPopups;
 
-void LButton::handleEvent(SDL_Event* e)
+//Everything a frame's pixels depend on, a frame matching the last presented one is not drawn at all
+struct LFrameState
 {
-	//If mouse event happened
-	if (e->type == SDL_MOUSEMOTION || e->type == SDL_MOUSEBUTTONDOWN || e->type == SDL_MOUSEBUTTONUP)
-	{
-		//Get mouse position
-		int x, y;
-		SDL_GetMouseState(&x, &y);
-
-		//Check if mouse is in button
-		bool inside = true;
-
-		//Mouse is left of the button
-		if (x < mPosition.x)
-		{
-			inside = false;
-		}
-		//Mouse is right of the button
-		else if (x > mPosition.x + BUTTON_WIDTH)
-		{
-			inside = false;
-		}
-		//Mouse above the button
-		else if (y < mPosition.y)
-		{
-			inside = false;
-		}
-		else if (y > mPosition.y + BUTTON_HEIGHT)
-		{
-			inside = false;
-		}
-
-		//Mouse is outside button
-		if (!inside)
-		{
-			mCurrentSprite = BUTTON_SPRITE_MOUSE_OUT;
-		}
-		//Mouse inside button
-		else
-		{
-			//Set mouse over sprite
-			switch (e->type)
-			{
-			case SDL_MOUSEMOTION:
-				mCurrentSprite = BUTTON_SPRITE_MOUSE_OVER_MOTION;
-				break;
-
-			case SDL_MOUSEBUTTONDOWN:
-				mCurrentSprite = BUTTON_SPRITE_MOUSE_DOWN;
-				break;
-
-			case SDL_MOUSEBUTTONUP:
-				mCurrentSprite = BUTTON_SPRITE_MOUSE_UP;
-				break;
-			}
-		}
-	}
-
-}
-
-LTexture gButtonSpriteSheetTexture;
+	bool playing;
+	Uint32 menuVersion;
+	Uint32 boardVersion;
+	LPiece piece;
+	int pieceY;
+	PieceType hold;
+	PieceType next[NEXT_QUEUE_SIZE];
+	int score;
+	int level;
+	int lines;
+	bool over;
+	bool hintShown;
+	LPiece hint;
+	Uint64 popupTick;
+	Uint64 particleTime;
+	bool glyphsLoaded;
+	int loadProgress;
+	Uint64 overlayFrame;
+};
 
-void LButton::render()
-{
-	//Show current button sprite
-	gButtonSpriteSheetTexture.render(mPosition.x, mPosition.y, &gSpriteClips[mCurrentSprite]);
-}
+//Loading bar layout and colors
+const int LOADING_BAR_MARGIN = 40;
+const int LOADING_BAR_HEIGHT = 8;
+const SDL_Color LOADING_BAR_COLOR = { 0x40, 0x80, 0xFF, 0xFF };
+const SDL_Color LOADING_BAR_BACK_COLOR = { 0xD0, 0xD0, 0xD0, 0xFF };
 
 //Scene sprites
 //SDL_Rect gSpriteClips[4];
@@ -412,32 +253,12 @@ void LButton::render()
 
 //The images that correspond to a key press
 //Array of pointers to SDL surfaces to contain all images we'll be using
-SDL_Surface* gKeyPressSurfaces[KEY_PRESS_SURFACE_TOTAL];
+LSurfaceHandle gKeyPressSurfaces[KEY_PRESS_SURFACE_TOTAL];
 
-SDL_Surface* loadSurface(std::string path)
+LSurfaceHandle loadSurface(const std::string& path)
 {
-	//The final optimized image
-	SDL_Surface* optimizedSurface = NULL;
-
-	//Load image at specified path
-	SDL_Surface* loadedSurface = IMG_Load(path.c_str()); //IMG_Load can load different image types
-
-	if (loadedSurface == NULL)
-	{
-		printf("Unable to load image %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
-	}
-	else
-	{
-		//Convert surface to screen format
-		optimizedSurface = SDL_ConvertSurface(loadedSurface, gScreenSurface->format, 0);
-		if (optimizedSurface == NULL)
-		{
-			printf("Unable to optimize image %s! SDL error: %s\n", path.c_str(), SDL_GetError());
-		}
-		//Get rid of old loaded surface
-		SDL_FreeSurface(loadedSurface);
-	}
-	return optimizedSurface;
+	//Converted to screen format once, later loads of the same image share it
+	return gResources.loadSurface(path, gScreenSurface->format->format);
 }
 
 
@@ -464,6 +285,17 @@ bool init()
 
 	startTime = SDL_GetTicks64();
 
+	//Scratch memory for each frame and particle arrays, allocated once
+	if (!gFrameArena.init(FRAME_ARENA_CAPACITY) || !gLineClearParticles.init(PARTICLE_CAPACITY) || !gDropParticles.init(DROP_PARTICLE_CAPACITY))
+	{
+		success = false;
+	}
+	gLineClearParticles.setPhysics(900.0f, 0.6f);
+	gDropParticles.setPhysics(-60.0f, 0.05f);
+
+	//Mouse hit testing covers the window
+	gUIRouter.setArea(SCREEN_WIDTH, SCREEN_HEIGHT);
+
 	//Initialize SDL
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
@@ -481,8 +313,8 @@ bool init()
 		}
 		else
 		{
-			//Create VSYNCED renderer for window
-			gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+			//Create renderer for window, VSYNCED unless disabled
+			gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | (gVsync ? SDL_RENDERER_PRESENTVSYNC : 0));
 			if (gRenderer == NULL)
 			{
 				printf("Rendere could not be created! SDL Error: %s\n", SDL_GetError());
@@ -491,6 +323,10 @@ bool init()
 			{
 				//Initialize renderer color
 				SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
+
+				//Images are converted to the renderer's format and blending before anything loads
+				gTextureImporter.init(gRenderer);
+
 				//Initialize PNG loading
 				int imgFlags = IMG_INIT_PNG;
 				if (!(IMG_Init(imgFlags) & imgFlags))
@@ -516,29 +352,10 @@ bool init()
 	return success;
 }
 
-SDL_Texture* loadTexture(std::string path) {
-	//The final texture
-	SDL_Texture* newTexture = NULL;
-
-	//Load image at a specified path
-	SDL_Surface* loadedSurface = IMG_Load(path.c_str());
-	if (loadedSurface == NULL)
-	{
-		printf("Unable to load image %s\n!, SDL_Image error:%s\n", path.c_str(), SDL_GetError());
-	}
-	else
-	{
-		//Create texture form surface pixels
-		newTexture = SDL_CreateTextureFromSurface(gRenderer, loadedSurface);
-		if (newTexture == NULL)
-		{
-			printf("Unable to create texture form %s! SDL_Error: %s\n", path.c_str(), SDL_GetError());
-		}
-
-		//Get rid of old loaded surface
-		SDL_FreeSurface(loadedSurface);
-	}
-	return newTexture;
+LTextureHandle loadTexture(const std::string& path)
+{
+	//Later loads of the same image share the texture
+	return gResources.loadTexture(path);
 }
 
 
@@ -547,6 +364,26 @@ bool loadMedia()
 	//Loading success flag
 	bool success = true;
 
+	//Decode every image on the loader threads
+	std::vector<std::string> atlasImages = LAtlas::listImages("assets/images");
+	for (size_t i = 0; i < atlasImages.size(); ++i)
+	{
+		std::string path = atlasImages[i];
+		gAssetLoader.queue(path,
+			[path]() { return LAtlas::decodeImage(path); },
+			[path](SDL_Surface* surface) { gAtlas.addImage(path, surface); return surface != NULL; });
+	}
+
+	//Once all of them are in, pack them into shared atlas pages, LTexture::loadFromFile draws from them
+	gAssetLoader.queue("texture atlas", LDecodeFunction(), [](SDL_Surface*)
+	{
+		if (!gAtlas.build())
+		{
+			printf("Failed to build texture atlas, images will load individually!\n");
+		}
+		return true;
+	});
+
 	//Load default surface
 	/*
 	gKeyPressSurfaces[KEY_PRESS_SURFACE_DEFAULT] = loadSurface("assets/images/press.bmp");
@@ -718,13 +555,15 @@ bool loadMedia()
 	//		success = false;
 	//	}
 	//}
-	if (!gButtonSpriteSheetTexture.loadFromFile("assets/images/button.png"))
-	{
-		printf("Failed to load button sprite texture!\n");
-		success = false;
-	}
-	else
+	//Queued after the atlas so it picks its region from there
+	gAssetLoader.queue("assets/images/button.png", LDecodeFunction(), [](SDL_Surface*)
 	{
+		if (!gButtonSpriteSheetTexture.loadFromFile("assets/images/button.png"))
+		{
+			printf("Failed to load button sprite texture!\n");
+			return false;
+		}
+
 		//Set sprites
 		for (int i = 0; i < BUTTON_SPRITE_TOTAL; ++i)
 		{
@@ -739,22 +578,59 @@ bool loadMedia()
 		gButtons[1].setPosition(SCREEN_WIDTH - BUTTON_WIDTH, 0);
 		gButtons[2].setPosition(0, SCREEN_HEIGHT - BUTTON_HEIGHT);
 		gButtons[3].setPosition(SCREEN_WIDTH - BUTTON_WIDTH, SCREEN_HEIGHT - BUTTON_HEIGHT);
-	}
+		for (int i = 0; i < TOTAL_BUTTONS; ++i)
+		{
+			gUIRouter.add(&gButtons[i]);
+		}
+		return true;
+	});
 	return success;
 }
 
 void close()
 {
+	//Stop decoding before anything the workers use goes away
+	gAssetLoader.stop();
+	gSimulation.stop();
+	gBot.stop();
+	gTaskPool.stop();
+
+	//How the controls felt this session, and what idling cost
+	gInput.printLatencyReport();
+	gFrameScheduler.printReport();
+
 	//Free loaded image
 	gFooTexture.free();
 	gBackgroundTexture.free();
-	SDL_DestroyTexture(gTexture);
-	gTexture = NULL;
-
+	gButtonSpriteSheetTexture.free();
+	gModulatedTexture.free();
+	gArrowTexture.free();
+	gTextTexture.free();
+	gSpriteSheetTexture.free();
+	gTexture.reset();
+
+	//Free atlas pages, glyphs and cached layers
+	gAtlas.free();
+	gGlyphCache.free();
+	gBoardTexture.free();
+	gMenuLayer.free();
+	gFrameArena.free();
+	gLineClearParticles.free();
+	gDropParticles.free();
+
+	//Deallocate surfaces
+	gHelloWorld.reset();
+	for (int i = 0; i < KEY_PRESS_SURFACE_TOTAL; ++i)
+	{
+		gKeyPressSurfaces[i].reset();
+	}
 
-	//Deallocate surface
-	SDL_FreeSurface(gHelloWorld);
-	gHelloWorld = NULL;
+	//Release the font and free every resource nothing holds anymore,
+	//fonts may read from the archive so this goes before unmapping
+	gFont = NULL;
+	gFontHandle.reset();
+	gResources.clear();
+	gAssets.close();
 
 	//Destroy window
 	SDL_DestroyRenderer(gRenderer);
@@ -773,94 +649,1022 @@ bool loadMenu()
 {
 	//Loading success flag
 	bool success = true;
-	int menuEntriesSize = 2;
-	std::string menuEntries[2] = {
-		"Hello SDL\n",
-		"Getting an Image on the Screen\n"
-	};
-
-	//Open the font
-	gFont = TTF_OpenFont("assets/fonts/lazy.ttf", 28);
-	if (gFont == NULL)
+
+	//Screens and entries come from the menu config, a bare menu keeps the game playable without it
+	if (!gMenu.load(MENU_CONFIG_PATH))
 	{
-		printf("Failed to load lazy font! SDL_ttf Error: %s\n", TTF_GetError());
+		gMenu.loadFromMemory(MENU_FALLBACK, strlen(MENU_FALLBACK), "fallback menu");
 		success = false;
 	}
-	else
+
+	//Open and rasterize the font on a loader thread, all menu and HUD text is laid out from it
+	gAssetLoader.queue("assets/fonts/lazy.ttf", []() -> SDL_Surface*
+	{
+		gFontHandle = gResources.loadFont("assets/fonts/lazy.ttf", 28);
+		gFont = gFontHandle.get();
+		if (gFont == NULL)
+		{
+			printf("Failed to load lazy font!\n");
+			return NULL;
+		}
+		return gGlyphCache.rasterize(gFont);
+	},
+	[](SDL_Surface* glyphs)
+	{
+		//Entries are measured once, as soon as there are glyphs to measure
+		if (!gGlyphCache.upload(glyphs))
+		{
+			return false;
+		}
+		gMenu.layout(SCREEN_WIDTH, SCREEN_HEIGHT);
+		return true;
+	});
+
+	return success;
+}
+
+//Queues a progress bar for the asset loader with the name of what it is waiting on
+void renderLoadingBar()
+{
+	gSpriteBatch.setLayer(5);
+	SDL_Rect frame = { LOADING_BAR_MARGIN, SCREEN_HEIGHT - LOADING_BAR_MARGIN - LOADING_BAR_HEIGHT, SCREEN_WIDTH - 2 * LOADING_BAR_MARGIN, LOADING_BAR_HEIGHT };
+	gSpriteBatch.fillRect(frame, LOADING_BAR_BACK_COLOR);
+
+	SDL_Rect bar = frame;
+	bar.w = (int)(frame.w * gAssetLoader.getProgress());
+	gSpriteBatch.fillRect(bar, LOADING_BAR_COLOR);
+
+	//Text only shows once the glyphs themselves are in
+	gGlyphCache.render(frame.x, frame.y - gGlyphCache.getLineHeight(), gAssetLoader.getCurrentName(), HUD_TEXT_COLOR);
+}
+
+//Queues the cells of a piece mask with its top left box corner at the given pixel, optionally clipped
+void renderPieceCells(PieceType type, int rotation, int x, int y, int cellSize, Uint8 alpha, const SDL_Rect* clip = NULL)
+{
+	SDL_Color color = gPieceColors[type];
+	color.a = alpha;
+
+	uint64_t mask = gPieceMasks[type][rotation];
+	for (int row = 0; row < 4; ++row)
 	{
-		//Render text
-		SDL_Color textColor = { 138, 138, 138};
-		for (int i = 0; i < menuEntriesSize; i++)
+		for (int column = 0; column < 4; ++column)
 		{
-			gMenuTextures[i] = new LTexture();
-			if (!gMenuTextures[i]->loadFromRenderedText(menuEntries[i], textColor))
+			if ((mask >> (16 * row + column)) & 1)
 			{
-				printf("Failed to render text texture!\n");
-				success = false;
+				SDL_Rect cell = { x + column * cellSize, y + row * cellSize, cellSize - 1, cellSize - 1 };
+				if (clip != NULL && !SDL_IntersectRect(&cell, clip, &cell))
+				{
+					continue;
+				}
+				gSpriteBatch.fillRect(cell, color);
 			}
-		}		
+		}
 	}
-
-	return success;
 }
 
-int main(int argc, char* args[])
+//Draws the well and the locked cells, the part of the playfield that only changes when a piece locks
+void renderBoardBackground(const LGame& game)
 {
-	if (!init())
+	//One quad from the streaming texture, after uploading the rows that changed
+	gSpriteBatch.setLayer(0);
+	if (gBoardTexture.update(game, gPieceColors, WELL_COLOR))
 	{
-		printf("Failed to initialize!\n");
+		gBoardTexture.render(BOARD_SCREEN_X, BOARD_SCREEN_Y);
+		return;
 	}
-	else
+
+	//Well background
+	SDL_Rect well = { BOARD_SCREEN_X, BOARD_SCREEN_Y, BOARD_WIDTH * CELL_SIZE, BOARD_VISIBLE_HEIGHT * CELL_SIZE };
+	gSpriteBatch.fillRect(well, WELL_COLOR);
+
+	//Locked cells
+	gSpriteBatch.setLayer(1);
+	for (int y = BOARD_HIDDEN_HEIGHT; y < BOARD_HEIGHT; ++y)
 	{
-		//Load Media
-		//if (!loadMedia())
-		//{
-		//	printf("Failed to load media!\n");
-		//}
-		if (!loadMenu())
+		for (int x = 0; x < BOARD_WIDTH; ++x)
 		{
-			printf("Failed to load menu!\n");
+			PieceType type = game.getCell(x, y);
+			if (type != PIECE_NONE)
+			{
+				SDL_Rect cell = { BOARD_SCREEN_X + x * CELL_SIZE, BOARD_SCREEN_Y + (y - BOARD_HIDDEN_HEIGHT) * CELL_SIZE, CELL_SIZE - 1, CELL_SIZE - 1 };
+				gSpriteBatch.fillRect(cell, gPieceColors[type]);
+			}
 		}
-		else
-		{
-
+	}
+}
 
-			//Hack to get window to stay up
-			SDL_Event e;
-			bool quit = false;
+//Pixel row the falling piece is drawn at, only falls of the same piece are blended, moves and rotations snap
+int interpolatePieceY(const LPiece& piece, const LPiece& previousPiece, double alpha)
+{
+	double y = piece.y;
+	if (previousPiece.type == piece.type && previousPiece.rotation == piece.rotation && previousPiece.x == piece.x && previousPiece.y <= piece.y)
+	{
+		y = previousPiece.y + (piece.y - previousPiece.y) * alpha;
+	}
+	return BOARD_SCREEN_Y + (int)((y - BOARD_HIDDEN_HEIGHT) * CELL_SIZE);
+}
 
-			//Set default current surface
-			//gCurrentSurface = gKeyPressSurfaces[KEY_PRESS_SURFACE_DEFAULT];
+//Calls out the lines and T-spin of a lock, if there were any
+void spawnPopup(const LGameStats& before, const LGameStats& stats)
+{
+	int lines = stats.lines - before.lines;
+	bool tSpin = stats.tSpins != before.tSpins;
+	if (lines == 0 && !tSpin)
+	{
+		return;
+	}
 
-			//Modulation components
-			Uint8 r = 255;
-			Uint8 g = 255;
-			Uint8 b = 255;
-			Uint8 a = 255;
+	//With every slot taken the callout is skipped, the earlier ones are still showing
+	LPopup* popup = gPopups.acquire();
+	if (popup != NULL)
+	{
+		popup->lines = lines;
+		popup->tSpin = tSpin;
+		popup->points = stats.score - before.score;
+		popup->spawnTick = stats.ticks;
+	}
+}
 
-			//Current animation frame
-			int frame = 0;
+//Gives back the popups that finished floating up
+void updatePopups(const LGame& game)
+{
+	for (int i = 0; i < gPopups.getCapacity(); ++i)
+	{
+		if (gPopups.isActive(i) && game.getStats().ticks - gPopups.get(i).spawnTick >= (Uint64)POPUP_LIFETIME_TICKS)
+		{
+			gPopups.release(&gPopups.get(i));
+		}
+	}
+}
 
-			//Angle of rotation
-			double degrees = 0;
+//Draws the popups rising and fading over the well
+void renderPopups(const LGame& game)
+{
+	static const char* const lineNames[5] = { "", "Single", "Double", "Triple", "Tetris" };
+	for (int i = 0; i < gPopups.getCapacity(); ++i)
+	{
+		if (!gPopups.isActive(i))
+		{
+			continue;
+		}
 
-			//Flip type 
-			SDL_RendererFlip flipType = SDL_FLIP_NONE;
+		const LPopup& popup = gPopups.get(i);
+		int age = (int)(game.getStats().ticks - popup.spawnTick);
+		if (age >= POPUP_LIFETIME_TICKS)
+		{
+			continue;
+		}
+		const char* text = gFrameArena.format("%s%s\n+%d", popup.tSpin ? "T-spin " : "", lineNames[popup.lines < 4 ? popup.lines : 4], popup.points);
+		SDL_Color color = MENU_SELECTED_COLOR;
+		color.a = (Uint8)(0xFF * (POPUP_LIFETIME_TICKS - age) / POPUP_LIFETIME_TICKS);
+		int x = BOARD_SCREEN_X + (BOARD_WIDTH * CELL_SIZE - gGlyphCache.measure(text)) / 2;
+		int y = BOARD_SCREEN_Y + BOARD_VISIBLE_HEIGHT * CELL_SIZE / 3 - POPUP_RISE * age / POPUP_LIFETIME_TICKS;
+		gGlyphCache.render(x, y, text, color);
+	}
+}
 
-			//Index of menu selcted
-			int indexSelected = 0;
-			int menuEntriesNumber = 2;
+//Blows the cells of cleared rows apart and puffs dust where a hard dropped piece landed
+void emitLockEffects(const LLockInfo& lock, const LPiece& dropStart, bool hardDrop)
+{
+	int clearedIndex = 0;
+	for (int row = 0; row < BOARD_HEIGHT && clearedIndex < 4; ++row)
+	{
+		if (!((lock.clearedRows >> row) & 1))
+		{
+			continue;
+		}
+
+		//Debris in the color of the cell it came from, flung up and out
+		float top = (float)(BOARD_SCREEN_Y + (row - BOARD_HIDDEN_HEIGHT) * CELL_SIZE);
+		for (int x = 0; x < BOARD_WIDTH; ++x)
+		{
+			SDL_Color color = gPieceColors[lock.clearedCells[clearedIndex][x]];
+			float left = (float)(BOARD_SCREEN_X + x * CELL_SIZE);
+			for (int i = 0; i < LINE_CLEAR_PARTICLES_PER_CELL; ++i)
+			{
+				gLineClearParticles.emit(left + gLineClearParticles.random(0.0f, (float)CELL_SIZE), top + gLineClearParticles.random(0.0f, (float)CELL_SIZE),
+					gLineClearParticles.random(-240.0f, 240.0f), gLineClearParticles.random(-480.0f, -60.0f),
+					gLineClearParticles.random(0.5f, 1.2f), gLineClearParticles.random(2.0f, 5.0f), color);
+			}
+		}
+		++clearedIndex;
+	}
+
+	if (!hardDrop)
+	{
+		return;
+	}
+
+	//Dust under the lowest cell of every column the piece covers, and a streak back to where it fell from
+	uint64_t mask = gPieceMasks[lock.piece.type][lock.piece.rotation];
+	SDL_Color color = gPieceColors[lock.piece.type];
+	for (int column = 0; column < 4; ++column)
+	{
+		int bottom = -1;
+		for (int row = 0; row < 4; ++row)
+		{
+			if ((mask >> (16 * row + column)) & 1)
+			{
+				bottom = row;
+			}
+		}
+		if (bottom < 0)
+		{
+			continue;
+		}
+
+		float left = (float)(BOARD_SCREEN_X + (lock.piece.x + column) * CELL_SIZE);
+		float floor = (float)(BOARD_SCREEN_Y + (lock.piece.y + bottom + 1 - BOARD_HIDDEN_HEIGHT) * CELL_SIZE);
+		float fall = (float)((lock.piece.y - dropStart.y) * CELL_SIZE);
+		for (int i = 0; i < DROP_PARTICLES_PER_COLUMN; ++i)
+		{
+			gDropParticles.emit(left + gDropParticles.random(0.0f, (float)CELL_SIZE), floor - gDropParticles.random(0.0f, fall > 0.0f ? fall : 1.0f),
+				gDropParticles.random(-30.0f, 30.0f), gDropParticles.random(-40.0f, 0.0f), gDropParticles.random(0.2f, 0.5f), 2.0f, color);
+		}
+	}
+}
+
+//Draws everything that moves on top of the board background, hint is where the bot would put a piece
+void renderGame(const LGame& game, const LPiece& previousPiece, double alpha, const LPiece* hint)
+{
+	SDL_Rect well = { BOARD_SCREEN_X, BOARD_SCREEN_Y, BOARD_WIDTH * CELL_SIZE, BOARD_VISIBLE_HEIGHT * CELL_SIZE };
+
+	if (!game.isOver())
+	{
+		//Ghost piece
+		const LPiece& piece = game.getPiece();
+		int ghostY = BOARD_SCREEN_Y + (game.getGhostY() - BOARD_HIDDEN_HEIGHT) * CELL_SIZE;
+		gSpriteBatch.setLayer(2);
+		renderPieceCells(piece.type, piece.rotation, BOARD_SCREEN_X + piece.x * CELL_SIZE, ghostY, CELL_SIZE, 0x50, &well);
+		if (hint != NULL)
+		{
+			renderPieceCells(hint->type, hint->rotation, BOARD_SCREEN_X + hint->x * CELL_SIZE, BOARD_SCREEN_Y + (hint->y - BOARD_HIDDEN_HEIGHT) * CELL_SIZE, CELL_SIZE, 0x90, &well);
+		}
+
+		int pieceY = interpolatePieceY(piece, previousPiece, alpha);
+		gSpriteBatch.setLayer(3);
+		renderPieceCells(piece.type, piece.rotation, BOARD_SCREEN_X + piece.x * CELL_SIZE, pieceY, CELL_SIZE, 0xFF, &well);
+	}
+
+	//Next queue
+	gSpriteBatch.setLayer(1);
+	for (int i = 0; i < NEXT_QUEUE_SIZE; ++i)
+	{
+		renderPieceCells(game.getNext(i), ROTATION_SPAWN, BOARD_SCREEN_X + (BOARD_WIDTH + 1) * CELL_SIZE, BOARD_SCREEN_Y + i * 3 * PREVIEW_CELL_SIZE, PREVIEW_CELL_SIZE, 0xFF);
+	}
+
+	//Hold
+	if (game.getHold() != PIECE_NONE)
+	{
+		renderPieceCells(game.getHold(), ROTATION_SPAWN, BOARD_SCREEN_X - 5 * PREVIEW_CELL_SIZE, BOARD_SCREEN_Y, PREVIEW_CELL_SIZE, 0xFF);
+	}
+
+	//Stats change every frame, so format them into the frame arena and lay them out from cached glyphs
+	const LGameStats& stats = game.getStats();
+	const char* text = gFrameArena.format("Score\n%d\nLevel\n%d\nLines\n%d", stats.score, stats.level, stats.lines);
+	gSpriteBatch.setLayer(4);
+	gGlyphCache.render(HUD_X, HUD_Y, text, HUD_TEXT_COLOR);
+	renderPopups(game);
+
+	//Every particle of a system goes out in one submission, over the pieces
+	gSpriteBatch.setLayer(3);
+	gDropParticles.render();
+	gLineClearParticles.render();
+
+	if (game.isOver())
+	{
+		const char* gameOver = "GAME OVER";
+		gGlyphCache.render((SCREEN_WIDTH - gGlyphCache.measure(gameOver)) / 2, (SCREEN_HEIGHT - gGlyphCache.getLineHeight()) / 2, gameOver, MENU_SELECTED_COLOR);
+	}
+}
+
+//Chooses where the current piece should land, favoring cleared lines and low placements
+void chooseAutoTarget(const LGame& game, Uint32* random, int* targetRotation, int* targetX)
+{
+	const LBoard& board = game.getBoard();
+	const LPiece& piece = game.getPiece();
+
+	int bestScore = -1;
+	*targetRotation = piece.rotation;
+	*targetX = piece.x;
+	for (int rotation = 0; rotation < ROTATION_TOTAL; ++rotation)
+	{
+		for (int x = -BOARD_WALL_BITS; x < BOARD_WIDTH; ++x)
+		{
+			LPiece candidate = { piece.type, rotation, x, piece.y };
+			if (board.collides(candidate))
+			{
+				continue;
+			}
+
+			//Try the drop on a copy of the board
+			candidate.y = board.ghostY(candidate);
+			LBoard after = board;
+			int lines = after.lock(candidate);
+
+			//xorshift breaks ties so games differ
+			*random ^= *random << 13;
+			*random ^= *random >> 17;
+			*random ^= *random << 5;
+			int score = lines * 64 + candidate.y * 4 + (int)(*random & 3);
+			if (score > bestScore)
+			{
+				bestScore = score;
+				*targetRotation = rotation;
+				*targetX = x;
+			}
+		}
+	}
+}
+
+//Steers the current piece towards a target chosen once per piece, then hard drops it
+Uint32 getAutoActions(const LGame& game, Uint32* random, int* placed, int* targetRotation, int* targetX)
+{
+	if (game.getStats().pieces != *placed)
+	{
+		*placed = game.getStats().pieces;
+		chooseAutoTarget(game, random, targetRotation, targetX);
+	}
+
+	const LPiece& piece = game.getPiece();
+	Uint32 actions = ACTION_NONE;
+	if (piece.rotation != *targetRotation)
+	{
+		actions |= ACTION_ROTATE_CW;
+	}
+	if (piece.x < *targetX)
+	{
+		actions |= ACTION_RIGHT;
+	}
+	else if (piece.x > *targetX)
+	{
+		actions |= ACTION_LEFT;
+	}
+	if (actions == ACTION_NONE)
+	{
+		actions = ACTION_HARD_DROP;
+	}
+	return actions;
+}
+
+int runHeadless(int games, Uint32 seed, const char* recordPrefix, bool bot)
+{
+	LGame game;
+	LBotPlayer botPlayer;
+	botPlayer.setActionInterval(1);
+	if (bot)
+	{
+		gTaskPool.start();
+	}
+	Uint64 totalTicks = 0;
+	Uint64 totalPieces = 0;
+	Uint64 totalLines = 0;
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int i = 0; i < games; ++i)
+	{
+		game.reset(seed + i);
+		LReplay replay;
+		if (recordPrefix != NULL)
+		{
+			replay.beginRecording(seed + i);
+		}
+
+		//Steer every piece to its target, then hard drop
+		Uint32 random = seed + i + 1;
+		int placed = -1;
+		int targetRotation = 0;
+		int targetX = 0;
+		botPlayer.reset();
+		while (!game.isOver())
+		{
+			//The search bot rarely tops out, so its games end after a fixed number of pieces
+			if (bot)
+			{
+				if (game.getStats().pieces >= HEADLESS_BOT_PIECES)
+				{
+					break;
+				}
+				Uint32 actions = botPlayer.getActions(game);
+				replay.record(actions);
+				game.step(actions);
+				continue;
+			}
+
+			Uint32 actions = getAutoActions(game, &random, &placed, &targetRotation, &targetX);
+			replay.record(actions);
+			game.step(actions);
+		}
+
+		if (recordPrefix != NULL)
+		{
+			char path[256];
+			SDL_snprintf(path, sizeof(path), "%s%d.replay", recordPrefix, i);
+			replay.save(path, game);
+		}
+
+		totalTicks += game.getStats().ticks;
+		totalPieces += game.getStats().pieces;
+		totalLines += game.getStats().lines;
+	}
+	Uint64 end = SDL_GetPerformanceCounter();
+
+	//Report throughput
+	double seconds = (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+	if (seconds <= 0.0)
+	{
+		seconds = 1e-9;
+	}
+	printf("Headless: %d games, %llu ticks, %llu pieces, %llu lines in %.3f s\n", games, (unsigned long long)totalTicks, (unsigned long long)totalPieces, (unsigned long long)totalLines, seconds);
+	printf("Headless: %.0f ticks/s, %.1f games/s\n", totalTicks / seconds, games / seconds);
+	if (bot)
+	{
+		printf("Bot: %d searches, %.2f ms average, %.2f ms worst on %d threads\n", botPlayer.getSearchCount(),
+			botPlayer.getSearchCount() > 0 ? botPlayer.getTotalSearchMs() / botPlayer.getSearchCount() : 0.0, botPlayer.getMaxSearchMs(), gTaskPool.getThreadCount());
+		gTaskPool.stop();
+	}
+
+	return 0;
+}
+
+int runReplays(const std::vector<std::string>& paths)
+{
+	LGame game;
+	LReplay replay;
+	int failed = 0;
+	for (size_t i = 0; i < paths.size(); ++i)
+	{
+		if (!replay.load(paths[i].c_str()))
+		{
+			++failed;
+			continue;
+		}
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		bool match = replay.play(&game);
+		Uint64 end = SDL_GetPerformanceCounter();
+
+		//Speed relative to the game playing at its tick rate
+		double seconds = (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+		if (seconds <= 0.0)
+		{
+			seconds = 1e-9;
+		}
+		double realtime = (double)replay.getTickCount() / LOGIC_TICK_RATE;
+		printf("Replay %s: seed %u, %llu ticks, %u events, score %d in %.3f ms (%.0fx real time) %s\n", paths[i].c_str(), replay.getSeed(),
+			(unsigned long long)replay.getTickCount(), replay.getEventCount(), game.getStats().score, seconds * 1000.0, realtime / seconds,
+			match ? "matches" : "DIVERGED");
+		if (!match)
+		{
+			++failed;
+		}
+	}
+
+	printf("Replays: %d of %d reproduced\n", (int)paths.size() - failed, (int)paths.size());
+	return failed == 0 ? 0 : 1;
+}
+
+int runTournament(int games, Uint32 seed, int pieces, const std::vector<LBotWeights>& weights, const char* csvPath)
+{
+	LTournament tournament;
+	if (weights.empty())
+	{
+		tournament.addEntry(gBotDefaultWeights);
+	}
+	for (size_t i = 0; i < weights.size(); ++i)
+	{
+		tournament.addEntry(weights[i]);
+	}
+
+	gTaskPool.start();
+	tournament.run(games, seed, pieces);
+	gTaskPool.stop();
+
+	tournament.printSummary();
+	return tournament.writeCSV(csvPath) ? 0 : 1;
+}
+
+//What the render benchmark cases work on
+struct LRenderBenchmarkData
+{
+	LTexture sprite;
+	SDL_Rect clip;
+	LGame game;
+	std::vector<Uint32> pixels;
+	std::vector<Uint32> converted;
+	PixelKernel kernel;
+};
+
+//Gets an image in the screen format, from the import cache since the resource budget is zero
+int benchmarkLoadSurface(void*)
+{
+	LSurfaceHandle surface = loadSurface(RENDER_BENCHMARK_IMAGE);
+	return surface ? 1 : 0;
+}
+
+//Imports an image and uploads it as a texture
+int benchmarkLoadFromFile(void*)
+{
+	LTexture texture;
+	return texture.loadFromFile(RENDER_BENCHMARK_IMAGE) ? 1 : 0;
+}
+
+//Renders a string and uploads it as a texture
+int benchmarkLoadFromRenderedText(void*)
+{
+	LTexture texture;
+	return texture.loadFromRenderedText(RENDER_BENCHMARK_TEXT, HUD_TEXT_COLOR) ? 1 : 0;
+}
+
+//Keys, premultiplies and reorders an image's worth of pixels, what importing costs on a cache miss
+int benchmarkConvertPixels(void* data)
+{
+	LRenderBenchmarkData* bench = (LRenderBenchmarkData*)data;
+	convertPixels(&bench->pixels[0], &bench->converted[0], RENDER_BENCHMARK_PIXELS, SDL_PIXELFORMAT_BGRA32, true, bench->kernel);
+	return RENDER_BENCHMARK_PIXELS;
+}
+
+//Draws the sprite all over the screen and waits for the renderer to finish
+int benchmarkRender(LRenderBenchmarkData* bench, SDL_Rect* clip, double angle, SDL_RendererFlip flip)
+{
+	int rangeX = SCREEN_WIDTH - bench->sprite.getWidth() > 0 ? SCREEN_WIDTH - bench->sprite.getWidth() : 1;
+	int rangeY = SCREEN_HEIGHT - bench->sprite.getHeight() > 0 ? SCREEN_HEIGHT - bench->sprite.getHeight() : 1;
+	for (int i = 0; i < RENDER_BENCHMARK_SPRITES; ++i)
+	{
+		bench->sprite.render(i * 37 % rangeX, i * 53 % rangeY, clip, angle, NULL, flip);
+	}
+	SDL_RenderFlush(gRenderer);
+	return RENDER_BENCHMARK_SPRITES;
+}
+
+int benchmarkRenderPlain(void* data)
+{
+	return benchmarkRender((LRenderBenchmarkData*)data, NULL, 0.0, SDL_FLIP_NONE);
+}
+
+int benchmarkRenderClipped(void* data)
+{
+	LRenderBenchmarkData* bench = (LRenderBenchmarkData*)data;
+	return benchmarkRender(bench, &bench->clip, 0.0, SDL_FLIP_NONE);
+}
+
+int benchmarkRenderRotated(void* data)
+{
+	return benchmarkRender((LRenderBenchmarkData*)data, NULL, 30.0, SDL_FLIP_NONE);
+}
+
+int benchmarkRenderFlipped(void* data)
+{
+	return benchmarkRender((LRenderBenchmarkData*)data, NULL, 0.0, SDL_FLIP_HORIZONTAL);
+}
+
+int benchmarkRenderClippedRotatedFlipped(void* data)
+{
+	LRenderBenchmarkData* bench = (LRenderBenchmarkData*)data;
+	return benchmarkRender(bench, &bench->clip, 30.0, (SDL_RendererFlip)(SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL));
+}
+
+//Draws and presents a whole game frame the way the game loop does without its layer cache
+int benchmarkBoardFrame(void* data)
+{
+	LRenderBenchmarkData* bench = (LRenderBenchmarkData*)data;
+	gFrameArena.reset();
+	SDL_SetRenderDrawColor(gRenderer, BACKGROUND_COLOR.r, BACKGROUND_COLOR.g, BACKGROUND_COLOR.b, BACKGROUND_COLOR.a);
+	SDL_RenderClear(gRenderer);
+	gSpriteBatch.begin();
+	renderBoardBackground(bench->game);
+	renderGame(bench->game, bench->game.getPiece(), 1.0, NULL);
+	gSpriteBatch.flush();
+	SDL_RenderPresent(gRenderer);
+	return 1;
+}
+
+//Same frame with every row of the board texture uploaded again, the cost of a frame right after a line clear or worse
+int benchmarkBoardFrameUpload(void* data)
+{
+	gBoardTexture.invalidate();
+	return benchmarkBoardFrame(data);
+}
+
+int runRenderBenchmark(const char* baselinePath, const char* savePath, double tolerance)
+{
+	//Same numbers on every machine's CPU rasterizer, with no window unless a video driver was asked for
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+	gVsync = false;
+	if (!init())
+	{
+		printf("Failed to initialize!\n");
+		close();
+		return 1;
+	}
+	gBoardTexture.create(CELL_SIZE);
+	SDL_RendererInfo info;
+	SDL_GetRendererInfo(gRenderer, &info);
+	printf("Render benchmark on %s video, %s renderer\n", SDL_GetCurrentVideoDriver(), info.name);
+
+	//HUD text needs the glyphs, which the game loads on a worker
+	LRenderBenchmarkData* bench = new LRenderBenchmarkData;
+	gFontHandle = gResources.loadFont("assets/fonts/lazy.ttf", 28);
+	gFont = gFontHandle.get();
+	bool success = gFont != NULL && gGlyphCache.upload(gGlyphCache.rasterize(gFont)) && bench->sprite.loadFromFile(RENDER_BENCHMARK_SPRITE);
+	if (!success)
+	{
+		printf("Failed to load benchmark media!\n");
+	}
+	else
+	{
+		bench->clip.x = 0;
+		bench->clip.y = 0;
+		bench->clip.w = bench->sprite.getWidth() / 2;
+		bench->clip.h = bench->sprite.getHeight() / 2;
+
+		//A stack partly built by the auto player, so the board has cells to draw
+		bench->game.reset(RENDER_BENCHMARK_SEED);
+		Uint32 random = RENDER_BENCHMARK_SEED;
+		int placed = -1;
+		int targetRotation = 0;
+		int targetX = 0;
+		while (!bench->game.isOver() && bench->game.getStats().pieces < RENDER_BENCHMARK_PIECES)
+		{
+			bench->game.step(getAutoActions(bench->game, &random, &placed, &targetRotation, &targetX));
+		}
+
+		//Loads are timed cold, nothing stays cached between calls
+		LBenchmark benchmark;
+		gResources.setBudget(0);
+		benchmark.run("loadSurface", benchmarkLoadSurface, bench);
+		benchmark.run("LTexture::loadFromFile", benchmarkLoadFromFile, bench);
+		benchmark.run("LTexture::loadFromRenderedText", benchmarkLoadFromRenderedText, bench);
+		gResources.setBudget(RESOURCE_BUDGET_BYTES);
+
+		//Every kernel this CPU runs, on pixels with some key color and partial alpha
+		bench->pixels.resize(RENDER_BENCHMARK_PIXELS);
+		bench->converted.resize(RENDER_BENCHMARK_PIXELS);
+		for (int i = 0; i < RENDER_BENCHMARK_PIXELS; ++i)
+		{
+			bench->pixels[i] = i % 5 == 0 ? SDL_SwapLE32(0xFFFFFF00) : (Uint32)i * 2654435761u;
+		}
+		for (int kernel = 0; kernel < PIXEL_KERNEL_TOTAL; ++kernel)
+		{
+			if (isPixelKernelSupported((PixelKernel)kernel))
+			{
+				char name[64];
+				SDL_snprintf(name, sizeof(name), "convertPixels %s", getPixelKernelName((PixelKernel)kernel));
+				bench->kernel = (PixelKernel)kernel;
+				benchmark.run(name, benchmarkConvertPixels, bench);
+			}
+		}
+
+		benchmark.run("LTexture::render", benchmarkRenderPlain, bench);
+		benchmark.run("LTexture::render clip", benchmarkRenderClipped, bench);
+		benchmark.run("LTexture::render rotate", benchmarkRenderRotated, bench);
+		benchmark.run("LTexture::render flip", benchmarkRenderFlipped, bench);
+		benchmark.run("LTexture::render clip+rot+flip", benchmarkRenderClippedRotatedFlipped, bench);
+		benchmark.run("board frame", benchmarkBoardFrame, bench);
+		benchmark.run("board frame, all rows upload", benchmarkBoardFrameUpload, bench);
+
+		printf("\n");
+		benchmark.printResults();
+		printf("\n");
+		//Saving over the baseline replaces it, so the old numbers don't get a say
+		if (baselinePath != NULL && (savePath == NULL || SDL_strcmp(savePath, baselinePath) != 0))
+		{
+			success = benchmark.compare(baselinePath, tolerance);
+		}
+		if (savePath != NULL)
+		{
+			success = benchmark.save(savePath) && success;
+		}
+	}
+
+	delete bench;
+	close();
+	return success ? 0 : 1;
+}
+
+int main(int argc, char* args[])
+{
+	//Count allocations from the very first one SDL makes
+	installAllocationCounter();
+
+	//Command line options
+	bool headless = false;
+	int headlessGames = 1000;
+	Uint32 seed = 0;
+	bool bot = false;
+	const char* recordPrefix = NULL;
+	std::vector<std::string> replays;
+	int tournamentGames = 0;
+	int tournamentPieces = TOURNAMENT_DEFAULT_PIECES;
+	const char* tournamentCSV = TOURNAMENT_DEFAULT_CSV;
+	std::vector<LBotWeights> tournamentWeights;
+	bool benchRender = false;
+	const char* benchBaseline = RENDER_BENCHMARK_BASELINE_PATH;
+	const char* benchSave = NULL;
+	double benchTolerance = BENCHMARK_DEFAULT_TOLERANCE;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = args[i];
+		if (arg == "--headless")
+		{
+			headless = true;
+		}
+		else if (arg == "--games" && i + 1 < argc)
+		{
+			headlessGames = atoi(args[++i]);
+		}
+		else if (arg == "--seed" && i + 1 < argc)
+		{
+			seed = (Uint32)strtoul(args[++i], NULL, 10);
+		}
+		else if (arg == "--bot")
+		{
+			bot = true;
+		}
+		else if (arg == "--record" && i + 1 < argc)
+		{
+			recordPrefix = args[++i];
+		}
+		else if (arg == "--replay" && i + 1 < argc)
+		{
+			replays.push_back(args[++i]);
+		}
+		else if (arg == "--no-vsync")
+		{
+			gVsync = false;
+		}
+		else if (arg == "--tournament" && i + 1 < argc)
+		{
+			tournamentGames = atoi(args[++i]);
+		}
+		else if (arg == "--pieces" && i + 1 < argc)
+		{
+			tournamentPieces = atoi(args[++i]);
+		}
+		else if (arg == "--csv" && i + 1 < argc)
+		{
+			tournamentCSV = args[++i];
+		}
+		else if (arg == "--weights" && i + 1 < argc)
+		{
+			//height,holes,bumpiness,transitions,dangerHeight,danger
+			LBotWeights weights = gBotDefaultWeights;
+			if (SDL_sscanf(args[++i], "%d,%d,%d,%d,%d,%d", &weights.height, &weights.holes, &weights.bumpiness,
+				&weights.transitions, &weights.dangerHeight, &weights.danger) != 6)
+			{
+				printf("Expected six comma separated weights, got %s\n", args[i]);
+				return 1;
+			}
+			tournamentWeights.push_back(weights);
+		}
+		else if (arg == "--bench-eval")
+		{
+			//Compare the board evaluation kernels and exit
+			return runEvalBenchmark(EVAL_BENCHMARK_BOARDS, EVAL_BENCHMARK_ITERATIONS) ? 0 : 1;
+		}
+		else if (arg == "--bench-render")
+		{
+			benchRender = true;
+		}
+		else if (arg == "--baseline" && i + 1 < argc)
+		{
+			benchBaseline = args[++i];
+		}
+		else if (arg == "--save-baseline")
+		{
+			//Overwrites the baseline compared with unless given another path
+			benchSave = i + 1 < argc && args[i + 1][0] != '-' ? args[++i] : benchBaseline;
+		}
+		else if (arg == "--tolerance" && i + 1 < argc)
+		{
+			benchTolerance = atof(args[++i]);
+		}
+		else if (arg == "--pack-assets" && i + 1 < argc)
+		{
+			//Build step: decode everything under assets/ into one archive and exit
+			return LAssetArchive::pack("assets", args[i + 1]) ? 0 : 1;
+		}
+	}
+
+	//Loading and drawing timed offscreen
+	if (benchRender)
+	{
+		return runRenderBenchmark(benchBaseline, benchSave, benchTolerance);
+	}
+
+	//Simulate without touching the video subsystem
+	if (!replays.empty())
+	{
+		return runReplays(replays);
+	}
+	if (tournamentGames > 0)
+	{
+		return runTournament(tournamentGames, seed, tournamentPieces, tournamentWeights, tournamentCSV);
+	}
+	if (headless)
+	{
+		return runHeadless(headlessGames, seed, recordPrefix, bot);
+	}
+
+	if (!init())
+	{
+		printf("Failed to initialize!\n");
+	}
+	else
+	{
+		//Map the packed assets, loaders fall back to loose files without them
+		if (!gAssets.open(ASSET_ARCHIVE_PATH))
+		{
+			printf("No asset archive at %s, loading loose files\n", ASSET_ARCHIVE_PATH);
+		}
+
+		//Static content caches, without them everything is drawn every frame
+		if (!gMenuLayer.create(SCREEN_WIDTH, SCREEN_HEIGHT))
+		{
+			printf("Failed to create render layers, drawing everything every frame!\n");
+		}
+		if (!gBoardTexture.create(CELL_SIZE))
+		{
+			printf("Failed to create board texture, drawing every cell every frame!\n");
+		}
+
+		//Decode on worker threads while the first frames are already showing
+		if (!gAssetLoader.start())
+		{
+			printf("Failed to start asset loader, loading on the main thread!\n");
+		}
+
+		//Bot searches run next to the game on every core
+		if (!gTaskPool.start() || !gBot.start())
+		{
+			printf("Failed to start bot threads, searching on the main thread!\n");
+		}
+
+		//Player key bindings, errors are reported and the rest of the file still applies
+		gInput.loadConfig(INPUT_CONFIG_PATH);
+
+		//Menu font is queued first so text shows up as early as possible
+		bool menuLoaded = loadMenu();
+		if (!loadMedia())
+		{
+			printf("Failed to load media!\n");
+		}
+		if (!menuLoaded)
+		{
+			printf("Failed to load menu!\n");
+		}
+		else
+		{
+
+
+			//Hack to get window to stay up
+			SDL_Event e;
+			bool quit = false;
+
+			//Set default current surface
+			//gCurrentSurface = gKeyPressSurfaces[KEY_PRESS_SURFACE_DEFAULT];
+
+			//Modulation components
+			Uint8 r = 255;
+			Uint8 g = 255;
+			Uint8 b = 255;
+			Uint8 a = 255;
+
+			//Current animation frame
+			int frame = 0;
+
+			//Angle of rotation
+			double degrees = 0;
+
+			//Flip type 
+			SDL_RendererFlip flipType = SDL_FLIP_NONE;
+
+
+			//Game state is advanced on the simulation thread, this loop only draws its snapshots
+			//playing is what the player asked for, gameNumber the game the snapshots have to show for it
+			bool playing = false;
+			Uint32 gameNumber = 0;
+			Uint64 locksSeen = 0;
+			if (!gSimulation.start())
+			{
+				quit = true;
+			}
+
+			//Last frame shown, and whether the next one must be drawn regardless
+			LFrameState presentedState;
+			memset(&presentedState, 0, sizeof(presentedState));
+			bool redraw = true;
+
+			//Frame clock, for effects and for interpolating between ticks
+			const Uint64 frequency = SDL_GetPerformanceFrequency();
+			Uint64 previousTime = SDL_GetPerformanceCounter();
 
 			//Game Loop
 			while (quit == false)
 			{
-				while (SDL_PollEvent(&e))
+				//Text and scratch data from the last iteration are gone
+				gFrameArena.reset();
+
+				//Waits for the frame as the scheduler's mode says, then drains the queue
+				LProfileZone eventsZone("Events");
+				while (gFrameScheduler.pollEvent(&e))
 				{
 					if (e.type == SDL_QUIT)
 					{
 						quit = true;
 					}
 
+					//The window contents or the layer textures were lost
+					else if (e.type == SDL_WINDOWEVENT)
+					{
+						gInput.handleEvent(e);
+						gUIRouter.handleEvent(e);
+						redraw = true;
+					}
+					else if (e.type == SDL_RENDER_TARGETS_RESET)
+					{
+						gBoardTexture.invalidate();
+						gMenuLayer.invalidate();
+						redraw = true;
+					}
+
+					//The device took every texture with it, the layer and board texture have to be made again before they can be redrawn
+					else if (e.type == SDL_RENDER_DEVICE_RESET)
+					{
+						if (!gBoardTexture.create(CELL_SIZE))
+						{
+							printf("Failed to recreate board texture, drawing every cell every frame!\n");
+						}
+						if (!gMenuLayer.create(SCREEN_WIDTH, SCREEN_HEIGHT))
+						{
+							printf("Failed to recreate render layers, drawing everything every frame!\n");
+						}
+						redraw = true;
+					}
+
+					//Toggle vsync at runtime
+					else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_v)
+					{
+						gVsync = !gVsync;
+						SDL_RenderSetVSync(gRenderer, gVsync ? 1 : 0);
+					}
+
+					//Profiler overlay and trace dump
+					else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3)
+					{
+						gProfiler.toggleOverlay();
+					}
+					else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F4)
+					{
+						gProfiler.dumpChromeTrace(PROFILER_TRACE_PATH);
+					}
+
+					//Bound game keys wait in the input queue for the logic tick they happened in
+					else if (playing && gInput.handleEvent(e))
+					{
+					}
+
+					//Game controls that are not piece actions
+					else if (playing && e.type == SDL_KEYDOWN)
+					{
+						switch (e.key.keysym.sym)
+						{
+						//Bot suggests where the piece goes, or plays by itself
+						case SDLK_h:
+							gSimulation.post(SIM_COMMAND_TOGGLE_HINT);
+							break;
+
+						case SDLK_b:
+							gSimulation.post(SIM_COMMAND_TOGGLE_BOT);
+							break;
+
+						//Fill the well with particles to see what the renderer takes
+						case SDLK_p:
+							for (int i = 0; i < PARTICLE_STRESS_COUNT; ++i)
+							{
+								SDL_Color color = gPieceColors[i % PIECE_TOTAL];
+								gLineClearParticles.emit(gLineClearParticles.random((float)BOARD_SCREEN_X, (float)(BOARD_SCREEN_X + BOARD_WIDTH * CELL_SIZE)),
+									gLineClearParticles.random((float)BOARD_SCREEN_Y, (float)(BOARD_SCREEN_Y + BOARD_VISIBLE_HEIGHT * CELL_SIZE)),
+									gLineClearParticles.random(-120.0f, 120.0f), gLineClearParticles.random(-600.0f, -100.0f), gLineClearParticles.random(1.5f, 3.0f), 3.0f, color);
+							}
+							break;
+
+						case SDLK_ESCAPE:
+							gSimulation.post(SIM_COMMAND_STOP);
+							playing = false;
+							break;
+
+						case SDLK_RETURN:
+							if (gSimulation.acquire().game.isOver())
+							{
+								gSimulation.post(SIM_COMMAND_STOP);
+								playing = false;
+							}
+							break;
+						}
+					}
+
 					//User presses a key
 					else if (e.type == SDL_KEYDOWN)
 					{
@@ -916,36 +1720,32 @@ int main(int argc, char* args[])
 						//}
 
 
-						//Menu control
-						switch (e.key.keysym.sym)
+						//Menu control, the menu moves its selection and screens itself
+						switch (gMenu.handleKey(e.key.keysym.sym))
 						{
-							
-						case SDLK_UP:
-							indexSelected--;
+						//Start a new game
+						case MENU_COMMAND_PLAY:
+						{
+							Uint32 gameSeed = seed != 0 ? seed : (Uint32)SDL_GetPerformanceCounter();
+							if (gSimulation.post(SIM_COMMAND_START, gameSeed))
+							{
+								gPopups.clear();
+								gLineClearParticles.clear();
+								gDropParticles.clear();
+								++gameNumber;
+								playing = true;
+							}
 							break;
+						}
 
-						case SDLK_DOWN:
-							indexSelected++;
+						case MENU_COMMAND_QUIT:
+							quit = true;
 							break;
-						case 13:
-							printf("Premuto invio");
-						
 
 						default:
-							indexSelected = 0;
 							break;
 						}
 
-						//Adjust menu index
-						if (indexSelected >= menuEntriesNumber)
-						{
-							indexSelected = 0;
-						}
-						else if (indexSelected < 0)
-						{
-							indexSelected = menuEntriesNumber - 1;
-						}
-
 								//switch (e.key.keysym.sym)
 								//{
 								//	//Select surfaces based on key press
@@ -1004,19 +1804,129 @@ int main(int argc, char* args[])
 						//}
 
 					}
+					//Mouse goes to the widget under it only
 					else
 					{
-						for (int i = 0; i < TOTAL_BUTTONS; i++)
-						{
-							gButtons[i].handleEvent(&e);
-						}
+						gUIRouter.handleEvent(e);
 					}
 				}
 
-				//Clear screen
-				SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
+				eventsZone.end();
+
+				//Newest state the simulation published, it keeps ticking on its own however long this frame takes
+				LProfileZone updateZone("Update");
+				const LSimSnapshot& snapshot = gSimulation.acquire();
+				const LGame& game = snapshot.game;
+				bool showGame = playing && snapshot.gameNumber == gameNumber;
+				Uint64 currentTime = SDL_GetPerformanceCounter();
+				Uint64 frameTime = currentTime - previousTime;
+				previousTime = currentTime;
+
+				//Popups and effects for every lock since the last frame, the history covers far more than a frame's worth
+				if (showGame)
+				{
+					Uint64 firstLock = snapshot.lockCount > (Uint64)SIM_LOCK_HISTORY ? snapshot.lockCount - SIM_LOCK_HISTORY : 0;
+					for (Uint64 i = locksSeen > firstLock ? locksSeen : firstLock; i < snapshot.lockCount; ++i)
+					{
+						const LLockEvent& lock = snapshot.locks[i % SIM_LOCK_HISTORY];
+						spawnPopup(lock.before, lock.after);
+						emitLockEffects(lock.lock, lock.dropStart, lock.hardDrop);
+					}
+					updatePopups(game);
+				}
+				locksSeen = snapshot.lockCount;
+
+				//Effects run on wall clock time, they don't affect the game
+				float frameSeconds = (float)frameTime / (float)frequency;
+				gLineClearParticles.update(frameSeconds);
+				gDropParticles.update(frameSeconds);
+				updateZone.end();
+
+				//Fraction of the next tick already elapsed
+				double alpha = currentTime > snapshot.tickEnd ? (double)(currentTime - snapshot.tickEnd) * LOGIC_TICK_RATE / (double)frequency : 0.0;
+				if (alpha > 1.0)
+				{
+					alpha = 1.0;
+				}
+
+				//Upload whatever the loader threads finished, a few milliseconds per frame at most
+				gAssetLoader.update();
+
+				//Destroy textures loader threads released over the budget, they can't do it themselves
+				gResources.collect();
+
+				//Skip drawing and presenting when the frame would look exactly like the last one
+				LFrameState state;
+				memset(&state, 0, sizeof(state));
+				state.playing = showGame;
+				state.glyphsLoaded = gGlyphCache.isLoaded();
+				state.loadProgress = gAssetLoader.isDone() ? -1 : (int)(gAssetLoader.getProgress() * 1000.f);
+				state.overlayFrame = gProfiler.isOverlayVisible() ? SDL_GetPerformanceCounter() : 0;
+				if (showGame)
+				{
+					const LGameStats& stats = game.getStats();
+					state.boardVersion = game.getBoardVersion();
+					state.piece = game.getPiece();
+					state.pieceY = interpolatePieceY(game.getPiece(), snapshot.previousPiece, alpha);
+					state.hold = game.getHold();
+					for (int i = 0; i < NEXT_QUEUE_SIZE; ++i)
+					{
+						state.next[i] = game.getNext(i);
+					}
+					state.score = stats.score;
+					state.level = stats.level;
+					state.lines = stats.lines;
+					state.over = game.isOver();
+					state.hintShown = snapshot.hintShown;
+					state.hint = snapshot.hint;
+					state.popupTick = gPopups.getActiveCount() > 0 ? stats.ticks : 0;
+					state.particleTime = gLineClearParticles.getCount() + gDropParticles.getCount() > 0 ? currentTime : 0;
+				}
+				else
+				{
+					state.menuVersion = gMenu.getVersion();
+				}
+
+				//Anything that moves on its own keeps frames coming, otherwise sleep until input
+				bool animating = showGame || !gAssetLoader.isDone() || gLineClearParticles.getCount() + gDropParticles.getCount() > 0;
+				gFrameScheduler.setMode(animating ? FRAME_MODE_ACTIVE : FRAME_MODE_IDLE);
+				if (gProfiler.isOverlayVisible())
+				{
+					gFrameScheduler.requestDeadline(currentTime + frequency * FRAME_OVERLAY_REFRESH_MS / 1000);
+				}
+
+				//Ends every frame, drawn or not, so skipped frames don't merge into the next one
+				//Presses with no visible effect count as shown now rather than at some later frame
+				auto finishFrame = [&]()
+				{
+					gInput.present(SDL_GetPerformanceCounter(), snapshot.tickEnd);
+					gProfiler.endFrame();
+				};
+
+				//Nothing to show, the scheduler waits for the next frame or event
+				if (!redraw && memcmp(&state, &presentedState, sizeof(state)) == 0)
+				{
+					finishFrame();
+					continue;
+				}
+				presentedState = state;
+				redraw = false;
+				LProfileZone renderZone("Render");
+
+				//Refresh the menu layer only when the menu changed, the board streams its changed rows itself
+				if (!showGame && gMenuLayer.needsRedraw(gMenu.getVersion()) && gMenuLayer.begin(BACKGROUND_COLOR))
+				{
+					gMenu.render();
+					gMenuLayer.end(gMenu.getVersion());
+				}
+
+				//Clear screen, tile based GPUs prefer it even though the layer covers everything
+				SDL_SetRenderDrawColor(gRenderer, BACKGROUND_COLOR.r, BACKGROUND_COLOR.g, BACKGROUND_COLOR.b, BACKGROUND_COLOR.a);
 				SDL_RenderClear(gRenderer);
 
+				//Queue everything below into one batch
+				gSpriteBatch.begin();
+
 				//Render texture screen
 				//SDL_RenderCopy(gRenderer, gTexture, NULL, NULL);
 
@@ -1148,28 +2058,64 @@ int main(int argc, char* args[])
 				}*/
 					
 				
-				//Set the index selected bold
-				gMenuTextures[indexSelected]->setColor(255, 255, 0);
+				//Static content, the menu from its layer unless the layer could not be used
+				gSpriteBatch.setLayer(0);
+				if (showGame)
+				{
+					renderBoardBackground(game);
+				}
+				else if (!gMenuLayer.needsRedraw(gMenu.getVersion()))
+				{
+					gMenuLayer.render(0, 0);
+				}
+				else
+				{
+					gMenu.render();
+				}
 
-				//Render menu entries
-				for (int i = 0; i < menuEntriesNumber; i++)
+				//Moving parts on top
+				if (showGame)
 				{
-					if (i != indexSelected)
-					{
-						gMenuTextures[i]->setColor(138, 138, 138);
-					}
-					gMenuTextures[i]->render((SCREEN_WIDTH - gMenuTextures[i]->getWidth()) / 2, (SCREEN_HEIGHT - gMenuTextures[i]->getHeight() + (50*i)) / 2);
+					renderGame(game, snapshot.previousPiece, alpha, snapshot.hintShown ? &snapshot.hint : NULL);
+				}
+
+				//Loading progress along the bottom of the screen
+				if (!gAssetLoader.isDone())
+				{
+					renderLoadingBar();
 				}
 				
 				
 
 
-				//Update screen
+				//Frame statistics on top of everything
+				if (gProfiler.isOverlayVisible())
+				{
+					gProfiler.renderOverlay(SCREEN_WIDTH - PROFILER_FRAME_HISTORY - 10, 10);
+					if (gInput.getLatencySamples(INPUT_ACTION_TOTAL) > 0)
+					{
+						gGlyphCache.render(10, SCREEN_HEIGHT - gGlyphCache.getLineHeight() - 10, gFrameArena.format("input to present p50 %.1f p99 %.1f ms",
+							gInput.getLatencyPercentile(INPUT_ACTION_TOTAL, 0.5), gInput.getLatencyPercentile(INPUT_ACTION_TOTAL, 0.99)), HUD_TEXT_COLOR);
+					}
+					gGlyphCache.render(10, SCREEN_HEIGHT - gGlyphCache.getLineHeight() * 2 - 10, gFrameArena.format("%s, %.0f wakeups/s, cpu %.1f%%",
+						gFrameScheduler.getMode() == FRAME_MODE_ACTIVE ? "active" : "idle", gFrameScheduler.getWakeupRate(), gFrameScheduler.getCpuPercent()), HUD_TEXT_COLOR);
+				}
+
+				//Submit the batch and update screen
+				gSpriteBatch.flush();
+				renderZone.end();
+
+				LProfileZone presentZone("Present");
 				SDL_RenderPresent(gRenderer);
+				presentZone.end();
+				finishFrame();
 
 
 				
 			}
+
+			//Closing the window mid game still keeps it
+			gSimulation.stop();
 		}
 	}
 	//Free resources and close SDL